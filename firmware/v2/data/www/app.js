@@ -167,7 +167,7 @@
         });
 
         if (page === 'profiles') loadProfiles();
-        if (page === 'logs') loadLogs();
+        if (page === 'logs') { loadHistory(); loadLogs(); }
         if (page === 'settings') loadSettings();
     }
 
@@ -203,6 +203,76 @@
         } catch(e) { /* offline */ }
     }
 
+    // --- History ---
+    // The device returns at most `points` LTTB-reduced samples:
+    // [t (uptime s), temp, setpoint, output %]
+    async function loadHistory() {
+        const chSel = document.getElementById('history-ch');
+        if (chSel.options.length !== numChannels) {
+            chSel.innerHTML = '';
+            for (let i = 0; i < numChannels; i++) {
+                chSel.innerHTML += `<option value="${i}">Channel ${i + 1}</option>`;
+            }
+        }
+        const canvas = document.getElementById('history-chart');
+        const span = parseInt(document.getElementById('history-span').value);
+        const points = Math.max(50, Math.min(1000, Math.round(canvas.clientWidth)));
+        const meta = document.getElementById('history-meta');
+        try {
+            const data = await API.get('/api/history?ch=' + chSel.value + '&from=-' + span +
+                                       '&points=' + points);
+            drawHistory(canvas, data.points, data.from, data.to);
+            meta.textContent = data.points.length + ' of ' + data.total + ' samples';
+        } catch(e) {
+            meta.textContent = 'History unavailable';
+        }
+    }
+
+    function drawHistory(canvas, pts, from, to) {
+        const dpr = window.devicePixelRatio || 1;
+        const w = canvas.clientWidth, h = canvas.clientHeight;
+        canvas.width = w * dpr;
+        canvas.height = h * dpr;
+        const ctx = canvas.getContext('2d');
+        ctx.scale(dpr, dpr);
+        ctx.clearRect(0, 0, w, h);
+        if (!pts.length) return;
+
+        let lo = Infinity, hi = -Infinity;
+        pts.forEach(p => { lo = Math.min(lo, p[1], p[2]); hi = Math.max(hi, p[1], p[2]); });
+        if (hi - lo < 10) { hi += 5; lo -= 5; }
+        const x = t => (t - from) / Math.max(1, to - from) * w;
+        const y = v => h - 4 - (v - lo) / (hi - lo) * (h - 8);
+        const css = getComputedStyle(document.documentElement);
+
+        // Output as a faint area, setpoint dashed, temperature solid
+        ctx.fillStyle = 'rgba(255,255,255,0.06)';
+        pts.forEach(p => {
+            const bh = p[3] / 100 * h;
+            ctx.fillRect(x(p[0]), h - bh, 2, bh);
+        });
+        [[2, css.getPropertyValue('--text-dim'), [4, 4]],
+         [1, css.getPropertyValue('--accent'), []]].forEach(([idx, color, dash]) => {
+            ctx.strokeStyle = color.trim();
+            ctx.setLineDash(dash);
+            ctx.lineWidth = 1.5;
+            ctx.beginPath();
+            pts.forEach((p, i) => {
+                if (i) ctx.lineTo(x(p[0]), y(p[idx]));
+                else ctx.moveTo(x(p[0]), y(p[idx]));
+            });
+            ctx.stroke();
+        });
+        ctx.setLineDash([]);
+        ctx.fillStyle = css.getPropertyValue('--text-dim').trim();
+        ctx.font = '10px sans-serif';
+        ctx.fillText(Math.round(hi) + '\u00B0F', 4, 12);
+        ctx.fillText(Math.round(lo) + '\u00B0F', 4, h - 6);
+    }
+
+    document.getElementById('history-ch').addEventListener('change', loadHistory);
+    document.getElementById('history-span').addEventListener('change', loadHistory);
+
     // --- Settings ---
     async function loadSettings() {
         try {
@@ -211,10 +281,31 @@
             if (data.mqtt_host) document.getElementById('mqtt-host').value = data.mqtt_host;
             if (data.mqtt_port) document.getElementById('mqtt-port').value = data.mqtt_port;
             if (data.idle_timeout) document.getElementById('idle-timeout').value = data.idle_timeout;
+            renderHeaterWatts(data.heaterWatts || []);
             document.getElementById('fw-version').textContent = 'v' + (data.fw_version || '--');
         } catch(e) { /* offline */ }
     }
 
+    // One rated-power input per channel, used for energy accounting
+    function renderHeaterWatts(watts) {
+        const list = document.getElementById('heater-watts');
+        list.innerHTML = '';
+        watts.forEach((w, i) => {
+            const row = document.createElement('div');
+            row.className = 'setting-row';
+            row.innerHTML = '<label>Channel ' + (i + 1) + ' (W)</label>' +
+                '<input type="number" min="1" max="3000" step="10" value="' + w + '">';
+            list.appendChild(row);
+        });
+    }
+
+    document.getElementById('btn-save-heaters').addEventListener('click', () => {
+        const inputs = document.querySelectorAll('#heater-watts input');
+        API.post('/api/settings', {
+            heaterWatts: Array.from(inputs).map(el => parseInt(el.value))
+        }).then(loadSettings).catch(loadSettings);
+    });
+
     document.getElementById('btn-save-wifi').addEventListener('click', () => {
         API.post('/api/settings/wifi', {
             ssid: document.getElementById('wifi-ssid').value,
@@ -1,5 +1,5 @@
 // ESP-Nail v2 Service Worker - Offline PWA Support
-const CACHE_NAME = 'espnail-v2';
+const CACHE_NAME = 'espnail-v4';
 const ASSETS = ['/', '/index.html', '/style.css', '/app.js', '/manifest.json'];
 
 self.addEventListener('install', (e) => {
@@ -31,6 +31,10 @@
 #define ENABLE_MQTT 0
 #endif
 
+#ifndef ENABLE_SERIES_LOG
+#define ENABLE_SERIES_LOG 1
+#endif
+
 #ifndef DISPLAY_TYPE_SSD1306
 #define DISPLAY_TYPE_SSD1306 1
 #endif
@@ -56,6 +60,10 @@
 #define PIN_TC_CS_3         16
 #define PIN_TC_CS_4         4
 
+// Hardware SPI host + clock for the thermocouple bus (MAX31855 max 5 MHz)
+#define TC_SPI_HOST         SPI3_HOST   // VSPI: native pins 18/19/23
+#define TC_SPI_CLOCK_HZ     4000000
+
 // SSR Output Pins per channel
 #define PIN_SSR_1           25
 #define PIN_SSR_2           26
@@ -78,6 +86,9 @@
 #define PIN_TFT_DC          0
 #define PIN_TFT_RST         -1  // Tied to ESP32 reset
 
+// Mains zero-cross detector (optional, for burst-fire SSR mode)
+#define PIN_ZERO_CROSS      -1  // e.g. 34 (input only); -1 = free-running timer
+
 // ACS712 Current Sensor (optional, future)
 #define PIN_CURRENT_SENSE   36  // ADC1_CH0 (input only)
 
@@ -98,15 +109,46 @@ static const uint8_t SSR_PINS[]    = { PIN_SSR_1, PIN_SSR_2, PIN_SSR_3, PIN_SSR_
 #define PID_KP_DEFAULT          8.0f
 #define PID_KI_DEFAULT          0.2f
 #define PID_KD_DEFAULT          2.0f
+#ifndef PID_SAMPLE_MS
 #define PID_SAMPLE_MS           250
+#endif
 #define PID_OUTPUT_MIN          0.0f
 #define PID_OUTPUT_MAX          100.0f
 #define PID_DERIVATIVE_FILTER   0.1f
+#define PID_DT_MAX_SCALE        4       // Cap measured dt at 4x PID_SAMPLE_MS
+#ifndef PID_FIXED_POINT
+#define PID_FIXED_POINT         0       // 1 = Q16.16 integer PID kernel
+#endif
 
 // --- SSR Time-Proportioning ---
-#define SSR_PERIOD_MS           1000
+#define SSR_PERIOD_MS           1000    // Must divide 1000 (LEDC takes integer Hz)
 #define SSR_MIN_ON_MS           50
 
+// SSR edges are generated by LEDC (low-speed group). Channel 0 / timer 0
+// are left for tone() on the buzzer.
+#define SSR_LEDC_MODE           LEDC_LOW_SPEED_MODE
+#define SSR_LEDC_TIMER          LEDC_TIMER_3
+#define SSR_LEDC_CHANNEL_BASE   4
+#define SSR_LEDC_RES_BITS       14
+#define SSR_LEDC_FULL           (1UL << SSR_LEDC_RES_BITS)
+
+// SSR modulation: SSRMode::TIME_PROPORTIONAL (LEDC, 1 s window) or
+// SSRMode::BURST_FIRE (whole half-cycles, sigma-delta distributed)
+#ifndef SSR_MODULATION_DEFAULT
+#define SSR_MODULATION_DEFAULT  SSRMode::TIME_PROPORTIONAL
+#endif
+#define SSR_BURST_SCALE         1000    // Burst density resolution (0.1%)
+#define MAINS_FREQ_HZ           60
+
+// Multi-channel SSR scheduling: on-windows are staggered within the
+// shared frame so at most (budget / coil current) coils conduct at once
+#ifndef SSR_COIL_CURRENT_A
+#define SSR_COIL_CURRENT_A      1.0f    // Per-coil draw (e.g. 120W @ 120VAC)
+#endif
+#ifndef SSR_CURRENT_BUDGET_A
+#define SSR_CURRENT_BUDGET_A    0.0f    // Total supply budget, 0 = unlimited
+#endif
+
 // --- Safety ---
 #define IDLE_TIMEOUT_MIN_DEFAULT    60
 #define IDLE_TIMEOUT_MIN_MAX        120
@@ -118,18 +160,32 @@ static const uint8_t SSR_PINS[]    = { PIN_SSR_1, PIN_SSR_2, PIN_SSR_3, PIN_SSR_
 #define OLED_WIDTH              128
 #define OLED_HEIGHT             64
 #define OLED_ADDR               0x3C
-#define DISPLAY_UPDATE_MS       100
+#define OLED_I2C_HZ             400000
+#define DISPLAY_IDLE_REFRESH_MS 500     // Redraw at least this often (fault blink, uptime)
 
 // TFT (ST7789)
 #define TFT_WIDTH               240
 #define TFT_HEIGHT              240
+#define TFT_SPI_CLOCK_HZ        40000000
+#define TFT_BAND_ROWS           16      // Sprite height; one DMA push at most
+#define TFT_BLOCK_COLS          16      // Dirty-detection granularity within a band
 
 // --- UI ---
-#define ENCODER_DEBOUNCE_MS     5
+#define ENCODER_RING_SIZE       16      // Detents buffered ISR -> UI (power of two)
+#define ENCODER_ACCEL_SLOW_MS   120     // Detent interval below which steps double
+#define ENCODER_ACCEL_MED_MS    60      // ...below which steps are (ENCODER_ACCEL_MAX + 1) / 2
+#define ENCODER_ACCEL_FAST_MS   25      // ...below which steps are ENCODER_ACCEL_MAX
+#define ENCODER_ACCEL_MAX       10
 #define BUTTON_DEBOUNCE_MS      50
 #define BUTTON_LONG_PRESS_MS    1000
 #define TEMP_STEP_NORMAL        5.0f
 #define TEMP_STEP_FINE          1.0f
+#define UI_POLL_MS              20      // UI wake rate while the button or buzzer needs timing
+
+// taskUI notification bits (xTaskNotify eSetBits)
+#define UI_NOTIFY_INPUT         (1UL << 0)  // Encoder detent or button edge
+#define UI_NOTIFY_STATE         (1UL << 1)  // A channel snapshot changed on screen
+#define UI_NOTIFY_FAULT         (1UL << 2)  // FaultEvent queued
 
 // --- Profiles ---
 #define MAX_PROFILES_PER_CH     8
@@ -137,7 +193,22 @@ static const uint8_t SSR_PINS[]    = { PIN_SSR_1, PIN_SSR_2, PIN_SSR_3, PIN_SSR_
 
 // --- Session Logging ---
 #define MAX_SESSION_RECORDS     50
-#define SESSION_SAMPLE_INTERVAL_S   30  // Log a data point every 30s
+#define HEATER_WATTS_DEFAULT    100     // Per-channel coil rating, ChannelSettings::heaterWatts
+#define HEATER_WATTS_MAX        3000
+#define HEATER_WATTS_STEP       10      // Per encoder detent on the PID / Heater screen
+#define ENERGY_SAVE_INTERVAL_MS 300000  // Lifetime energy checkpoint while a session runs
+
+// --- Time-Series Recorder (ENABLE_SERIES_LOG) ---
+#define SERIES_DECIMATION       4       // PID ticks per stored sample (4 x 250 ms = 1 s)
+#define SERIES_DECIMATE_MEAN    1       // 1 = store the mean of those ticks, 0 = the last one
+#define SERIES_BLOCK_BYTES      256     // RAM block per channel (x2), flushed when full
+#define SERIES_SEGMENT_BYTES    4096    // Segment file size (one LittleFS block)
+#define SERIES_MAX_BYTES        (256UL * 1024)  // Flash budget; oldest sessions deleted beyond
+#define SERIES_MAX_SESSIONS     64
+#define HISTORY_DEFAULT_SPAN_S  3600    // /api/history range when `from` is omitted
+#define HISTORY_DEFAULT_POINTS  300
+#define HISTORY_MAX_POINTS      1000
+#define HISTORY_STEP_SAMPLES    1500    // Samples decoded per chunk callback while selecting
 
 // --- Network ---
 #define WIFI_AP_SSID_PREFIX     "ESPNail-"
@@ -160,7 +231,11 @@ static const uint8_t SSR_PINS[]    = { PIN_SSR_1, PIN_SSR_2, PIN_SSR_3, PIN_SSR_
 
 // --- Storage / NVS ---
 #define NVS_NAMESPACE           "enail2"
-#define NVS_SETTINGS_VERSION    2
+#define NVS_SETTINGS_VERSION    3       // 3: one CRC blob per settings struct
+#define NVS_LEGACY_KEYS_VERSION 2       // Per-field keys, migrated on boot
+#define SETTINGS_DEBOUNCE_MS    2000    // Quiet time before changed settings are written
+#define SETTINGS_MAX_DEFER_MS   10000   // ...but never held back longer than this
+#define SETTINGS_POLL_MS        250     // Persist task check interval
 
 // --- FreeRTOS Task Config ---
 #define TASK_PID_STACK          4096
@@ -175,6 +250,10 @@ static const uint8_t SSR_PINS[]    = { PIN_SSR_1, PIN_SSR_2, PIN_SSR_3, PIN_SSR_
 #define TASK_UI_PRIORITY        3
 #define TASK_UI_CORE            0
 
+#define TASK_DISPLAY_STACK      2048
+#define TASK_DISPLAY_PRIORITY   2       // Below UI: drawing preempts I2C transfers
+#define TASK_DISPLAY_CORE       0
+
 #define TASK_NETWORK_STACK      8192    // WiFi needs larger stack
 #define TASK_NETWORK_PRIORITY   2
 #define TASK_NETWORK_CORE       0
@@ -183,7 +262,10 @@ static const uint8_t SSR_PINS[]    = { PIN_SSR_1, PIN_SSR_2, PIN_SSR_3, PIN_SSR_
 #define TASK_LOGGER_PRIORITY    1       // Lowest priority
 #define TASK_LOGGER_CORE        0
 
+#define TASK_PERSIST_STACK      3072    // NVS writes
+#define TASK_PERSIST_PRIORITY   1
+#define TASK_PERSIST_CORE       0
+
 // --- Queue Sizes ---
-#define QUEUE_TEMP_SIZE         8
 #define QUEUE_CMD_SIZE          16
 #define QUEUE_FAULT_SIZE        8
@@ -1,7 +1,7 @@
 #include "autotune.h"
 
-PIDAutotuner::PIDAutotuner()
-    : _state(AutotuneState::IDLE),
+PIDAutotuner::PIDAutotuner(const Clock& clock)
+    : _clock(&clock), _state(AutotuneState::IDLE),
       _setpoint(0), _outputHigh(100.0f), _outputLow(0.0f), _currentOutput(0),
       _targetOscillations(5), _oscillationCount(0),
       _aboveSetpoint(false), _lastCrossTime(0),
@@ -27,7 +27,7 @@ void PIDAutotuner::begin(float setpoint, float outputHigh, float outputLow) {
     _amplitudeSum = 0;
     _periodCount = 0;
 
-    _startTime = millis();
+    _startTime = _clock->nowMs();
     _result = { 0, 0, 0, 0, 0, false };
     _state = AutotuneState::WAITING_HEAT;
 }
@@ -40,7 +40,7 @@ float PIDAutotuner::update(float measurement) {
     }
 
     // Timeout check
-    if ((millis() - _startTime) > _timeoutMs) {
+    if ((_clock->nowMs() - _startTime) > _timeoutMs) {
         _state = AutotuneState::FAILED;
         return 0;
     }
@@ -52,7 +52,7 @@ float PIDAutotuner::update(float measurement) {
         if (nowAbove) {
             _state = AutotuneState::OSCILLATING;
             _aboveSetpoint = true;
-            _lastCrossTime = millis();
+            _lastCrossTime = _clock->nowMs();
             _currentOutput = _outputLow;
             _peakHigh = measurement;
         } else {
@@ -71,7 +71,7 @@ float PIDAutotuner::update(float measurement) {
 
     // Detect zero crossing (setpoint crossing)
     if (nowAbove != _aboveSetpoint) {
-        uint32_t now = millis();
+        uint32_t now = _clock->nowMs();
 
         if (_aboveSetpoint && !nowAbove) {
             // Crossed below setpoint - switch to heating
@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "core/clock.h"
 
 // PID Auto-Tuner using relay feedback (Ziegler-Nichols) method.
 // Oscillates the output between on/off around the setpoint,
@@ -27,7 +28,8 @@ struct AutotuneResult {
 
 class PIDAutotuner {
 public:
-    PIDAutotuner();
+    explicit PIDAutotuner(const Clock& clock = SystemClock::instance());
+    void setClock(const Clock& clock)   { _clock = &clock; }
 
     // Start auto-tune for a given setpoint. outputHigh/Low are the
     // relay output percentages (e.g., 100% and 0%).
@@ -49,6 +51,7 @@ public:
     void setTimeout(uint32_t ms)            { _timeoutMs = ms; }
 
 private:
+    const Clock* _clock;
     AutotuneState _state;
     AutotuneResult _result;
 
@@ -1,20 +1,18 @@
 #include "channel.h"
 #include "drivers/thermocouple.h"
 
-Channel::Channel()
-    : _index(0), _ssrPin(0), _targetTempF(TEMP_DEFAULT_F),
-      _tc(nullptr), _state(ChannelState::OFF),
-      _ssrPeriodStart(0), _ssrState(false), _lastActiveTime(0) {}
+Channel::Channel(const Clock& clock)
+    : _clock(&clock), _index(0), _targetTempF(TEMP_DEFAULT_F),
+      _kp(PID_KP_DEFAULT), _ki(PID_KI_DEFAULT), _kd(PID_KD_DEFAULT),
+      _autotuner(clock), _tc(nullptr), _state(ChannelState::OFF),
+      _lastActiveTime(0), _pidStaged(false) {}
 
-void Channel::begin(uint8_t index, uint8_t ssrPin, uint8_t tcCsPin) {
+void Channel::begin(uint8_t index, uint8_t ssrPin, Thermocouple* tc, PIDView pid) {
     _index = index;
-    _ssrPin = ssrPin;
+    _pid = pid;
+    _ssr.begin(ssrPin, index);
 
-    pinMode(_ssrPin, OUTPUT);
-    ssrOff();
-
-    _tc = new Thermocouple();
-    _tc->begin(tcCsPin);
+    _tc = tc;   // Owned and sampled by ThermocoupleBus
 
     _pid.begin(PID_KP_DEFAULT, PID_KI_DEFAULT, PID_KD_DEFAULT, PID_SAMPLE_MS);
     _pid.setOutputLimits(PID_OUTPUT_MIN, PID_OUTPUT_MAX);
@@ -22,11 +20,9 @@ void Channel::begin(uint8_t index, uint8_t ssrPin, uint8_t tcCsPin) {
     _pid.setEnabled(false);
 
     _state = ChannelState::OFF;
-    _ssrPeriodStart = millis();
 }
 
 void Channel::update() {
-    if (_tc) _tc->update();
     checkFaults();
 
     if (_state == ChannelState::FAULT || _state == ChannelState::OFF) {
@@ -41,7 +37,7 @@ void Channel::update() {
             if (_autotuner.getState() == AutotuneState::COMPLETE) {
                 AutotuneResult result = _autotuner.getResult();
                 if (result.valid) {
-                    _pid.setTunings(result.kp, result.ki, result.kd);
+                    setPIDTunings(result.kp, result.ki, result.kd);
                 }
                 enable();  // Return to normal operation
             } else if (_autotuner.getState() == AutotuneState::FAILED) {
@@ -49,27 +45,30 @@ void Channel::update() {
             }
 
             // Apply autotune relay output via SSR
-            uint32_t now = millis();
-            uint32_t elapsed = now - _ssrPeriodStart;
-            if (elapsed >= SSR_PERIOD_MS) { _ssrPeriodStart = now; elapsed = 0; }
-            uint32_t onTime = (uint32_t)(output / 100.0f * SSR_PERIOD_MS);
-            if (elapsed < onTime) ssrOn(); else ssrOff();
+            if (_state == ChannelState::AUTOTUNE) _ssr.setDutyCycle(output);
         }
         return;
     }
 
-    // Normal PID operation
+    // Normal PID operation: stage the measurement, PIDBank computes
     if (_tc && _tc->isOk()) {
-        float currentTemp = _tc->getTemperatureF();
-        _pid.compute(currentTemp);
+        _pid.stageQ16(_tc->getTemperatureFQ16());
+    }
+    _pidStaged = true;
+}
 
-        float error = abs(_targetTempF - currentTemp);
+void Channel::applyOutput() {
+    if (!_pidStaged) return;
+    _pidStaged = false;
+
+    if (_tc && _tc->isOk()) {
+        float error = abs(_targetTempF - _tc->getTemperatureF());
         if (_state == ChannelState::HEATING && error < TEMP_HOLDING_BAND_F) {
             setState(ChannelState::HOLDING);
         } else if (_state == ChannelState::HOLDING && error > TEMP_HEATING_BAND_F) {
             setState(ChannelState::HEATING);
         }
-        _lastActiveTime = millis();
+        _lastActiveTime = _clock->nowMs();
     }
 
     updateSSR();
@@ -80,7 +79,7 @@ void Channel::enable() {
     _pid.setSetpoint(_targetTempF);
     _pid.setEnabled(true);
     _pid.reset();
-    _lastActiveTime = millis();
+    _lastActiveTime = _clock->nowMs();
     setState(ChannelState::HEATING);
 }
 
@@ -104,7 +103,9 @@ void Channel::adjustTargetTemp(float delta) {
 }
 
 void Channel::setPIDTunings(float kp, float ki, float kd) {
+    if (kp < 0 || ki < 0 || kd < 0) return;
     _pid.setTunings(kp, ki, kd);
+    _kp = kp; _ki = ki; _kd = kd;
 }
 
 void Channel::startAutotune() {
@@ -130,15 +131,7 @@ AutotuneResult Channel::getAutotuneResult() const {
 void Channel::updateSSR() {
     if (!_pid.isEnabled() || _state == ChannelState::FAULT) { ssrOff(); return; }
 
-    float output = _pid.getOutput();
-    uint32_t now = millis();
-    uint32_t elapsed = now - _ssrPeriodStart;
-    if (elapsed >= SSR_PERIOD_MS) { _ssrPeriodStart = now; elapsed = 0; }
-
-    uint32_t onTimeMs = (uint32_t)(output / 100.0f * SSR_PERIOD_MS);
-    if (onTimeMs < SSR_MIN_ON_MS) onTimeMs = 0;
-
-    if (elapsed < onTimeMs) ssrOn(); else ssrOff();
+    _ssr.setDutyCycle(_pid.getOutput());
 }
 
 float Channel::getCurrentTemp() const {
@@ -186,23 +179,44 @@ void Channel::checkFaults() {
     }
 }
 
-TempUpdate Channel::getTempUpdate() const {
-    TempUpdate u;
-    u.channel = _index;
-    u.currentTemp = getCurrentTemp();
-    u.targetTemp = _targetTempF;
-    u.pidOutput = _pid.getOutput();
-    u.state = _state;
-    u.tcStatus = getTCStatusRaw();
-    return u;
+bool Channel::publishSnapshot(float displayTemp) {
+    ChannelSnapshot prev;
+    bool first = _snapshot.read(prev) == 0;
+
+    ChannelSnapshot s;
+    s.channel = _index;
+    s.state = _state;
+    s.currentTemp = getCurrentTemp();
+    s.displayTemp = displayTemp;
+    s.targetTemp = _targetTempF;
+    s.pidOutput = _pid.getOutput();
+    s.kp = _kp; s.ki = _ki; s.kd = _kd;
+    s.autotuneProgress = (_state == ChannelState::AUTOTUNE) ? _autotuner.getProgress() : 0.0f;
+    s.tcStatus = getTCStatusRaw();
+    s.tcErrorCount = getTCErrorCount();
+    s.tcOk = isTCOk();
+    s.timestampMs = _clock->nowMs();
+    _snapshot.publish(s);
+    return first || s.differsOnScreen(prev);
 }
 
 void Channel::setState(ChannelState s) { _state = s; }
-void Channel::ssrOn() { if (!_ssrState) { digitalWrite(_ssrPin, HIGH); _ssrState = true; } }
-void Channel::ssrOff() { if (_ssrState) { digitalWrite(_ssrPin, LOW); _ssrState = false; } }
+void Channel::ssrOff() { _ssr.forceOff(); }
 
 const char* Channel::getStateString() const {
-    switch (_state) {
+    return channelStateString(_state);
+}
+
+bool ChannelSnapshot::differsOnScreen(const ChannelSnapshot& o) const {
+    return state != o.state || tcStatus != o.tcStatus ||
+           lroundf(displayTemp * 10.0f) != lroundf(o.displayTemp * 10.0f) ||
+           lroundf(targetTemp * 10.0f) != lroundf(o.targetTemp * 10.0f) ||
+           lroundf(pidOutput) != lroundf(o.pidOutput) ||
+           lroundf(autotuneProgress * 100.0f) != lroundf(o.autotuneProgress * 100.0f);
+}
+
+const char* channelStateString(ChannelState s) {
+    switch (s) {
         case ChannelState::OFF:      return "OFF";
         case ChannelState::HEATING:  return "HEAT";
         case ChannelState::HOLDING:  return "HOLD";
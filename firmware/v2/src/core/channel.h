@@ -5,11 +5,14 @@
 #include <freertos/queue.h>
 #include "config.h"
 #include "pid.h"
+#include "core/pid_bank.h"
 #include "core/autotune.h"
+#include "core/clock.h"
+#include "core/seqlock.h"
+#include "drivers/ssr.h"
 
 // Forward declarations (drivers are injected)
 class Thermocouple;
-class SSRDriver;
 
 enum class ChannelState : uint8_t {
     OFF,
@@ -31,31 +34,51 @@ struct ChannelCommand {
         CMD_START_AUTOTUNE,
         CMD_CANCEL_AUTOTUNE,
         CMD_LOAD_PROFILE,
-        CMD_CLEAR_FAULT
+        CMD_CLEAR_FAULT,
+        CMD_SET_HEATER_WATTS
     };
     Type type;
     uint8_t channel;
-    float value;            // Temperature or delta
+    float value;            // Temperature, delta or heater watts
     float kp, ki, kd;      // For CMD_SET_PID
     uint8_t profileIndex;   // For CMD_LOAD_PROFILE
 };
 
-// Temperature update from PID task → UI/Network
-struct TempUpdate {
+const char* channelStateString(ChannelState s);
+
+// Consistent copy of a channel's state, published by the PID task once
+// per tick into the channel's latest-value mailbox (a Seqlock). Safe to
+// read from any task or core; every reader sees the newest tick.
+struct ChannelSnapshot {
     uint8_t channel;
-    float currentTemp;
+    ChannelState state;
+    float currentTemp;      // Raw thermocouple reading (0 if TC not OK)
+    float displayTemp;      // currentTemp with calibration applied
     float targetTemp;
     float pidOutput;
-    ChannelState state;
+    float kp, ki, kd;       // Gains as last set (setPIDTunings units)
+    float autotuneProgress; // 0..1 while AUTOTUNE
     uint8_t tcStatus;       // Cast of TCStatus enum
+    uint8_t tcErrorCount;
+    bool tcOk;
+    uint32_t timestampMs;
+
+    bool isActive() const   { return state == ChannelState::HEATING || state == ChannelState::HOLDING; }
+    bool isFaulted() const  { return state == ChannelState::FAULT; }
+    const char* getStateString() const { return channelStateString(state); }
+
+    // True if anything the screens show differs from `o` (temps at the
+    // 0.1F the display prints, output and autotune progress at 1%)
+    bool differsOnScreen(const ChannelSnapshot& o) const;
 };
 
 class Channel {
 public:
-    Channel();
+    explicit Channel(const Clock& clock = SystemClock::instance());
 
-    void begin(uint8_t index, uint8_t ssrPin, uint8_t tcCsPin);
-    void update();          // Called from PID task
+    void begin(uint8_t index, uint8_t ssrPin, Thermocouple* tc, PIDView pid);
+    void update();          // Called from PID task after ThermocoupleBus::poll(); stages the PID
+    void applyOutput();     // Called after PIDBank::compute(); state transitions + SSR
 
     // Control
     void enable();
@@ -71,8 +94,10 @@ public:
     float getAutotuneProgress() const;
     AutotuneResult getAutotuneResult() const;
 
-    // SSR control
+    // SSR control: publishes the PID output as the next LEDC on-time
     void updateSSR();
+    SSRDriver& getSSR()                 { return _ssr; }
+    const SSRDriver& getSSR() const     { return _ssr; }
 
     // State getters
     ChannelState getState() const       { return _state; }
@@ -82,7 +107,7 @@ public:
     bool isActive() const;
     bool isFaulted() const              { return _state == ChannelState::FAULT; }
     uint8_t getIndex() const            { return _index; }
-    const PIDController& getPID() const { return _pid; }
+    const PIDView& getPID() const     { return _pid; }
 
     // Thermocouple access
     uint8_t getTCStatusRaw() const;
@@ -91,27 +116,34 @@ public:
 
     const char* getStateString() const;
 
-    // Fill a TempUpdate struct for queue publishing
-    TempUpdate getTempUpdate() const;
+    // Cross-task view: publishSnapshot() from the PID task only;
+    // snapshot() from anywhere else instead of the getters above.
+    // Returns true if the published state differs on screen from the last.
+    bool publishSnapshot(float displayTemp);
+    bool publishSnapshot()              { return publishSnapshot(getCurrentTemp()); }
+    ChannelSnapshot snapshot() const    { return _snapshot.read(); }
+    uint32_t getSnapshotSequence() const { return _snapshot.sequence(); }
 
 private:
+    const Clock* _clock;
     uint8_t _index;
-    uint8_t _ssrPin;
     float _targetTempF;
+    float _kp, _ki, _kd;    // Unscaled copies of the PID gains for snapshots
 
-    PIDController _pid;
+    PIDView _pid;           // Slot in the shared PIDBank
     PIDAutotuner _autotuner;
     Thermocouple* _tc;
     ChannelState _state;
 
-    // SSR time-proportioning
-    uint32_t _ssrPeriodStart;
-    bool _ssrState;
+    // SSR time-proportioning (hardware-timed)
+    SSRDriver _ssr;
 
     uint32_t _lastActiveTime;
+    bool _pidStaged;
+
+    Seqlock<ChannelSnapshot> _snapshot;
 
     void setState(ChannelState s);
-    void ssrOn();
     void ssrOff();
     void checkFaults();
 };
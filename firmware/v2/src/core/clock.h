@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Monotonic millisecond time source for the control and safety logic.
+// Production code uses SystemClock (millis()); host tests and the plant
+// simulator drive a ManualClock, so time-dependent behaviour (autotune
+// timeouts, idle timeout, buzzer sequencing) runs faster than real time.
+
+class Clock {
+public:
+    virtual ~Clock() {}
+    virtual uint32_t nowMs() const = 0;
+};
+
+class SystemClock : public Clock {
+public:
+    uint32_t nowMs() const override { return millis(); }
+
+    static SystemClock& instance() {
+        static SystemClock clock;
+        return clock;
+    }
+};
+
+class ManualClock : public Clock {
+public:
+    explicit ManualClock(uint32_t startMs = 0) : _now(startMs) {}
+
+    uint32_t nowMs() const override { return _now; }
+    void set(uint32_t ms)           { _now = ms; }
+    void advance(uint32_t ms)       { _now += ms; }
+
+private:
+    uint32_t _now;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+
+// Q16.16 signed fixed-point: 16 integer bits, 16 fractional bits
+// (range +/-32768, resolution 1/65536).
+// All arithmetic is integer-only and saturating, so a sequence of
+// operations gives bit-identical results on the ESP32 and on the host
+// (native test env), and never touches the FPU.
+
+class Q16_16 {
+public:
+    static const int32_t ONE = 1L << 16;
+
+    Q16_16() : _raw(0) {}
+    explicit Q16_16(float f) : _raw(fromFloat(f)) {}
+
+    static Q16_16 fromRaw(int32_t r) { Q16_16 q; q._raw = r; return q; }
+    static Q16_16 fromInt(int32_t i) { return fromRaw(sat((int64_t)i * ONE)); }
+    int32_t raw() const { return _raw; }
+    explicit operator float() const { return (float)_raw / (float)ONE; }
+
+    Q16_16 operator+(Q16_16 o) const { return fromRaw(sat((int64_t)_raw + o._raw)); }
+    Q16_16 operator-(Q16_16 o) const { return fromRaw(sat((int64_t)_raw - o._raw)); }
+    Q16_16 operator-() const         { return fromRaw(sat(-(int64_t)_raw)); }
+
+    // Round half up on the dropped 16 fractional bits
+    Q16_16 operator*(Q16_16 o) const {
+        int64_t p = (int64_t)_raw * o._raw;
+        return fromRaw(sat((p + (ONE / 2)) >> 16));
+    }
+
+    // Truncates toward zero; divide-by-zero saturates by sign
+    Q16_16 operator/(Q16_16 o) const {
+        if (o._raw == 0) return fromRaw(_raw >= 0 ? INT32_MAX : INT32_MIN);
+        return fromRaw(sat(((int64_t)_raw * ONE) / o._raw));
+    }
+
+    Q16_16& operator+=(Q16_16 o) { *this = *this + o; return *this; }
+    Q16_16& operator-=(Q16_16 o) { *this = *this - o; return *this; }
+
+    bool operator< (Q16_16 o) const { return _raw <  o._raw; }
+    bool operator> (Q16_16 o) const { return _raw >  o._raw; }
+    bool operator<=(Q16_16 o) const { return _raw <= o._raw; }
+    bool operator>=(Q16_16 o) const { return _raw >= o._raw; }
+    bool operator==(Q16_16 o) const { return _raw == o._raw; }
+    bool operator!=(Q16_16 o) const { return _raw != o._raw; }
+
+private:
+    int32_t _raw;
+
+    static int32_t sat(int64_t v) {
+        if (v > INT32_MAX) return INT32_MAX;
+        if (v < INT32_MIN) return INT32_MIN;
+        return (int32_t)v;
+    }
+
+    // Scaling by 2^16 is exact in float; only the final rounding and
+    // the saturation bounds matter. NaN maps to zero.
+    static int32_t fromFloat(float f) {
+        if (f != f) return 0;
+        float scaled = f * (float)ONE;
+        if (scaled >= 2147483647.0f) return INT32_MAX;
+        if (scaled <= -2147483648.0f) return INT32_MIN;
+        return (int32_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+    }
+};
@@ -1,106 +1,107 @@
 #include "pid.h"
 
-PIDController::PIDController()
+template <typename T>
+PIDController<T>::PIDController()
     : _kp(PID_KP_DEFAULT), _ki(PID_KI_DEFAULT), _kd(PID_KD_DEFAULT),
-      _setpoint(0), _output(0),
+      _setpoint(0.0f), _output(0.0f),
       _outputMin(PID_OUTPUT_MIN), _outputMax(PID_OUTPUT_MAX),
-      _integral(0), _prevMeasurement(0), _lastError(0),
-      _pTerm(0), _iTerm(0), _dTerm(0),
+      _integral(0.0f), _prevMeasurement(0.0f), _lastError(0.0f),
+      _pTerm(0.0f), _iTerm(0.0f), _dTerm(0.0f),
       _derivativeFilterAlpha(PID_DERIVATIVE_FILTER),
       _sampleTimeMs(PID_SAMPLE_MS),
-      _lastComputeTime(0),
       _enabled(false), _firstRun(true) {}
 
-void PIDController::begin(float kp, float ki, float kd, uint32_t sampleTimeMs) {
-    _kp = kp;
-    _ki = ki;
-    _kd = kd;
+template <typename T>
+void PIDController<T>::begin(float kp, float ki, float kd, uint32_t sampleTimeMs) {
+    _kp = T(kp);
+    _ki = T(ki);
+    _kd = T(kd);
     _sampleTimeMs = sampleTimeMs;
     reset();
 }
 
-void PIDController::setTunings(float kp, float ki, float kd) {
+template <typename T>
+void PIDController<T>::setTunings(float kp, float ki, float kd) {
     if (kp < 0 || ki < 0 || kd < 0) return;
 
     float sampleTimeSec = (float)_sampleTimeMs / 1000.0f;
-    _kp = kp;
-    _ki = ki * sampleTimeSec;
-    _kd = kd / sampleTimeSec;
+    _kp = T(kp);
+    _ki = T(ki * sampleTimeSec);
+    _kd = T(kd / sampleTimeSec);
 }
 
-void PIDController::setOutputLimits(float min, float max) {
+template <typename T>
+void PIDController<T>::setOutputLimits(float min, float max) {
     if (min >= max) return;
-    _outputMin = min;
-    _outputMax = max;
-    _integral = constrain(_integral, _outputMin, _outputMax);
-    _output = constrain(_output, _outputMin, _outputMax);
+    _outputMin = T(min);
+    _outputMax = T(max);
+    _integral = clamp(_integral, _outputMin, _outputMax);
+    _output = clamp(_output, _outputMin, _outputMax);
 }
 
-void PIDController::setSetpoint(float setpoint) {
-    _setpoint = constrain(setpoint, TEMP_MIN_F, TEMP_MAX_F);
+template <typename T>
+void PIDController<T>::setSetpoint(float setpoint) {
+    _setpoint = T(constrain(setpoint, TEMP_MIN_F, TEMP_MAX_F));
 }
 
-void PIDController::setDerivativeFilter(float alpha) {
-    _derivativeFilterAlpha = constrain(alpha, 0.01f, 1.0f);
+template <typename T>
+void PIDController<T>::setDerivativeFilter(float alpha) {
+    _derivativeFilterAlpha = T(constrain(alpha, 0.01f, 1.0f));
 }
 
-float PIDController::compute(float measurement) {
-    if (!_enabled) {
-        _output = 0;
-        return _output;
-    }
+template <typename T>
+float PIDController<T>::compute(float measurement, uint32_t dtMs) {
+    return step(T(measurement), dtMs);
+}
 
-    uint32_t now = millis();
-    if ((now - _lastComputeTime) < _sampleTimeMs) {
-        return _output;
+template <typename T>
+float PIDController<T>::computeQ16(int32_t measurementQ16, uint32_t dtMs) {
+    return step(pidFromQ16<T>(measurementQ16), dtMs);
+}
+
+template <typename T>
+float PIDController<T>::step(T meas, uint32_t dtMs) {
+    if (!_enabled) {
+        _output = T();
+        return 0.0f;
     }
+    if (dtMs == 0) return (float)_output;
 
     if (_firstRun) {
-        _prevMeasurement = measurement;
+        _prevMeasurement = meas;
         _firstRun = false;
-        _lastComputeTime = now;
-        return _output;
+        return (float)_output;
     }
 
-    float error = _setpoint - measurement;
-    _lastError = error;
-
-    // Proportional
-    _pTerm = _kp * error;
-
-    // Integral with anti-windup clamping
-    _integral += _ki * error;
-    _integral = constrain(_integral, _outputMin, _outputMax);
+    // Gains are pre-scaled for the nominal sample time; a stalled task
+    // is capped so one late tick can't dump a burst into the integral
+    pidKernel(meas, pidDtScale<T>(dtMs, _sampleTimeMs), _setpoint, _kp, _ki, _kd,
+              _derivativeFilterAlpha, _outputMin, _outputMax,
+              _integral, _prevMeasurement, _lastError, _pTerm, _dTerm, _output);
     _iTerm = _integral;
 
-    // Derivative on measurement (not error) with low-pass filter
-    float dMeasurement = measurement - _prevMeasurement;
-    float dRaw = -_kd * dMeasurement;
-    _dTerm = _derivativeFilterAlpha * dRaw + (1.0f - _derivativeFilterAlpha) * _dTerm;
-
-    // Sum and clamp
-    _output = constrain(_pTerm + _iTerm + _dTerm, _outputMin, _outputMax);
-
-    _prevMeasurement = measurement;
-    _lastComputeTime = now;
-
-    return _output;
+    return (float)_output;
 }
 
-void PIDController::reset() {
-    _integral = 0;
-    _prevMeasurement = 0;
-    _lastError = 0;
-    _pTerm = _iTerm = _dTerm = 0;
-    _output = 0;
+template <typename T>
+void PIDController<T>::reset() {
+    _integral = T(0.0f);
+    _prevMeasurement = T(0.0f);
+    _lastError = T(0.0f);
+    _pTerm = _iTerm = _dTerm = T(0.0f);
+    _output = T(0.0f);
     _firstRun = true;
-    _lastComputeTime = millis();
 }
 
-void PIDController::setEnabled(bool enabled) {
+template <typename T>
+void PIDController<T>::setEnabled(bool enabled) {
     if (enabled && !_enabled) {
         reset();  // Bumpless transfer
     }
     _enabled = enabled;
-    if (!_enabled) _output = 0;
+    if (!_enabled) _output = T(0.0f);
 }
+
+// Both kernels are always available; PIDScalar picks the default
+template class PIDController<float>;
+template class PIDController<Q16_16>;
@@ -2,6 +2,7 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "core/fixed.h"
 
 // Production-grade PID controller with:
 // - Anti-windup (integral clamping)
@@ -9,7 +10,65 @@
 // - Low-pass derivative filter
 // - Bumpless transfer on enable/disable
 // - Thread-safe (designed for RTOS)
+// - Caller-measured dt (no internal clock)
+//
+// Templated on the arithmetic type. PIDController<float> uses the FPU;
+// PIDController<Q16_16> is integer-only and bit-identical on target and
+// host. The public API stays in float either way; values are converted
+// at the boundary. PID_FIXED_POINT (platformio.ini) picks the default.
 
+#if PID_FIXED_POINT
+typedef Q16_16 PIDScalar;
+#else
+typedef float PIDScalar;
+#endif
+
+// Q16.16 raw value to the kernel type. Integer-only for Q16_16.
+template <typename T> inline T pidFromQ16(int32_t raw);
+template <> inline float pidFromQ16<float>(int32_t raw)   { return (float)raw / (float)Q16_16::ONE; }
+template <> inline Q16_16 pidFromQ16<Q16_16>(int32_t raw) { return Q16_16::fromRaw(raw); }
+
+// I/D scale for a measured interval: dtMs / sampleTimeMs, capped at
+// PID_DT_MAX_SCALE. Exactly 1 on a nominal tick, in either kernel.
+// Built in integer math so the fixed-point kernel stays off the FPU.
+template <typename T>
+inline T pidDtScale(uint32_t dtMs, uint32_t sampleTimeMs) {
+    if (sampleTimeMs == 0) return pidFromQ16<T>(Q16_16::ONE);
+    uint32_t maxMs = sampleTimeMs * PID_DT_MAX_SCALE;
+    if (dtMs > maxMs) dtMs = maxMs;
+    return pidFromQ16<T>((int32_t)(((int64_t)dtMs << 16) / sampleTimeMs));
+}
+
+template <typename T>
+inline T pidClamp(T v, T lo, T hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+// One PID step: the control law shared by PIDController and PIDBank.
+// Gains are pre-scaled for the nominal sample time and `scale` comes
+// from pidDtScale(); integral anti-windup, derivative on measurement
+// with a low-pass filter, output clamp. Updates the state in place.
+template <typename T>
+inline void pidKernel(T meas, T scale, T setpoint, T kp, T ki, T kd, T alpha,
+                      T outMin, T outMax,
+                      T& integral, T& prevMeas, T& error, T& pTerm, T& dTerm, T& output) {
+    error = setpoint - meas;
+
+    // Proportional
+    pTerm = kp * error;
+
+    // Integral with anti-windup clamping
+    integral = pidClamp(integral + ki * error * scale, outMin, outMax);
+
+    // Derivative on measurement (not error) with low-pass filter
+    T dRaw = -(kd * (meas - prevMeas)) / scale;
+    dTerm = alpha * dRaw + (pidFromQ16<T>(Q16_16::ONE) - alpha) * dTerm;
+
+    // Sum and clamp
+    output = pidClamp(pTerm + integral + dTerm, outMin, outMax);
+
+    prevMeas = meas;
+}
+
+template <typename T = PIDScalar>
 class PIDController {
 public:
     PIDController();
@@ -20,38 +79,48 @@ public:
     void setSetpoint(float setpoint);
     void setDerivativeFilter(float alpha);
 
-    // Compute PID - returns output percentage [0-100]
-    float compute(float measurement);
+    // Compute PID over the measured interval since the last call.
+    // Returns output percentage [0-100]. The I and D terms scale by
+    // dtMs / sampleTimeMs, so a late or early tick is integrated
+    // correctly instead of being skipped.
+    float compute(float measurement, uint32_t dtMs);
+    // Same, with the measurement already in Q16.16 (e.g. straight from
+    // the thermocouple's integer reading); no float on the way in.
+    float computeQ16(int32_t measurementQ16, uint32_t dtMs);
 
     void reset();
     void setEnabled(bool enabled);
 
     // Getters
     bool isEnabled() const      { return _enabled; }
-    float getSetpoint() const   { return _setpoint; }
-    float getOutput() const     { return _output; }
-    float getKp() const         { return _kp; }
-    float getKi() const         { return _ki; }
-    float getKd() const         { return _kd; }
-    float getPTerm() const      { return _pTerm; }
-    float getITerm() const      { return _iTerm; }
-    float getDTerm() const      { return _dTerm; }
-    float getError() const      { return _lastError; }
+    float getSetpoint() const   { return (float)_setpoint; }
+    float getOutput() const     { return (float)_output; }
+    float getKp() const         { return (float)_kp; }
+    float getKi() const         { return (float)_ki; }
+    float getKd() const         { return (float)_kd; }
+    float getPTerm() const      { return (float)_pTerm; }
+    float getITerm() const      { return (float)_iTerm; }
+    float getDTerm() const      { return (float)_dTerm; }
+    float getError() const      { return (float)_lastError; }
+    T getRawOutput() const      { return _output; }
 
 private:
-    float _kp, _ki, _kd;
-    float _setpoint;
-    float _output;
-    float _outputMin, _outputMax;
+    T _kp, _ki, _kd;
+    T _setpoint;
+    T _output;
+    T _outputMin, _outputMax;
 
-    float _integral;
-    float _prevMeasurement;
-    float _lastError;
-    float _pTerm, _iTerm, _dTerm;
-    float _derivativeFilterAlpha;
+    T _integral;
+    T _prevMeasurement;
+    T _lastError;
+    T _pTerm, _iTerm, _dTerm;
+    T _derivativeFilterAlpha;
 
     uint32_t _sampleTimeMs;
-    uint32_t _lastComputeTime;
     bool _enabled;
     bool _firstRun;
+
+    float step(T meas, uint32_t dtMs);
+
+    static T clamp(T v, T lo, T hi) { return pidClamp(v, lo, hi); }
 };
@@ -0,0 +1,129 @@
+#include "pid_bank.h"
+
+template <uint8_t N, typename T>
+PIDBank<N, T>::PIDBank() {
+    for (uint8_t i = 0; i < N; i++) {
+        _kp[i] = T(PID_KP_DEFAULT);
+        _ki[i] = T(PID_KI_DEFAULT);
+        _kd[i] = T(PID_KD_DEFAULT);
+        _setpoint[i] = T(0.0f);
+        _outputMin[i] = T(PID_OUTPUT_MIN);
+        _outputMax[i] = T(PID_OUTPUT_MAX);
+        _derivativeFilterAlpha[i] = T(PID_DERIVATIVE_FILTER);
+        _sampleTimeMs[i] = PID_SAMPLE_MS;
+        _enabled[i] = false;
+        _staged[i] = false;
+        _measurement[i] = T(0.0f);
+        _integral[i] = _prevMeasurement[i] = _lastError[i] = T(0.0f);
+        _pTerm[i] = _dTerm[i] = _output[i] = T(0.0f);
+        _firstRun[i] = true;
+    }
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::begin(uint8_t ch, float kp, float ki, float kd, uint32_t sampleTimeMs) {
+    _kp[ch] = T(kp);
+    _ki[ch] = T(ki);
+    _kd[ch] = T(kd);
+    _sampleTimeMs[ch] = sampleTimeMs;
+    reset(ch);
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::setTunings(uint8_t ch, float kp, float ki, float kd) {
+    if (kp < 0 || ki < 0 || kd < 0) return;
+
+    float sampleTimeSec = (float)_sampleTimeMs[ch] / 1000.0f;
+    _kp[ch] = T(kp);
+    _ki[ch] = T(ki * sampleTimeSec);
+    _kd[ch] = T(kd / sampleTimeSec);
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::setOutputLimits(uint8_t ch, float min, float max) {
+    if (min >= max) return;
+    _outputMin[ch] = T(min);
+    _outputMax[ch] = T(max);
+    _integral[ch] = clamp(_integral[ch], _outputMin[ch], _outputMax[ch]);
+    _output[ch] = clamp(_output[ch], _outputMin[ch], _outputMax[ch]);
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::setSetpoint(uint8_t ch, float setpoint) {
+    _setpoint[ch] = T(constrain(setpoint, TEMP_MIN_F, TEMP_MAX_F));
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::setDerivativeFilter(uint8_t ch, float alpha) {
+    _derivativeFilterAlpha[ch] = T(constrain(alpha, 0.01f, 1.0f));
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::stage(uint8_t ch, float measurement) {
+    _measurement[ch] = T(measurement);
+    _staged[ch] = true;
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::stageQ16(uint8_t ch, int32_t measurementQ16) {
+    _measurement[ch] = pidFromQ16<T>(measurementQ16);
+    _staged[ch] = true;
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::compute(uint32_t dtMs) {
+    for (uint8_t i = 0; i < N; i++) {
+        if (_staged[i]) step(i, dtMs);
+    }
+}
+
+template <uint8_t N, typename T>
+float PIDBank<N, T>::computeOne(uint8_t ch, uint32_t dtMs) {
+    step(ch, dtMs);
+    return (float)_output[ch];
+}
+
+template <uint8_t N, typename T>
+inline void PIDBank<N, T>::step(uint8_t i, uint32_t dtMs) {
+    _staged[i] = false;
+
+    if (!_enabled[i]) {
+        _output[i] = T();
+        return;
+    }
+    if (dtMs == 0) return;
+
+    T meas = _measurement[i];
+    if (_firstRun[i]) {
+        _prevMeasurement[i] = meas;
+        _firstRun[i] = false;
+        return;
+    }
+
+    pidKernel(meas, pidDtScale<T>(dtMs, _sampleTimeMs[i]), _setpoint[i], _kp[i], _ki[i], _kd[i],
+              _derivativeFilterAlpha[i], _outputMin[i], _outputMax[i],
+              _integral[i], _prevMeasurement[i], _lastError[i], _pTerm[i], _dTerm[i], _output[i]);
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::reset(uint8_t ch) {
+    _integral[ch] = T(0.0f);
+    _prevMeasurement[ch] = T(0.0f);
+    _lastError[ch] = T(0.0f);
+    _pTerm[ch] = _dTerm[ch] = T(0.0f);
+    _output[ch] = T(0.0f);
+    _staged[ch] = false;
+    _firstRun[ch] = true;
+}
+
+template <uint8_t N, typename T>
+void PIDBank<N, T>::setEnabled(uint8_t ch, bool enabled) {
+    if (enabled && !_enabled[ch]) {
+        reset(ch);  // Bumpless transfer
+    }
+    _enabled[ch] = enabled;
+    if (!_enabled[ch]) _output[ch] = T(0.0f);
+}
+
+template class PIDBank<NUM_CHANNELS, float>;
+template class PIDBank<NUM_CHANNELS, Q16_16>;
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "core/pid.h"
+
+// Structure-of-arrays PID engine for all channels.
+// Same control law as PIDController<T> (both run pidKernel()), but
+// gains and state live in parallel arrays and compute() runs every
+// staged channel in one loop, so the per-tick cost is flat and
+// predictable.
+//
+// Channels stage their measurement through a View during the tick;
+// the PID task then calls compute() once. A View exposes the same API
+// as PIDController, so Channel and the UI use it unchanged.
+
+template <uint8_t N, typename T = PIDScalar>
+class PIDBank {
+public:
+    class View {
+    public:
+        View() : _bank(nullptr), _ch(0) {}
+        View(PIDBank* bank, uint8_t ch) : _bank(bank), _ch(ch) {}
+
+        void begin(float kp, float ki, float kd, uint32_t sampleTimeMs) {
+            _bank->begin(_ch, kp, ki, kd, sampleTimeMs);
+        }
+        void setTunings(float kp, float ki, float kd)   { _bank->setTunings(_ch, kp, ki, kd); }
+        void setOutputLimits(float min, float max)      { _bank->setOutputLimits(_ch, min, max); }
+        void setSetpoint(float setpoint)                { _bank->setSetpoint(_ch, setpoint); }
+        void setDerivativeFilter(float alpha)           { _bank->setDerivativeFilter(_ch, alpha); }
+
+        // Stage a measurement for the next PIDBank::compute()
+        void stage(float measurement)                   { _bank->stage(_ch, measurement); }
+        void stageQ16(int32_t measurementQ16)           { _bank->stageQ16(_ch, measurementQ16); }
+        // Stage and compute this channel alone
+        float compute(float measurement, uint32_t dtMs) {
+            _bank->stage(_ch, measurement);
+            return _bank->computeOne(_ch, dtMs);
+        }
+
+        void reset()                                    { _bank->reset(_ch); }
+        void setEnabled(bool enabled)                   { _bank->setEnabled(_ch, enabled); }
+
+        bool isEnabled() const      { return _bank->_enabled[_ch]; }
+        float getSetpoint() const   { return (float)_bank->_setpoint[_ch]; }
+        float getOutput() const     { return (float)_bank->_output[_ch]; }
+        float getKp() const         { return (float)_bank->_kp[_ch]; }
+        float getKi() const         { return (float)_bank->_ki[_ch]; }
+        float getKd() const         { return (float)_bank->_kd[_ch]; }
+        float getPTerm() const      { return (float)_bank->_pTerm[_ch]; }
+        float getITerm() const      { return (float)_bank->_integral[_ch]; }
+        float getDTerm() const      { return (float)_bank->_dTerm[_ch]; }
+        float getError() const      { return (float)_bank->_lastError[_ch]; }
+        T getRawOutput() const      { return _bank->_output[_ch]; }
+
+    private:
+        PIDBank* _bank;
+        uint8_t _ch;
+    };
+
+    PIDBank();
+
+    View view(uint8_t ch) { return View(this, ch < N ? ch : 0); }
+
+    // Compute every channel that staged a measurement since the last
+    // call, over the measured tick interval dtMs
+    void compute(uint32_t dtMs);
+
+private:
+    // Parallel per-channel arrays (hot path first)
+    T _kp[N], _ki[N], _kd[N];
+    T _setpoint[N];
+    T _measurement[N];
+    T _prevMeasurement[N];
+    T _integral[N];
+    T _dTerm[N];
+    T _output[N];
+    T _outputMin[N], _outputMax[N];
+    T _derivativeFilterAlpha[N];
+    T _pTerm[N], _lastError[N];
+
+    bool _enabled[N];
+    bool _firstRun[N];
+    bool _staged[N];
+
+    uint32_t _sampleTimeMs[N];
+
+    void begin(uint8_t ch, float kp, float ki, float kd, uint32_t sampleTimeMs);
+    void setTunings(uint8_t ch, float kp, float ki, float kd);
+    void setOutputLimits(uint8_t ch, float min, float max);
+    void setSetpoint(uint8_t ch, float setpoint);
+    void setDerivativeFilter(uint8_t ch, float alpha);
+    void stage(uint8_t ch, float measurement);
+    void stageQ16(uint8_t ch, int32_t measurementQ16);
+    float computeOne(uint8_t ch, uint32_t dtMs);
+    void reset(uint8_t ch);
+    void setEnabled(uint8_t ch, bool enabled);
+
+    inline void step(uint8_t ch, uint32_t dtMs);
+
+    static T clamp(T v, T lo, T hi) { return pidClamp(v, lo, hi); }
+};
+
+typedef PIDBank<NUM_CHANNELS>::View PIDView;
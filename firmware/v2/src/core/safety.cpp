@@ -1,7 +1,8 @@
 #include "safety.h"
+#include "drivers/ssr.h"
 
-SafetyManager::SafetyManager()
-    : _faults(FAULT_NONE), _shutdown(false), _idleTimedOut(false),
+SafetyManager::SafetyManager(const Clock& clock)
+    : _clock(&clock), _faults(FAULT_NONE), _shutdown(false), _idleTimedOut(false),
       _idleTimeoutMin(IDLE_TIMEOUT_MIN_DEFAULT), _lastActivityTime(0),
       _faultQueue(nullptr),
       _buzzerHead(0), _buzzerTail(0), _buzzerNoteStart(0), _buzzerPlaying(false) {}
@@ -16,9 +17,10 @@ void SafetyManager::begin(QueueHandle_t faultQueue) {
     esp_task_wdt_init(WATCHDOG_TIMEOUT_S, true);
     esp_task_wdt_add(NULL);
 
-    _lastActivityTime = millis();
+    _lastActivityTime = _clock->nowMs();
     _faults = FAULT_NONE;
     _shutdown = false;
+    SSRDriver::rearm();
 
     confirmPattern();
 }
@@ -29,7 +31,7 @@ void SafetyManager::update() {
 
     // Idle timeout check
     if (_idleTimeoutMin > 0 && !_idleTimedOut) {
-        uint32_t elapsedMs = millis() - _lastActivityTime;
+        uint32_t elapsedMs = _clock->nowMs() - _lastActivityTime;
         uint32_t timeoutMs = _idleTimeoutMin * 60UL * 1000UL;
 
         if (elapsedMs >= timeoutMs) {
@@ -49,7 +51,7 @@ void SafetyManager::update() {
 
     // Status LED
     if (hasFault()) {
-        digitalWrite(PIN_STATUS_LED, (millis() / 250) % 2);
+        digitalWrite(PIN_STATUS_LED, (_clock->nowMs() / 250) % 2);
     } else if (!_shutdown) {
         digitalWrite(PIN_STATUS_LED, HIGH);
     } else {
@@ -58,14 +60,14 @@ void SafetyManager::update() {
 }
 
 void SafetyManager::resetIdleTimer() {
-    _lastActivityTime = millis();
+    _lastActivityTime = _clock->nowMs();
     _idleTimedOut = false;
     clearFault(FAULT_IDLE_TIMEOUT);
 }
 
 uint32_t SafetyManager::getIdleMinRemaining() const {
     if (_idleTimeoutMin == 0) return 0;
-    uint32_t elapsedMs = millis() - _lastActivityTime;
+    uint32_t elapsedMs = _clock->nowMs() - _lastActivityTime;
     uint32_t timeoutMs = _idleTimeoutMin * 60UL * 1000UL;
     if (elapsedMs >= timeoutMs) return 0;
     // Round up to avoid showing 0 when time remains
@@ -88,7 +90,7 @@ void SafetyManager::setFault(SafetyFault fault, uint8_t channel, float temp) {
         evt.fault = fault;
         evt.channel = channel;
         evt.temperature = temp;
-        evt.timestamp = millis();
+        evt.timestamp = _clock->nowMs();
         xQueueSend(_faultQueue, &evt, 0);  // Non-blocking
     }
 }
@@ -121,7 +123,7 @@ void SafetyManager::updateBuzzer() {
             } else {
                 noTone(PIN_BUZZER);
             }
-            _buzzerNoteStart = millis();
+            _buzzerNoteStart = _clock->nowMs();
             _buzzerPlaying = true;
         }
         return;
@@ -129,7 +131,7 @@ void SafetyManager::updateBuzzer() {
 
     // Check if current note is done
     BuzzerNote& current = _buzzerQueue[_buzzerHead];
-    if ((millis() - _buzzerNoteStart) >= current.durationMs) {
+    if ((_clock->nowMs() - _buzzerNoteStart) >= current.durationMs) {
         noTone(PIN_BUZZER);
         _buzzerHead = (_buzzerHead + 1) % BUZZER_QUEUE_SIZE;
         _buzzerPlaying = false;
@@ -145,9 +147,7 @@ void SafetyManager::enqueueBuzzerNote(uint16_t freq, uint16_t duration) {
 
 void SafetyManager::emergencyShutdown() {
     _shutdown = true;
-    for (int i = 0; i < NUM_CHANNELS; i++) {
-        digitalWrite(SSR_PINS[i], LOW);
-    }
+    SSRDriver::forceAllOff();
     alarmPattern();
 }
 
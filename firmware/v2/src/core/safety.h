@@ -5,6 +5,7 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
 #include "config.h"
+#include "core/clock.h"
 
 // Safety fault codes (bitmask)
 enum SafetyFault : uint8_t {
@@ -27,7 +28,7 @@ struct FaultEvent {
 
 class SafetyManager {
 public:
-    SafetyManager();
+    explicit SafetyManager(const Clock& clock = SystemClock::instance());
 
     void begin(QueueHandle_t faultQueue);
     void update();
@@ -59,6 +60,7 @@ public:
     void feedWatchdog();
 
 private:
+    const Clock* _clock;
     uint8_t _faults;
     bool _shutdown;
     bool _idleTimedOut;
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+// Single-writer, multi-reader publication of a small POD value across
+// cores without a mutex (no priority inversion in the writer).
+//
+// Double-buffered seqlock: the writer fills the slot readers are not
+// pointed at, then bumps the sequence to flip. A reader copies the
+// current slot and retries only if publishes landed during the copy, so
+// it never waits on a writer it has preempted mid-copy (taskSafety
+// outranks taskPID on core 1). A copy takes microseconds against a
+// 250 ms PID tick, so reads are effectively wait-free. The writer never
+// waits.
+
+template <typename T>
+class Seqlock {
+public:
+    Seqlock() : _seq(0) { memset(_slot, 0, sizeof(_slot)); }
+
+    // Writer side (one task only)
+    void publish(const T& value) {
+        uint32_t next = _seq.load(std::memory_order_relaxed) + 1;
+        // A reader that sees any byte of this copy must also see the
+        // sequence already moved past the slot's previous occupant
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&_slot[next & 1], &value, sizeof(T));
+        _seq.store(next, std::memory_order_release);
+    }
+
+    // Reader side (any task, any core). Returns the sequence number
+    // of the copy, 0 if nothing has been published yet.
+    uint32_t read(T& out) const {
+        for (;;) {
+            uint32_t s1 = _seq.load(std::memory_order_acquire);
+            memcpy(&out, &_slot[s1 & 1], sizeof(T));
+            // Keep the copy from sinking below the second sequence load
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // Slot s1 & 1 is next rewritten by publish #(s1 + 2), which
+            // starts only after the sequence moved past s1
+            if (_seq.load(std::memory_order_relaxed) == s1) return s1;
+        }
+    }
+
+    T read() const { T out; read(out); return out; }
+
+    uint32_t sequence() const { return _seq.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<uint32_t> _seq;
+    T _slot[2];
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+// Base of the incremental JSON writers served as chunked HTTP responses.
+// A subclass formats one small piece at a time (an opening brace, one
+// record, the closing brackets) into the piece buffer; read() copies
+// pieces out in whatever slices the TCP stack asks for, so memory use
+// does not depend on the length of the document.
+
+template <size_t PieceSize>
+class ChunkedJson {
+public:
+    virtual ~ChunkedJson() {}
+
+    // Copy up to maxLen further bytes of JSON into buf. Returns 0 at the end.
+    size_t read(uint8_t* buf, size_t maxLen) {
+        size_t n = 0;
+        while (n < maxLen) {
+            if (_pieceOff >= _pieceLen && !nextPiece()) break;
+            size_t take = min((size_t)(_pieceLen - _pieceOff), maxLen - n);
+            memcpy(buf + n, _piece + _pieceOff, take);
+            _pieceOff += take;
+            n += take;
+        }
+        return n;
+    }
+
+protected:
+    ChunkedJson() : _pieceLen(0), _pieceOff(0) {}
+
+    // Format the next piece into _piece and return setPiece(len), or
+    // return false once the document is complete
+    virtual bool nextPiece() = 0;
+
+    // Take `len` (snprintf's result) bytes of _piece as the next piece
+    bool setPiece(int len) {
+        _pieceLen = (uint16_t)min(max(len, 0), (int)PieceSize - 1);
+        _pieceOff = 0;
+        return true;
+    }
+
+    char _piece[PieceSize];
+
+private:
+    uint16_t _pieceLen;
+    uint16_t _pieceOff;
+};
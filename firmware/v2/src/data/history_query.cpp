@@ -0,0 +1,300 @@
+#include "history_query.h"
+#if ENABLE_SERIES_LOG
+
+// ============================================================
+// ESP-Nail v2 - Downsampled history queries
+// ============================================================
+
+HistoryQuery::HistoryQuery(SeriesRecorder& rec, uint8_t ch, uint32_t fromS, uint32_t toS,
+                           uint16_t points)
+    : _rec(rec), _ch(ch), _fromMs((uint64_t)fromS * 1000), _toMs((uint64_t)toS * 1000),
+      _points(points), _idCount(0), _phase(Phase::COUNT), _total(0), _mainPos(0), _leadPos(0),
+      _bucket(0), _buckets(0), _start(0), _end(0), _nextEnd(0), _cx(0), _cy(0), _cn(0),
+      _best(-1.0), _pick(), _anchor(), _pickCount(0), _nowS(0), _next(0), _stage(Stage::OPEN) {
+    _idCount = rec.findSessions(ch, fromS, toS, _ids, SERIES_MAX_SESSIONS);
+}
+
+HistoryQuery::HistoryQuery(SeriesRecorder& rec, uint32_t sessionId, uint16_t points)
+    : HistoryQuery(rec, 0, 0, 0, points) {
+    SeriesSession s;
+    _idCount = 0;
+    if (!rec.getSession(sessionId, s)) return;
+    _ch = s.channel;
+    _fromMs = (uint64_t)s.startTime * 1000;
+    _toMs = _fromMs + (uint64_t)s.samples * s.periodMs;
+    _ids[0] = sessionId;
+    _idCount = 1;
+}
+
+static int16_t tenths(float v) {
+    return (int16_t)constrain(lroundf(v * 10.0f), (long)INT16_MIN, (long)INT16_MAX);
+}
+
+bool HistoryQuery::begin() {
+    _picks.reset(new (std::nothrow) Pick[_points]);
+    if (!_picks) return false;
+    _main.reset(this);
+    return true;
+}
+
+bool HistoryQuery::step() {
+    uint32_t budget = HISTORY_STEP_SAMPLES;
+    Point p;
+    while (budget > 0) {
+        switch (_phase) {
+            case Phase::COUNT:
+                // Counting pass: fixes the bucket edges
+                if (_main.next(p)) {
+                    _total++;
+                    budget--;
+                    break;
+                }
+                _main.reset(this);
+                _lead.reset(this);
+                if (_points >= 3 && _total > _points) {
+                    _buckets = _points - 2;
+                    _phase = Phase::FIRST;
+                } else {
+                    _phase = Phase::PASS;
+                }
+                break;
+
+            case Phase::PASS:
+                // Fits already: every sample, up to what the counting pass saw
+                if (_pickCount >= _points || _mainPos >= _total || !_main.next(p)) return finish();
+                _mainPos++;
+                budget--;
+                keep(p);
+                break;
+
+            case Phase::FIRST:
+                if (!_main.next(p)) return finish();
+                _mainPos++;
+                budget--;
+                keep(p);
+                _anchor = p;
+                startBucket();
+                break;
+
+            case Phase::LEAD:
+                // Lead cursor: average of the following bucket (LTTB "c")
+                if (_leadPos >= _nextEnd || !_lead.next(p)) {
+                    if (_cn == 0) return finish();
+                    _cx /= _cn;
+                    _cy /= _cn;
+                    _phase = Phase::MAIN;
+                    break;
+                }
+                budget--;
+                if (_leadPos++ >= _end) {
+                    _cx += (double)(p.tMs - _fromMs);
+                    _cy += p.temp;
+                    _cn++;
+                }
+                break;
+
+            case Phase::MAIN: {
+                // Main cursor: the point of this bucket spanning the
+                // largest triangle with the previous pick and that average
+                if (_mainPos >= _end || !_main.next(p)) {
+                    if (_best < 0.0) return finish();
+                    keep(_pick);
+                    _anchor = _pick;
+                    if (++_bucket >= _buckets) {
+                        _phase = Phase::LAST;
+                    } else {
+                        startBucket();
+                    }
+                    break;
+                }
+                budget--;
+                if (_mainPos++ < _start) break;
+                double ax = (double)(_anchor.tMs - _fromMs), ay = _anchor.temp;
+                double px = (double)(p.tMs - _fromMs);
+                double area = fabs((ax - _cx) * (p.temp - ay) - (ax - px) * (_cy - ay));
+                if (area > _best) {
+                    _best = area;
+                    _pick = p;
+                }
+                break;
+            }
+
+            case Phase::LAST:
+                // The final sample closes the series
+                if (_mainPos < _total && _main.next(p)) {
+                    _mainPos++;
+                    budget--;
+                    _pick = p;
+                    break;
+                }
+                if (_mainPos == _total) keep(_pick);
+                return finish();
+
+            case Phase::DONE:
+                return true;
+        }
+    }
+    return false;
+}
+
+void HistoryQuery::startBucket() {
+    _start = bucketStart(_bucket);
+    _end = bucketStart(_bucket + 1);
+    _nextEnd = (_bucket + 1 < _buckets) ? bucketStart(_bucket + 2) : _total;
+    _cx = _cy = 0.0;
+    _cn = 0;
+    _best = -1.0;
+    _phase = Phase::LEAD;
+}
+
+void HistoryQuery::keep(const Point& p) {
+    if (_pickCount >= _points) return;
+    Pick& k = _picks[_pickCount++];
+    k.tMs = (uint32_t)(p.tMs - _fromMs);
+    k.temp = tenths(p.temp);
+    k.setpoint = tenths(p.setpoint);
+    k.output = tenths(p.output);
+}
+
+// Release the segment files before the response goes out
+bool HistoryQuery::finish() {
+    _main.reset(this);
+    _lead.reset(this);
+    _nowS = millis() / 1000;
+    _phase = Phase::DONE;
+    return true;
+}
+
+bool HistoryQuery::nextPiece() {
+    int len = 0;
+    switch (_stage) {
+        case Stage::OPEN:
+            len = snprintf(_piece, sizeof(_piece),
+                           "{\"ch\":%u,\"from\":%lu,\"to\":%lu,\"now\":%lu,\"total\":%lu,\"points\":[",
+                           _ch, (unsigned long)(_fromMs / 1000), (unsigned long)(_toMs / 1000),
+                           (unsigned long)_nowS, (unsigned long)_total);
+            _stage = Stage::POINTS;
+            break;
+
+        case Stage::POINTS: {
+            if (_next >= _pickCount) {
+                _stage = Stage::CLOSE;
+                return nextPiece();
+            }
+            const Pick& k = _picks[_next];
+            uint64_t tMs = _fromMs + k.tMs;
+            len = snprintf(_piece, sizeof(_piece), "%s[%lu.%02u,%.1f,%.1f,%.1f]",
+                           _next ? "," : "",
+                           (unsigned long)(tMs / 1000), (unsigned)(tMs % 1000) / 10,
+                           k.temp / 10.0f, k.setpoint / 10.0f, k.output / 10.0f);
+            _next++;
+            break;
+        }
+
+        case Stage::CLOSE:
+            len = snprintf(_piece, sizeof(_piece), "]}");
+            _stage = Stage::DONE;
+            break;
+
+        case Stage::DONE:
+            return false;
+    }
+    return setPiece(len);
+}
+
+// First sample of interior bucket b; bucketStart(_buckets) is the last sample
+uint32_t HistoryQuery::bucketStart(uint16_t b) const {
+    return 1 + (uint32_t)((uint64_t)b * (_total - 2) / _buckets);
+}
+
+// ---------------------------------------------------------------------------
+// HistorySessions
+// ---------------------------------------------------------------------------
+
+HistorySessions::HistorySessions(SeriesRecorder& rec)
+    : _sessions(new (std::nothrow) SeriesSession[SERIES_MAX_SESSIONS]), _count(0),
+      _boot(rec.currentBoot()), _next(0), _stage(Stage::OPEN) {
+    if (_sessions) _count = rec.getSessions(_sessions.get(), SERIES_MAX_SESSIONS);
+}
+
+bool HistorySessions::nextPiece() {
+    int len = 0;
+    switch (_stage) {
+        case Stage::OPEN:
+            len = snprintf(_piece, sizeof(_piece), "{\"boot\":%u,\"sessions\":[", _boot);
+            _stage = Stage::SESSIONS;
+            break;
+
+        case Stage::SESSIONS: {
+            if (_next >= _count) {
+                _stage = Stage::CLOSE;
+                return nextPiece();
+            }
+            const SeriesSession& s = _sessions[_next];
+            len = snprintf(_piece, sizeof(_piece),
+                           "%s{\"id\":%lu,\"ch\":%u,\"boot\":%u,\"start\":%lu,"
+                           "\"samples\":%lu,\"periodMs\":%u}",
+                           _next ? "," : "",
+                           (unsigned long)s.id, s.channel, s.boot, (unsigned long)s.startTime,
+                           (unsigned long)s.samples, s.periodMs);
+            _next++;
+            break;
+        }
+
+        case Stage::CLOSE:
+            len = snprintf(_piece, sizeof(_piece), "]}");
+            _stage = Stage::DONE;
+            break;
+
+        case Stage::DONE:
+            return false;
+    }
+    return setPiece(len);
+}
+
+// ---------------------------------------------------------------------------
+// Cursor
+// ---------------------------------------------------------------------------
+
+void HistoryQuery::Cursor::reset(HistoryQuery* q) {
+    _q = q;
+    _session = 0;
+    _open = false;
+    _reader.close();
+}
+
+bool HistoryQuery::Cursor::next(Point& p) {
+    for (;;) {
+        if (!_open) {
+            if (_session >= _q->_idCount) return false;
+            if (!_reader.open(_q->_rec, _q->_ids[_session++])) continue;
+            const SeriesSession& s = _reader.session();
+            _startMs = (uint64_t)s.startTime * 1000;
+            _periodMs = s.periodMs ? s.periodMs : 1;
+            if (_q->_fromMs > _startMs) {
+                _reader.skipTo((uint32_t)((_q->_fromMs - _startMs + _periodMs - 1) / _periodMs));
+            }
+            _open = true;
+        }
+
+        SeriesSample s;
+        if (!_reader.next(s)) {
+            _reader.close();
+            _open = false;
+            continue;
+        }
+        uint64_t t = _startMs + (uint64_t)s.index * _periodMs;
+        if (t < _q->_fromMs) continue;
+        if (t > _q->_toMs) {
+            _reader.close();
+            _open = false;
+            continue;
+        }
+        p.tMs = t;
+        p.temp = s.tempF;
+        p.setpoint = s.setpointF;
+        p.output = s.output;
+        return true;
+    }
+}
+#endif
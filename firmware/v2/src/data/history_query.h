@@ -0,0 +1,149 @@
+#pragma once
+#include "config.h"
+#if ENABLE_SERIES_LOG
+#include <Arduino.h>
+#include <memory>
+#include "data/chunked_json.h"
+#include "data/series_recorder.h"
+
+// ============================================================
+// ESP-Nail v2 - Downsampled history queries
+// ============================================================
+//
+// Serves one channel's recorded samples between two uptime instants
+// as JSON, reduced to at most `points` samples with
+// largest-triangle-three-buckets (LTTB) on temperature:
+//
+//   {"ch":0,"from":F,"to":T,"now":N,"total":K,
+//    "points":[[t,temp,setpoint,output],...]}
+//
+// A range query covers the current boot only, as times are uptime
+// seconds. A session query serves one whole session of any boot, with
+// times in the uptime of the boot that recorded it. Blocks still in RAM
+// (the last minute or so of a running session) are not included yet.
+//
+// The selection runs in slices of at most HISTORY_STEP_SAMPLES decoded
+// samples, so a long range never holds the async TCP task for long: the
+// chunk callback calls step() and asks to be called again until it
+// returns true. A counting pass fixes the bucket edges, then two cursors
+// walk the flash side by side (the lead cursor averages bucket b+1 while
+// the main cursor picks the point of bucket b) and the picks are kept in
+// a compact array of at most `points` entries. Only then does read()
+// format that array; it never touches flash.
+
+class HistoryQuery : public ChunkedJson<96> {
+public:
+    HistoryQuery(SeriesRecorder& rec, uint8_t ch, uint32_t fromS, uint32_t toS, uint16_t points);
+    HistoryQuery(SeriesRecorder& rec, uint32_t sessionId, uint16_t points);
+
+    // Allocate the result. False if it can't be; call before responding.
+    bool begin();
+
+    // Advance the selection by one bounded slice. True once it is done
+    // and read() can be called.
+    bool step();
+
+private:
+    struct Point {
+        uint64_t tMs;           // Uptime
+        float temp;
+        float setpoint;
+        float output;
+    };
+
+    // A selected point; values in the recorder's 0.1 units
+    struct Pick {
+        uint32_t tMs;           // Since _fromMs
+        int16_t temp;
+        int16_t setpoint;
+        int16_t output;
+    };
+
+    // Samples of the selected sessions inside [from, to], in time order
+    class Cursor {
+    public:
+        Cursor() : _q(nullptr), _session(0), _open(false), _startMs(0), _periodMs(0) {}
+        void reset(HistoryQuery* q);
+        bool next(Point& p);
+    private:
+        HistoryQuery* _q;
+        SeriesReader _reader;
+        uint8_t _session;       // Next entry of _ids to open
+        bool _open;
+        uint64_t _startMs;
+        uint32_t _periodMs;
+    };
+
+    enum class Phase : uint8_t { COUNT, PASS, FIRST, LEAD, MAIN, LAST, DONE };
+    enum class Stage : uint8_t { OPEN, POINTS, CLOSE, DONE };
+
+    SeriesRecorder& _rec;
+    uint8_t _ch;
+    uint64_t _fromMs;
+    uint64_t _toMs;
+    uint16_t _points;
+
+    uint32_t _ids[SERIES_MAX_SESSIONS];     // Sessions overlapping the range
+    uint8_t _idCount;
+
+    // Selection (step() only)
+    Phase _phase;
+    uint32_t _total;            // Samples in range (counting pass)
+    Cursor _main;
+    Cursor _lead;
+    uint32_t _mainPos;          // Samples consumed by each cursor
+    uint32_t _leadPos;
+    uint16_t _bucket;
+    uint16_t _buckets;          // Interior buckets, _points - 2
+    uint32_t _start;            // Current bucket [_start, _end), next ends at _nextEnd
+    uint32_t _end;
+    uint32_t _nextEnd;
+    double _cx, _cy;            // Sum, then mean, of the next bucket (LTTB "c")
+    uint32_t _cn;
+    double _best;               // Largest triangle so far in this bucket
+    Point _pick;                // Its point; in LAST, the latest sample
+    Point _anchor;              // Last picked point (LTTB "a")
+
+    // Result
+    std::unique_ptr<Pick[]> _picks;
+    uint16_t _pickCount;
+    uint32_t _nowS;
+
+    // Output (read())
+    uint16_t _next;
+    Stage _stage;
+
+    uint32_t bucketStart(uint16_t b) const;
+    void startBucket();
+    void keep(const Point& p);
+    bool finish();
+    bool nextPiece() override;
+};
+
+// The recorded sessions of every boot still on flash, oldest first, for
+// picking one to query by id:
+//
+//   {"boot":B,"sessions":[{"id":..,"ch":..,"boot":..,"start":..,
+//    "samples":..,"periodMs":..},...]}
+//
+// The index is copied at construction, so the response never holds the
+// recorder's lock.
+class HistorySessions : public ChunkedJson<160> {
+public:
+    explicit HistorySessions(SeriesRecorder& rec);
+
+    // False if the copy of the index can't be allocated
+    bool ok() const { return (bool)_sessions; }
+
+private:
+    enum class Stage : uint8_t { OPEN, SESSIONS, CLOSE, DONE };
+
+    std::unique_ptr<SeriesSession[]> _sessions;
+    uint8_t _count;
+    uint8_t _boot;
+    uint8_t _next;
+    Stage _stage;
+
+    bool nextPiece() override;
+};
+#endif
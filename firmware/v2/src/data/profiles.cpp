@@ -1,4 +1,5 @@
 #include "profiles.h"
+#include "crc32.h"
 
 // ============================================================
 // ESP-Nail v2 - Temperature Profile Manager
@@ -7,45 +8,48 @@
 // NVS namespace for profiles (separate from main settings to avoid key collisions)
 static const char* PROFILE_NS = "enail2_prof";
 
-ProfileManager::ProfileManager() {
+ProfileManager::ProfileManager() : _dirty(0), _open(false), _lock(nullptr) {
     memset(_profiles, 0, sizeof(_profiles));
     memset(_activeIndex, 0, sizeof(_activeIndex));
     memset(_profileCount, 0, sizeof(_profileCount));
 }
 
 bool ProfileManager::begin() {
-    // Try to read profiles from NVS. If nothing stored, load defaults.
-    _prefs.begin(PROFILE_NS, true);
-    bool hasData = _prefs.getBool("init", false);
-    _prefs.end();
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    _open = _prefs.begin(PROFILE_NS, false);
+    if (!_open) {
+        Serial.println("[Profiles] ERROR: NVS begin failed, using defaults");
+        for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) loadChannelDefaults(ch);
+        return false;
+    }
 
-    if (!hasData) {
+    // Try to read profiles from NVS. If nothing stored, load defaults.
+    if (!_prefs.getBool("init", false)) {
         Serial.println("[Profiles] No stored profiles found, loading defaults");
         loadDefaults();
-    } else {
-        for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
-            loadChannelFromNVS(ch);
+        return true;
+    }
+
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (loadChannelFromNVS(ch)) continue;
+
+        if (loadLegacyChannel(ch)) {
+            // Write the blob before dropping the old keys, so a reset
+            // in between just converts again
+            Serial.printf("[Profiles] Converting ch%u profiles to a table blob\n", ch);
+        } else {
+            Serial.printf("[Profiles] ch%u table missing or corrupt, using defaults\n", ch);
+            loadChannelDefaults(ch);
+        }
+        if (saveChannelToNVS(ch, _profiles[ch], _profileCount[ch], _activeIndex[ch])) {
+            removeLegacyChannel(ch);
         }
-        Serial.println("[Profiles] Loaded profiles from NVS");
     }
+    Serial.println("[Profiles] Loaded profiles from NVS");
 
     return true;
 }
 
-// --- Key builders ---
-
-String ProfileManager::profileKey(uint8_t ch, uint8_t idx, const char* field) {
-    char buf[24];
-    snprintf(buf, sizeof(buf), "c%up%u_%s", ch, idx, field);
-    return String(buf);
-}
-
-String ProfileManager::channelMetaKey(uint8_t ch, const char* field) {
-    char buf[16];
-    snprintf(buf, sizeof(buf), "c%u_%s", ch, field);
-    return String(buf);
-}
-
 // --- Default profiles ---
 
 void ProfileManager::getDefaultProfile(uint8_t idx, Profile& out) {
@@ -79,134 +83,201 @@ void ProfileManager::getDefaultProfile(uint8_t idx, Profile& out) {
     }
 }
 
+void ProfileManager::loadChannelDefaults(uint8_t ch) {
+    _profileCount[ch] = NUM_DEFAULT_PROFILES;
+    _activeIndex[ch] = 2;  // "Standard" by default
+
+    for (uint8_t i = 0; i < MAX_PROFILES_PER_CH; i++) {
+        if (i < NUM_DEFAULT_PROFILES) {
+            getDefaultProfile(i, _profiles[ch][i]);
+        } else {
+            memset(&_profiles[ch][i], 0, sizeof(Profile));
+        }
+    }
+}
+
 void ProfileManager::loadDefaults() {
     for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
-        _profileCount[ch] = NUM_DEFAULT_PROFILES;
-        _activeIndex[ch] = 2;  // "Standard" by default
-
-        for (uint8_t i = 0; i < MAX_PROFILES_PER_CH; i++) {
-            if (i < NUM_DEFAULT_PROFILES) {
-                getDefaultProfile(i, _profiles[ch][i]);
-            } else {
-                memset(&_profiles[ch][i], 0, sizeof(Profile));
-            }
-        }
+        loadChannelDefaults(ch);
     }
 
     // Persist to NVS
-    _prefs.begin(PROFILE_NS, false);
+    if (!_open) return;
     _prefs.clear();
-    _prefs.putBool("init", true);
-    _prefs.end();
-
     for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
-        _prefs.begin(PROFILE_NS, false);
-        _prefs.putUChar(channelMetaKey(ch, "cnt").c_str(), _profileCount[ch]);
-        _prefs.putUChar(channelMetaKey(ch, "act").c_str(), _activeIndex[ch]);
-        _prefs.end();
-
-        for (uint8_t i = 0; i < _profileCount[ch]; i++) {
-            saveProfileToNVS(ch, i);
-        }
+        saveChannelToNVS(ch, _profiles[ch], _profileCount[ch], _activeIndex[ch]);
     }
+    _prefs.putBool("init", true);
 
     Serial.println("[Profiles] Default profiles loaded and saved");
 }
 
+void ProfileManager::validateProfile(Profile& p) {
+    // Ensure null termination
+    p.name[PROFILE_NAME_MAX_LEN - 1] = '\0';
+    // Validate temperature
+    if (p.tempF < TEMP_MIN_F || p.tempF > TEMP_MAX_F || isnan(p.tempF)) {
+        p.tempF = TEMP_DEFAULT_F;
+    }
+    // Validate PID values
+    if (p.kp < 0.0f || p.kp > 100.0f || isnan(p.kp)) p.kp = PID_KP_DEFAULT;
+    if (p.ki < 0.0f || p.ki > 50.0f  || isnan(p.ki)) p.ki = PID_KI_DEFAULT;
+    if (p.kd < 0.0f || p.kd > 100.0f || isnan(p.kd)) p.kd = PID_KD_DEFAULT;
+}
+
 // --- NVS persistence ---
 
-void ProfileManager::saveProfileToNVS(uint8_t ch, uint8_t idx) {
-    if (ch >= NUM_CHANNELS || idx >= MAX_PROFILES_PER_CH) return;
+bool ProfileManager::saveChannelToNVS(uint8_t ch, const Profile* table, uint8_t count,
+                                      uint8_t active) {
+    if (ch >= NUM_CHANNELS || !_open) return false;
+
+    uint8_t buf[sizeof(TableHeader) + sizeof(Profile) * MAX_PROFILES_PER_CH];
+    TableHeader hdr = {};
+    hdr.version = TABLE_VERSION;
+    hdr.count = min(count, (uint8_t)MAX_PROFILES_PER_CH);
+    hdr.active = active;
+    hdr.recordSize = sizeof(Profile);
+    size_t len = sizeof(Profile) * hdr.count;
+    hdr.crc = crc32(table, len);
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), table, len);
+
+    char key[4];
+    snprintf(key, sizeof(key), "c%u", ch);
+    return _prefs.putBytes(key, buf, sizeof(hdr) + len) == sizeof(hdr) + len;
+}
 
-    const Profile& p = _profiles[ch][idx];
+void ProfileManager::markDirty(uint8_t ch) {
+    _dirty |= (1 << ch);
+    _debounce.touch(millis());
+}
 
-    _prefs.begin(PROFILE_NS, false);
-    _prefs.putString(profileKey(ch, idx, "name").c_str(), p.name);
-    _prefs.putFloat(profileKey(ch, idx, "temp").c_str(),  p.tempF);
-    _prefs.putFloat(profileKey(ch, idx, "kp").c_str(),    p.kp);
-    _prefs.putFloat(profileKey(ch, idx, "ki").c_str(),    p.ki);
-    _prefs.putFloat(profileKey(ch, idx, "kd").c_str(),    p.kd);
-    _prefs.putBool(profileKey(ch, idx, "cpid").c_str(),   p.hasCustomPID);
-    _prefs.end();
+void ProfileManager::flush() {
+    if (!_lock) return;
+    _debounce.clear();
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        // Copy one channel under the lock, write it without
+        Profile table[MAX_PROFILES_PER_CH];
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        bool dirty = _dirty & (1 << ch);
+        _dirty &= ~(1 << ch);
+        uint8_t count = _profileCount[ch];
+        uint8_t active = _activeIndex[ch];
+        if (dirty) memcpy(table, _profiles[ch], sizeof(table));
+        xSemaphoreGive(_lock);
+
+        if (!dirty) continue;
+        if (saveChannelToNVS(ch, table, count, active)) {
+            Serial.printf("[Profiles] Saved ch%u profiles\n", ch);
+        } else {
+            Serial.printf("[Profiles] ERROR: ch%u save failed, will retry\n", ch);
+            xSemaphoreTake(_lock, portMAX_DELAY);
+            markDirty(ch);
+            xSemaphoreGive(_lock);
+        }
+    }
 }
 
-void ProfileManager::loadChannelFromNVS(uint8_t ch) {
-    if (ch >= NUM_CHANNELS) return;
+bool ProfileManager::loadChannelFromNVS(uint8_t ch) {
+    if (ch >= NUM_CHANNELS) return false;
+
+    char key[4];
+    snprintf(key, sizeof(key), "c%u", ch);
+    uint8_t buf[sizeof(TableHeader) + sizeof(Profile) * MAX_PROFILES_PER_CH];
+    size_t stored = _prefs.getBytesLength(key);
+    if (stored < sizeof(TableHeader) || stored > sizeof(buf)) return false;
+    if (_prefs.getBytes(key, buf, stored) != stored) return false;
+
+    TableHeader hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    size_t len = stored - sizeof(hdr);
+    if (hdr.version != TABLE_VERSION || hdr.recordSize != sizeof(Profile) ||
+        hdr.count == 0 || hdr.count > MAX_PROFILES_PER_CH ||
+        len != sizeof(Profile) * hdr.count || hdr.crc != crc32(buf + sizeof(hdr), len)) {
+        return false;
+    }
+
+    memset(_profiles[ch], 0, sizeof(_profiles[ch]));
+    memcpy(_profiles[ch], buf + sizeof(hdr), len);
+    _profileCount[ch] = hdr.count;
+    _activeIndex[ch] = (hdr.active < hdr.count) ? hdr.active : 0;
+    for (uint8_t i = 0; i < hdr.count; i++) validateProfile(_profiles[ch][i]);
+    return true;
+}
+
+// --- Legacy per-key layout ---
+
+bool ProfileManager::loadLegacyChannel(uint8_t ch) {
+    char key[16];
+    snprintf(key, sizeof(key), "c%u_cnt", ch);
+    if (!_prefs.isKey(key)) return false;
 
-    _prefs.begin(PROFILE_NS, true);
-    _profileCount[ch] = _prefs.getUChar(channelMetaKey(ch, "cnt").c_str(), NUM_DEFAULT_PROFILES);
-    _activeIndex[ch]  = _prefs.getUChar(channelMetaKey(ch, "act").c_str(), 2);
-    _prefs.end();
+    _profileCount[ch] = _prefs.getUChar(key, NUM_DEFAULT_PROFILES);
+    snprintf(key, sizeof(key), "c%u_act", ch);
+    _activeIndex[ch]  = _prefs.getUChar(key, 2);
 
     // Clamp values
     if (_profileCount[ch] > MAX_PROFILES_PER_CH) _profileCount[ch] = MAX_PROFILES_PER_CH;
     if (_activeIndex[ch] >= _profileCount[ch]) _activeIndex[ch] = 0;
 
+    memset(_profiles[ch], 0, sizeof(_profiles[ch]));
     for (uint8_t i = 0; i < _profileCount[ch]; i++) {
         Profile& p = _profiles[ch][i];
-        memset(&p, 0, sizeof(Profile));
-
-        _prefs.begin(PROFILE_NS, true);
-        String name = _prefs.getString(profileKey(ch, i, "name").c_str(), "");
-        strncpy(p.name, name.c_str(), PROFILE_NAME_MAX_LEN - 1);
-        p.name[PROFILE_NAME_MAX_LEN - 1] = '\0';
-
-        p.tempF       = _prefs.getFloat(profileKey(ch, i, "temp").c_str(), TEMP_DEFAULT_F);
-        p.kp          = _prefs.getFloat(profileKey(ch, i, "kp").c_str(),   PID_KP_DEFAULT);
-        p.ki          = _prefs.getFloat(profileKey(ch, i, "ki").c_str(),   PID_KI_DEFAULT);
-        p.kd          = _prefs.getFloat(profileKey(ch, i, "kd").c_str(),   PID_KD_DEFAULT);
-        p.hasCustomPID = _prefs.getBool(profileKey(ch, i, "cpid").c_str(), false);
-        _prefs.end();
-
-        // Validate temperature
-        if (p.tempF < TEMP_MIN_F || p.tempF > TEMP_MAX_F || isnan(p.tempF)) {
-            p.tempF = TEMP_DEFAULT_F;
-        }
-        // Validate PID values
-        if (p.kp < 0.0f || p.kp > 100.0f || isnan(p.kp)) p.kp = PID_KP_DEFAULT;
-        if (p.ki < 0.0f || p.ki > 50.0f  || isnan(p.ki)) p.ki = PID_KI_DEFAULT;
-        if (p.kd < 0.0f || p.kd > 100.0f || isnan(p.kd)) p.kd = PID_KD_DEFAULT;
+        snprintf(key, sizeof(key), "c%up%u_name", ch, i);
+        _prefs.getString(key, p.name, PROFILE_NAME_MAX_LEN);
+        snprintf(key, sizeof(key), "c%up%u_temp", ch, i);
+        p.tempF        = _prefs.getFloat(key, TEMP_DEFAULT_F);
+        snprintf(key, sizeof(key), "c%up%u_kp", ch, i);
+        p.kp           = _prefs.getFloat(key, PID_KP_DEFAULT);
+        snprintf(key, sizeof(key), "c%up%u_ki", ch, i);
+        p.ki           = _prefs.getFloat(key, PID_KI_DEFAULT);
+        snprintf(key, sizeof(key), "c%up%u_kd", ch, i);
+        p.kd           = _prefs.getFloat(key, PID_KD_DEFAULT);
+        snprintf(key, sizeof(key), "c%up%u_cpid", ch, i);
+        p.hasCustomPID = _prefs.getBool(key, false);
+        validateProfile(p);
     }
+    return true;
+}
 
-    // Clear unused profile slots
-    for (uint8_t i = _profileCount[ch]; i < MAX_PROFILES_PER_CH; i++) {
-        memset(&_profiles[ch][i], 0, sizeof(Profile));
+void ProfileManager::removeLegacyChannel(uint8_t ch) {
+    static const char* const FIELDS[] = { "name", "temp", "kp", "ki", "kd", "cpid" };
+    char key[16];
+    snprintf(key, sizeof(key), "c%u_cnt", ch);
+    if (!_prefs.isKey(key)) return;
+    _prefs.remove(key);
+    snprintf(key, sizeof(key), "c%u_act", ch);
+    _prefs.remove(key);
+    for (uint8_t i = 0; i < MAX_PROFILES_PER_CH; i++) {
+        for (const char* field : FIELDS) {
+            snprintf(key, sizeof(key), "c%up%u_%s", ch, i, field);
+            _prefs.remove(key);
+        }
     }
 }
 
 // --- Public API ---
 
 bool ProfileManager::getProfile(uint8_t ch, uint8_t idx, Profile& outProfile) {
-    if (ch >= NUM_CHANNELS || idx >= _profileCount[ch]) return false;
+    if (ch >= NUM_CHANNELS || idx >= _profileCount[ch] || !_lock) return false;
+    xSemaphoreTake(_lock, portMAX_DELAY);
     outProfile = _profiles[ch][idx];
+    xSemaphoreGive(_lock);
     return true;
 }
 
 bool ProfileManager::setProfile(uint8_t ch, uint8_t idx, const Profile& profile) {
-    if (ch >= NUM_CHANNELS || idx >= MAX_PROFILES_PER_CH) return false;
+    if (ch >= NUM_CHANNELS || idx >= MAX_PROFILES_PER_CH || !_lock) return false;
 
-    _profiles[ch][idx] = profile;
-    // Ensure null termination
-    _profiles[ch][idx].name[PROFILE_NAME_MAX_LEN - 1] = '\0';
-
-    // Validate
-    Profile& p = _profiles[ch][idx];
-    if (p.tempF < TEMP_MIN_F || p.tempF > TEMP_MAX_F || isnan(p.tempF)) {
-        p.tempF = TEMP_DEFAULT_F;
-    }
-    if (p.kp < 0.0f || p.kp > 100.0f || isnan(p.kp)) p.kp = PID_KP_DEFAULT;
-    if (p.ki < 0.0f || p.ki > 50.0f  || isnan(p.ki)) p.ki = PID_KI_DEFAULT;
-    if (p.kd < 0.0f || p.kd > 100.0f || isnan(p.kd)) p.kd = PID_KD_DEFAULT;
+    Profile p = profile;
+    validateProfile(p);
 
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _profiles[ch][idx] = p;
     // Update count if expanding
-    if (idx >= _profileCount[ch]) {
-        _profileCount[ch] = idx + 1;
-        _prefs.begin(PROFILE_NS, false);
-        _prefs.putUChar(channelMetaKey(ch, "cnt").c_str(), _profileCount[ch]);
-        _prefs.end();
-    }
-
-    saveProfileToNVS(ch, idx);
+    if (idx >= _profileCount[ch]) _profileCount[ch] = idx + 1;
+    markDirty(ch);
+    xSemaphoreGive(_lock);
 
     Serial.printf("[Profiles] Set ch%u profile %u: \"%s\" @ %.0fF\n", ch, idx, p.name, p.tempF);
     return true;
@@ -218,13 +289,12 @@ bool ProfileManager::getActiveProfile(uint8_t ch, Profile& outProfile) {
 }
 
 bool ProfileManager::setActiveProfile(uint8_t ch, uint8_t idx) {
-    if (ch >= NUM_CHANNELS || idx >= _profileCount[ch]) return false;
+    if (ch >= NUM_CHANNELS || idx >= _profileCount[ch] || !_lock) return false;
 
+    xSemaphoreTake(_lock, portMAX_DELAY);
     _activeIndex[ch] = idx;
-
-    _prefs.begin(PROFILE_NS, false);
-    _prefs.putUChar(channelMetaKey(ch, "act").c_str(), idx);
-    _prefs.end();
+    markDirty(ch);
+    xSemaphoreGive(_lock);
 
     Serial.printf("[Profiles] Ch%u active profile set to %u\n", ch, idx);
     return true;
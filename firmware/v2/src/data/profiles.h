@@ -4,10 +4,21 @@
 // ESP-Nail v2 - Temperature Profile Manager
 // Stores named temperature + PID profiles per channel in NVS
 // ============================================================
+//
+// Each channel's table is one NVS blob "c0".."c3": a TableHeader
+// (count, active index, CRC-32) followed by the `count` used Profile
+// records. begin() reads it with a single getBytes per channel; saving
+// a channel is a single putBytes.
+//
+// Changes go to the in-memory table and mark the channel dirty; the
+// persist task writes dirty channels with flush() once flushDue().
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "config.h"
+#include "write_debounce.h"
 
 // --- Profile Data ---
 struct Profile {
@@ -50,25 +61,51 @@ public:
     /// Load factory default profiles into all channels
     void loadDefaults();
 
+    /// Deferred writes: due once the changes have settled
+    bool flushDue(uint32_t nowMs) const { return _debounce.due(nowMs); }
+    bool hasPending() const             { return _debounce.pending(); }
+    void flush();                       // Write all dirty channels now
+
 private:
     // In-memory profile cache per channel
     Profile _profiles[NUM_CHANNELS][MAX_PROFILES_PER_CH];
     uint8_t _activeIndex[NUM_CHANNELS];
     uint8_t _profileCount[NUM_CHANNELS];
+    uint8_t _dirty;             // Channel bitmask, guarded by _lock
+
+    struct TableHeader {
+        uint8_t version;
+        uint8_t count;          // Profile records that follow
+        uint8_t active;
+        uint8_t recordSize;     // sizeof(Profile) when written
+        uint32_t crc;           // CRC-32 of the records
+    };
+
+    static const uint8_t TABLE_VERSION = 1;
+
+    Preferences _prefs;         // Kept open from begin() on
+    bool _open;
+    SemaphoreHandle_t _lock;    // Guards the table against flush()
+    WriteDebounce _debounce;
+
+    /// Mark a channel for the next flush (call with _lock held)
+    void markDirty(uint8_t ch);
 
-    Preferences _prefs;
+    /// Write one channel's count, active index and profiles as one blob
+    bool saveChannelToNVS(uint8_t ch, const Profile* table, uint8_t count, uint8_t active);
 
-    /// Build NVS key for a channel profile entry
-    String profileKey(uint8_t ch, uint8_t idx, const char* field);
+    /// Read one channel's blob into the table. False if missing or corrupt.
+    bool loadChannelFromNVS(uint8_t ch);
 
-    /// Build NVS key for channel metadata
-    String channelMetaKey(uint8_t ch, const char* field);
+    /// Per-key layout of older firmware: read, and delete once converted
+    bool loadLegacyChannel(uint8_t ch);
+    void removeLegacyChannel(uint8_t ch);
 
-    /// Save a single profile to NVS
-    void saveProfileToNVS(uint8_t ch, uint8_t idx);
+    /// Default table for one channel
+    void loadChannelDefaults(uint8_t ch);
 
-    /// Load all profiles for a channel from NVS
-    void loadChannelFromNVS(uint8_t ch);
+    /// Clamp a profile's values to sane ranges
+    static void validateProfile(Profile& p);
 
     /// Populate a Profile with the default at given index (0..3)
     void getDefaultProfile(uint8_t idx, Profile& out);
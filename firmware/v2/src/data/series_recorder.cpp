@@ -0,0 +1,496 @@
+#include "series_recorder.h"
+#if ENABLE_SERIES_LOG
+#include "crc32.h"
+#include "varint.h"
+
+// ============================================================
+// ESP-Nail v2 - Per-session time-series recorder
+// ============================================================
+
+const char* SeriesRecorder::INDEX_PATH = "/ts/index.dat";
+
+struct BlockHeader {
+    uint16_t bytes;
+    uint16_t samples;
+    uint32_t firstSample;
+};
+static_assert(sizeof(BlockHeader) == 8, "BlockHeader layout");
+
+SeriesRecorder::SeriesRecorder()
+    : _nextId(1), _dropped(0), _boot(0), _count(0), _totalBytes(0),
+      _indexDirty(false), _indexUrgent(false), _lock(nullptr) {
+    for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+        Recorder& r = _rec[i];
+        r.recording = false;
+        r.fill = -1;
+        r.activeId.store(0, std::memory_order_relaxed);
+        for (uint8_t b = 0; b < 2; b++) {
+            r.blocks[b].state.store(BLOCK_FREE, std::memory_order_relaxed);
+        }
+    }
+}
+
+void SeriesRecorder::begin() {
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    // LittleFS is mounted by SessionLogger::begin()
+    if (!LittleFS.exists("/ts")) LittleFS.mkdir("/ts");
+    loadIndex();
+    _boot++;
+    _indexDirty = _indexUrgent = true;
+    Serial.printf("[SERIES] %u sessions, %lu bytes\n", _count, (unsigned long)_totalBytes);
+}
+
+// ---------------------------------------------------------------------------
+// PID task: decimate, quantise and delta-encode into RAM blocks
+// ---------------------------------------------------------------------------
+
+void SeriesRecorder::startSession(uint8_t ch) {
+    if (ch >= NUM_CHANNELS) return;
+    Recorder& r = _rec[ch];
+    if (r.recording) endSession(ch);
+
+    r.recording = true;
+    r.sessionId = _nextId.fetch_add(1, std::memory_order_relaxed);
+    r.startTime = millis() / 1000;
+    r.samples = 0;
+    r.ticks = 0;
+    r.sum[0] = r.sum[1] = r.sum[2] = 0.0f;
+    r.fill = -1;
+    r.activeId.store(r.sessionId, std::memory_order_release);
+}
+
+void SeriesRecorder::endSession(uint8_t ch) {
+    if (ch >= NUM_CHANNELS || !_rec[ch].recording) return;
+    Recorder& r = _rec[ch];
+    publishBlock(r);                // Partial decimation window is dropped
+    r.recording = false;
+    r.activeId.store(0, std::memory_order_release);
+}
+
+void SeriesRecorder::addSample(uint8_t ch, float tempF, float setpointF, float output) {
+    if (ch >= NUM_CHANNELS || !_rec[ch].recording) return;
+    Recorder& r = _rec[ch];
+
+#if SERIES_DECIMATE_MEAN
+    r.sum[0] += tempF;
+    r.sum[1] += setpointF;
+    r.sum[2] += output;
+#else
+    r.sum[0] = tempF;
+    r.sum[1] = setpointF;
+    r.sum[2] = output;
+#endif
+    if (++r.ticks < SERIES_DECIMATION) return;
+
+#if SERIES_DECIMATE_MEAN
+    float div = 10.0f / r.ticks;    // Mean, in 0.1 units
+#else
+    float div = 10.0f;
+#endif
+    int32_t q[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        q[i] = (int32_t)lroundf(r.sum[i] * div);
+        r.sum[i] = 0.0f;
+    }
+    r.ticks = 0;
+    encode(r, q);
+}
+
+void SeriesRecorder::encode(Recorder& r, const int32_t q[3]) {
+    uint8_t tmp[3 * VARINT_MAX_BYTES];
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        if (r.fill < 0 && !openBlock(r)) break;
+
+        Block& b = r.blocks[r.fill];
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < 3; i++) n += putVarint(tmp + n, q[i] - r.prev[i]);
+
+        if (b.len + n <= SERIES_BLOCK_BYTES) {
+            memcpy(b.data + b.len, tmp, n);
+            b.len += n;
+            b.samples++;
+            r.prev[0] = q[0]; r.prev[1] = q[1]; r.prev[2] = q[2];
+            r.samples++;
+            return;
+        }
+        publishBlock(r);            // Full: hand over, retry in a fresh block
+    }
+
+    // Both blocks still waiting for the logger task
+    r.samples++;
+    _dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool SeriesRecorder::openBlock(Recorder& r) {
+    for (uint8_t i = 0; i < 2; i++) {
+        Block& b = r.blocks[i];
+        if (b.state.load(std::memory_order_acquire) != BLOCK_FREE) continue;
+        b.state.store(BLOCK_FILLING, std::memory_order_relaxed);
+        b.sessionId = r.sessionId;
+        b.startTime = r.startTime;
+        b.firstSample = r.samples;
+        b.samples = 0;
+        b.len = 0;
+        r.prev[0] = r.prev[1] = r.prev[2] = 0;     // Block keyframe
+        r.fill = i;
+        return true;
+    }
+    return false;
+}
+
+void SeriesRecorder::publishBlock(Recorder& r) {
+    if (r.fill < 0) return;
+    Block& b = r.blocks[r.fill];
+    b.state.store(b.samples ? BLOCK_FULL : BLOCK_FREE, std::memory_order_release);
+    r.fill = -1;
+}
+
+// ---------------------------------------------------------------------------
+// Logger task: flash writes and index upkeep
+// ---------------------------------------------------------------------------
+
+void SeriesRecorder::update() {
+    if (!_lock) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    bool anyActive = false;
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        Recorder& r = _rec[ch];
+        if (r.activeId.load(std::memory_order_acquire)) anyActive = true;
+
+        // Oldest block first when both are waiting
+        Block* b0 = &r.blocks[0];
+        Block* b1 = &r.blocks[1];
+        if (b1->state.load(std::memory_order_acquire) == BLOCK_FULL &&
+            b0->state.load(std::memory_order_acquire) == BLOCK_FULL &&
+            (b1->sessionId < b0->sessionId ||
+             (b1->sessionId == b0->sessionId && b1->firstSample < b0->firstSample))) {
+            Block* t = b0; b0 = b1; b1 = t;
+        }
+        Block* order[2] = { b0, b1 };
+        for (uint8_t i = 0; i < 2; i++) {
+            if (order[i]->state.load(std::memory_order_acquire) != BLOCK_FULL) continue;
+            writeBlock(ch, *order[i]);
+            order[i]->state.store(BLOCK_FREE, std::memory_order_release);
+        }
+    }
+
+    // New sessions and segments go to flash at once; sample counts of
+    // running sessions wait until everything is idle
+    if (_indexUrgent || (_indexDirty && !anyActive)) saveIndex();
+
+    xSemaphoreGive(_lock);
+}
+
+void SeriesRecorder::writeBlock(uint8_t ch, Block& b) {
+    uint32_t need = BLOCK_HEADER + b.len;
+    while (_totalBytes + need > SERIES_MAX_BYTES) {
+        if (!evictOldest(b.sessionId)) {
+            _dropped.fetch_add(b.samples, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    SeriesSession* s = findSession(b.sessionId);
+    if (!s) s = createSession(ch, b);
+    if (!s) {
+        _dropped.fetch_add(b.samples, std::memory_order_relaxed);
+        return;
+    }
+
+    // A new segment only counts once its first block is on flash
+    bool newSeg = (s->segments == 0 || s->segBytes + need > SERIES_SEGMENT_BYTES);
+    char path[24];
+    segmentPath(path, sizeof(path), s->id, newSeg ? s->segments : s->segments - 1);
+    File f = LittleFS.open(path, "a");
+    if (!f) {
+        _dropped.fetch_add(b.samples, std::memory_order_relaxed);
+        return;
+    }
+    BlockHeader h = { b.len, b.samples, b.firstSample };
+    size_t wrote = f.write((const uint8_t*)&h, sizeof(h));
+    if (wrote == sizeof(h)) wrote += f.write(b.data, b.len);
+    f.close();
+
+    if (wrote != need) {
+        // Readers stop at a torn block, so nothing may follow it
+        if (newSeg) {
+            LittleFS.remove(path);
+        } else {
+            s->segBytes = SERIES_SEGMENT_BYTES;
+            s->bytes += wrote;
+            _totalBytes += wrote;
+            _indexDirty = true;
+        }
+        _dropped.fetch_add(b.samples, std::memory_order_relaxed);
+        return;
+    }
+
+    if (newSeg) {
+        s->segments++;
+        s->segBytes = 0;
+        _indexUrgent = true;
+    }
+    s->segBytes += need;
+    s->bytes += need;
+    s->samples = max(s->samples, b.firstSample + b.samples);
+    _totalBytes += need;
+    _indexDirty = true;
+}
+
+SeriesSession* SeriesRecorder::findSession(uint32_t id) {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_sessions[i].id == id) return &_sessions[i];
+    }
+    return nullptr;
+}
+
+SeriesSession* SeriesRecorder::createSession(uint8_t ch, const Block& b) {
+    if (_count >= SERIES_MAX_SESSIONS && !evictOldest(b.sessionId)) return nullptr;
+
+    SeriesSession& s = _sessions[_count++];
+    s = {};
+    s.id = b.sessionId;
+    s.startTime = b.startTime;
+    s.periodMs = PID_SAMPLE_MS * SERIES_DECIMATION;
+    s.channel = ch;
+    s.boot = (uint8_t)_boot;
+    _indexDirty = _indexUrgent = true;
+    return &s;
+}
+
+// Delete the oldest session that is not being recorded or written
+bool SeriesRecorder::evictOldest(uint32_t keepId) {
+    for (uint8_t i = 0; i < _count; i++) {
+        SeriesSession& s = _sessions[i];
+        bool active = (s.id == keepId);
+        for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+            if (_rec[ch].activeId.load(std::memory_order_acquire) == s.id) active = true;
+        }
+        if (active) continue;
+
+        removeSession(i);
+        return true;
+    }
+    return false;
+}
+
+void SeriesRecorder::removeSession(uint8_t i) {
+    SeriesSession& s = _sessions[i];
+    char path[24];
+    for (uint16_t seg = 0; seg < s.segments; seg++) {
+        segmentPath(path, sizeof(path), s.id, seg);
+        LittleFS.remove(path);
+    }
+    _totalBytes -= min(_totalBytes, s.bytes);
+    memmove(&_sessions[i], &_sessions[i + 1], (_count - i - 1) * sizeof(SeriesSession));
+    _count--;
+    _indexDirty = _indexUrgent = true;
+}
+
+void SeriesRecorder::loadIndex() {
+    _count = 0;
+    _totalBytes = 0;
+
+    File f = LittleFS.open(INDEX_PATH, "r");
+    bool ok = false;
+    if (f) {
+        IndexHeader h;
+        if (f.read((uint8_t*)&h, sizeof(h)) == sizeof(h) &&
+            h.magic == INDEX_MAGIC && h.version == INDEX_VERSION &&
+            h.count <= SERIES_MAX_SESSIONS &&
+            f.read((uint8_t*)_sessions, h.count * sizeof(SeriesSession)) == h.count * sizeof(SeriesSession)) {
+            uint32_t crc = crc32(&h, offsetof(IndexHeader, crc));
+            crc = crc32(_sessions, h.count * sizeof(SeriesSession), crc);
+            if (crc == h.crc) {
+                ok = true;
+                _count = h.count;
+                _boot = h.boot;
+                _nextId.store(max(h.nextId, (uint32_t)1), std::memory_order_relaxed);
+            }
+        }
+        f.close();
+    }
+
+    if (!ok) {
+        // Segments without an index can't be found or aged out; start over
+        File dir = LittleFS.open("/ts");
+        char path[40];
+        for (File e = dir.openNextFile(); e; e = dir.openNextFile()) {
+            snprintf(path, sizeof(path), "/ts/%s", e.name());
+            e.close();
+            LittleFS.remove(path);
+        }
+        return;
+    }
+
+    for (uint8_t i = 0; i < _count; i++) {
+        _totalBytes += _sessions[i].bytes;
+        if (_sessions[i].id >= _nextId.load(std::memory_order_relaxed)) {
+            _nextId.store(_sessions[i].id + 1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void SeriesRecorder::saveIndex() {
+    IndexHeader h;
+    h.magic = INDEX_MAGIC;
+    h.version = INDEX_VERSION;
+    h.count = _count;
+    h.nextId = _nextId.load(std::memory_order_relaxed);
+    h.boot = _boot;
+    h.reserved = 0;
+    h.crc = crc32(&h, offsetof(IndexHeader, crc));
+    h.crc = crc32(_sessions, _count * sizeof(SeriesSession), h.crc);
+
+    File f = LittleFS.open(INDEX_PATH, "w");
+    if (!f) return;
+    f.write((const uint8_t*)&h, sizeof(h));
+    f.write((const uint8_t*)_sessions, _count * sizeof(SeriesSession));
+    f.close();
+    _indexDirty = _indexUrgent = false;
+}
+
+// ---------------------------------------------------------------------------
+// Queries
+// ---------------------------------------------------------------------------
+
+uint8_t SeriesRecorder::getSessions(SeriesSession* out, uint8_t maxCount) {
+    if (!_lock) return 0;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    uint8_t n = min(maxCount, _count);
+    memcpy(out, _sessions, n * sizeof(SeriesSession));
+    xSemaphoreGive(_lock);
+    return n;
+}
+
+bool SeriesRecorder::getSession(uint32_t id, SeriesSession& out) {
+    if (!_lock) return false;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    SeriesSession* s = findSession(id);
+    if (s) out = *s;
+    xSemaphoreGive(_lock);
+    return s != nullptr;
+}
+
+uint8_t SeriesRecorder::findSessions(uint8_t ch, uint32_t fromS, uint32_t toS,
+                                     uint32_t* ids, uint8_t maxCount) {
+    if (!_lock) return 0;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < _count && n < maxCount; i++) {
+        const SeriesSession& s = _sessions[i];
+        if (s.channel != ch || s.boot != (uint8_t)_boot) continue;
+        uint32_t endS = s.startTime + (uint32_t)((uint64_t)s.samples * s.periodMs / 1000);
+        bool live = false;
+        for (uint8_t c = 0; c < NUM_CHANNELS; c++) {
+            if (_rec[c].activeId.load(std::memory_order_acquire) == s.id) live = true;
+        }
+        if (s.startTime <= toS && (live || endS >= fromS)) ids[n++] = s.id;
+    }
+    xSemaphoreGive(_lock);
+    return n;
+}
+
+void SeriesRecorder::segmentPath(char* buf, size_t len, uint32_t id, uint16_t seg) {
+    snprintf(buf, len, "/ts/%lu_%u", (unsigned long)id, seg);
+}
+
+// ---------------------------------------------------------------------------
+// SeriesReader
+// ---------------------------------------------------------------------------
+
+SeriesReader::SeriesReader()
+    : _session(), _seg(0), _left(0), _index(0), _len(0), _pos(0) {}
+
+SeriesReader::~SeriesReader() {
+    close();
+}
+
+bool SeriesReader::open(SeriesRecorder& rec, uint32_t id) {
+    close();
+    if (!rec.getSession(id, _session)) return false;
+    _seg = 0;
+    _left = 0;
+    return true;
+}
+
+void SeriesReader::close() {
+    if (_file) _file.close();
+}
+
+bool SeriesReader::next(SeriesSample& s) {
+    for (;;) {
+        while (_left == 0) {
+            if (!nextBlock()) return false;
+        }
+
+        int32_t d[3];
+        if (!getVarint(_buf, _len, _pos, d[0]) || !getVarint(_buf, _len, _pos, d[1]) ||
+            !getVarint(_buf, _len, _pos, d[2])) {
+            _left = 0;              // Truncated block: skip the rest
+            continue;
+        }
+        for (uint8_t i = 0; i < 3; i++) _prev[i] += d[i];
+        s.index = _index++;
+        s.tempF = _prev[0] * 0.1f;
+        s.setpointF = _prev[1] * 0.1f;
+        s.output = _prev[2] * 0.1f;
+        _left--;
+        return true;
+    }
+}
+
+void SeriesReader::skipTo(uint32_t index) {
+    // Drop what is left of the current block if it ends before `index`
+    if (_left && _index + _left <= index) _left = 0;
+    if (_left) return;
+
+    for (;;) {
+        if (!_file) {
+            if (_seg >= _session.segments) return;
+            char path[24];
+            SeriesRecorder::segmentPath(path, sizeof(path), _session.id, _seg++);
+            _file = LittleFS.open(path, "r");
+            if (!_file) continue;
+        }
+
+        size_t at = _file.position();
+        BlockHeader h;
+        if (_file.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || h.bytes > SERIES_BLOCK_BYTES) {
+            _file.close();
+            continue;
+        }
+        if (h.firstSample + h.samples > index) {
+            _file.seek(at);         // Leave it for nextBlock()
+            return;
+        }
+        _file.seek(at + sizeof(h) + h.bytes);
+    }
+}
+
+bool SeriesReader::nextBlock() {
+    for (;;) {
+        if (!_file) {
+            if (_seg >= _session.segments) return false;
+            char path[24];
+            SeriesRecorder::segmentPath(path, sizeof(path), _session.id, _seg++);
+            _file = LittleFS.open(path, "r");
+            if (!_file) continue;
+        }
+
+        BlockHeader h;
+        if (_file.read((uint8_t*)&h, sizeof(h)) != sizeof(h) || h.bytes > SERIES_BLOCK_BYTES ||
+            _file.read(_buf, h.bytes) != h.bytes) {
+            _file.close();          // End of segment
+            continue;
+        }
+        _len = h.bytes;
+        _pos = 0;
+        _left = h.samples;
+        _index = h.firstSample;
+        _prev[0] = _prev[1] = _prev[2] = 0;
+        return true;
+    }
+}
+#endif
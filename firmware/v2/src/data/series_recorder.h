@@ -0,0 +1,178 @@
+#pragma once
+#include "config.h"
+#if ENABLE_SERIES_LOG
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// ============================================================
+// ESP-Nail v2 - Per-session time-series recorder
+// ============================================================
+//
+// Records temperature, setpoint and output for every active session,
+// decimated to one sample per SERIES_DECIMATION PID ticks.
+//
+// Samples are quantised to 0.1 units and stored as zigzag varint
+// deltas from the previous sample, typically 3 bytes per sample. They
+// are grouped into blocks of at most SERIES_BLOCK_BYTES. Each block
+// starts from zero, so its first sample is effectively a keyframe and
+// every block decodes on its own:
+//
+//   [uint16 bytes][uint16 samples][uint32 firstSample][varints...]
+//
+// Sample n of a session is at startTime + n * periodMs. A gap in
+// firstSample means blocks were dropped.
+//
+// Blocks are appended to segment files /ts/<id>_<seg> of up to
+// SERIES_SEGMENT_BYTES. A small index (/ts/index.dat, CRC-checked)
+// lists the sessions. When the flash budget SERIES_MAX_BYTES is
+// exceeded (or SERIES_MAX_SESSIONS reached), the oldest finished
+// session is deleted, whichever boot recorded it. Times are uptime, so
+// time-range lookups only cover the current boot; sessions of earlier
+// boots are still listed and readable by id.
+//
+// The PID task only encodes into one of two RAM blocks per channel.
+// Full blocks are written out by update() on the logger task, so flash
+// latency never reaches the control loop.
+
+struct SeriesSession {
+    uint32_t id;
+    uint32_t startTime;         // s, same clock as SessionRecord::startTime
+    uint32_t samples;           // Stored samples, including dropped blocks
+    uint32_t bytes;             // Flash used by all segments
+    uint16_t periodMs;          // Time between stored samples
+    uint16_t segments;
+    uint16_t segBytes;          // Fill of the last segment
+    uint8_t channel;
+    uint8_t boot;               // Low bits of the boot count; startTime is per boot
+};
+
+struct SeriesSample {
+    uint32_t index;             // Sample number within the session
+    float tempF;
+    float setpointF;
+    float output;               // %
+};
+
+class SeriesRecorder {
+public:
+    SeriesRecorder();
+    void begin();
+
+    // --- PID task ---
+    void startSession(uint8_t ch);
+    void endSession(uint8_t ch);
+    void addSample(uint8_t ch, float tempF, float setpointF, float output);
+
+    // --- Logger task ---
+    void update();              // Write full blocks, maintain the index
+
+    // --- Any task ---
+    uint8_t getSessions(SeriesSession* out, uint8_t maxCount);   // Oldest first
+    bool getSession(uint32_t id, SeriesSession& out);
+    uint8_t currentBoot() const { return (uint8_t)_boot; }
+
+    // Ids of this boot's sessions on `ch` overlapping [fromS, toS], oldest first
+    uint8_t findSessions(uint8_t ch, uint32_t fromS, uint32_t toS, uint32_t* ids, uint8_t maxCount);
+    // Samples lost because both RAM blocks of a channel were waiting on
+    // flash, or a block could not be written
+    uint32_t getDroppedSamples() const { return _dropped.load(std::memory_order_relaxed); }
+
+    static void segmentPath(char* buf, size_t len, uint32_t id, uint16_t seg);
+
+private:
+    enum : uint8_t { BLOCK_FREE, BLOCK_FILLING, BLOCK_FULL };
+
+    struct Block {
+        std::atomic<uint8_t> state;
+        uint32_t sessionId;
+        uint32_t startTime;
+        uint32_t firstSample;
+        uint16_t samples;
+        uint16_t len;
+        uint8_t data[SERIES_BLOCK_BYTES];
+    };
+
+    struct Recorder {
+        bool recording;
+        uint32_t sessionId;
+        uint32_t startTime;
+        uint32_t samples;
+        uint8_t ticks;
+        float sum[3];
+        int32_t prev[3];
+        int8_t fill;            // Block being filled, -1 for none
+        std::atomic<uint32_t> activeId;     // 0 when idle; read by update()
+        Block blocks[2];
+    };
+
+    struct IndexHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t count;
+        uint32_t nextId;
+        uint16_t boot;          // Incremented on every begin()
+        uint16_t reserved;
+        uint32_t crc;           // CRC-32 of the fields above and the entries
+    };
+
+    static const uint32_t INDEX_MAGIC = 0x53545345;    // "ESTS"
+    static const uint16_t INDEX_VERSION = 2;
+    static const uint8_t BLOCK_HEADER = 8;
+    static const char* INDEX_PATH;
+
+    Recorder _rec[NUM_CHANNELS];
+    std::atomic<uint32_t> _nextId;
+    std::atomic<uint32_t> _dropped;
+    uint16_t _boot;
+
+    // Index, guarded by _lock (never taken by the PID task)
+    SeriesSession _sessions[SERIES_MAX_SESSIONS];
+    uint8_t _count;
+    uint32_t _totalBytes;
+    bool _indexDirty;           // RAM index differs from flash
+    bool _indexUrgent;          // ...and a new session or segment must be recorded
+    SemaphoreHandle_t _lock;
+
+    void encode(Recorder& r, const int32_t q[3]);
+    bool openBlock(Recorder& r);
+    void publishBlock(Recorder& r);
+
+    void writeBlock(uint8_t ch, Block& b);
+    SeriesSession* findSession(uint32_t id);
+    SeriesSession* createSession(uint8_t ch, const Block& b);
+    bool evictOldest(uint32_t keepId);
+    void removeSession(uint8_t i);
+    void loadIndex();
+    void saveIndex();
+};
+
+// Sequential decoder for one recorded session
+class SeriesReader {
+public:
+    SeriesReader();
+    ~SeriesReader();
+
+    bool open(SeriesRecorder& rec, uint32_t id);
+    bool next(SeriesSample& s);     // False at the end
+    void skipTo(uint32_t index);    // Skip whole blocks before `index` undecoded
+    void close();
+
+    const SeriesSession& session() const { return _session; }
+
+private:
+    SeriesSession _session;
+    File _file;
+    uint16_t _seg;
+    uint16_t _left;             // Samples left in the current block
+    uint32_t _index;
+    int32_t _prev[3];
+    uint8_t _buf[SERIES_BLOCK_BYTES];
+    uint16_t _len;
+    uint16_t _pos;
+
+    bool nextBlock();
+};
+#endif
@@ -1,22 +1,90 @@
 #include "session_log.h"
+#include "crc32.h"
 
 const char* SessionLogger::LOG_PATH = "/sessions.dat";
+const char* SessionLogger::TMP_PATH = "/sessions.tmp";
+const char* SessionLogger::ENERGY_PATH = "/energy.dat";
 
-SessionLogger::SessionLogger() {
-    for (int i = 0; i < NUM_CHANNELS; i++) _active[i] = {false, 0, 0, 0, 0, 0, 0};
+SessionLogger::SessionLogger()
+    : _lifetimeWh(0), _energyDirty(false), _savedWh(0), _savedMs(0),
+      _pendingHead(0), _pendingTail(0), _hdr(), _lock(nullptr) {
+    for (int i = 0; i < NUM_CHANNELS; i++) {
+        _active[i] = {false, 0, 0, 0, 0, 0, 0, 0, 0};
+        _heaterWatts[i] = HEATER_WATTS_DEFAULT;
+    }
 }
 
 void SessionLogger::begin() {
+    if (!_lock) _lock = xSemaphoreCreateMutex();
     if (!LittleFS.begin(true)) {
         Serial.println(F("[SESSION] LittleFS mount failed"));
+        return;
+    }
+    loadEnergy();
+    publishEnergy();
+
+    File f = LittleFS.open(LOG_PATH, "r");
+    if (!f) {
+        rebuild(nullptr, nullptr, 0);
+        return;
+    }
+
+    LogHeader h;
+    bool migrate = false;
+    if (readHeader(f, h)) {
+        if (h.capacity == MAX_SESSION_RECORDS && h.recordSize == sizeof(SessionRecord) &&
+            f.size() >= sizeof(LogHeader) + (size_t)h.capacity * h.recordSize) {
+            f.close();
+            _hdr = h;
+            return;
+        }
+        // Capacity changed: carry the newest records over
+        migrate = (h.recordSize == sizeof(SessionRecord));
+        if (migrate) {
+            Serial.printf("[SESSION] Resizing log %u -> %u slots\n", h.capacity, MAX_SESSION_RECORDS);
+            rebuild(&f, &h, h.count);
+        }
+    } else if (f.size() % sizeof(SessionRecord) == 0) {
+        // Pre-ring format: bare records appended oldest first
+        uint16_t n = f.size() / sizeof(SessionRecord);
+        migrate = true;
+        Serial.printf("[SESSION] Migrating %u records to ring log\n", n);
+        rebuild(&f, nullptr, n);
+    }
+    f.close();
+
+    if (migrate) {
+        LittleFS.remove(LOG_PATH);
+        LittleFS.rename(TMP_PATH, LOG_PATH);
+    } else {
+        Serial.println(F("[SESSION] Unrecognised log, starting empty"));
+        rebuild(nullptr, nullptr, 0);
     }
 }
 
-void SessionLogger::update() { /* periodic maintenance if needed */ }
+void SessionLogger::update() {
+    // Flash writes happen here on the logger task, never on taskPID
+    uint8_t tail = _pendingTail.load(std::memory_order_relaxed);
+    while (tail != _pendingHead.load(std::memory_order_acquire)) {
+        appendRecord(_pending[tail % PENDING_RECORDS]);
+        _pendingTail.store(++tail, std::memory_order_release);
+    }
+
+    // Completed plus running: a session that never ends cleanly still
+    // counts up to its last checkpoint. Only ever grows.
+    bool ended = _energyDirty.exchange(false);
+    double wh = _energy.read().lifetimeWh;
+    uint32_t now = millis();
+    if (ended || (wh > _savedWh && now - _savedMs >= ENERGY_SAVE_INTERVAL_MS)) {
+        saveEnergy(wh);
+        _savedWh = wh;
+        _savedMs = now;
+    }
+}
 
 void SessionLogger::startSession(uint8_t ch, float targetTemp) {
     if (ch >= NUM_CHANNELS) return;
-    _active[ch] = {true, millis(), 0, 0, 0, 0, targetTemp};
+    _active[ch] = {true, millis(), 0, 0, 0, targetTemp, 0, 0, 0};
 }
 
 void SessionLogger::endSession(uint8_t ch) {
@@ -29,84 +97,254 @@ void SessionLogger::endSession(uint8_t ch) {
     rec.avgTempF = s.sampleCount > 0 ? s.tempSum / s.sampleCount : 0;
     rec.targetTempF = s.targetTemp;
     rec.channel = ch;
-    rec.energyEstWh = s.energySum / 3600.0f;
-    appendRecord(rec);
+    rec.energyEstWh = (float)(s.energyWs / 3600.0);
+    _lifetimeWh += s.energyWs / 3600.0;
     s.active = false;
+    publishEnergy();
+    _energyDirty.store(true);
+
+    // Hand the record to the logger task; if it has fallen PENDING_RECORDS
+    // sessions behind, this one is dropped rather than blocking the tick
+    uint8_t head = _pendingHead.load(std::memory_order_relaxed);
+    if ((uint8_t)(head - _pendingTail.load(std::memory_order_acquire)) < PENDING_RECORDS) {
+        _pending[head % PENDING_RECORDS] = rec;
+        _pendingHead.store(head + 1, std::memory_order_release);
+    }
 }
 
-void SessionLogger::addDataPoint(uint8_t ch, float temp, float pidOutput) {
+void SessionLogger::addDataPoint(uint8_t ch, float temp, float duty, uint32_t nowMs) {
     if (ch >= NUM_CHANNELS || !_active[ch].active) return;
     ActiveSession& s = _active[ch];
     s.sampleCount++;
     s.tempSum += temp;
     if (temp > s.peakTemp) s.peakTemp = temp;
-    // Estimate energy: assume 100W max per channel, scale by PID output
-    float watts = (pidOutput / 100.0f) * 100.0f;
-    float intervalSec = SESSION_SAMPLE_INTERVAL_S;
-    s.energySum += watts * intervalSec;  // Watt-seconds
+
+    // Trapezoid between this tick and the last one; the duty was
+    // latched at period boundaries, so averaging both ends tracks it
+    float watts = _heaterWatts[ch] * constrain(duty, 0.0f, 1.0f);
+    if (s.lastMs != 0) {
+        uint32_t dtMs = nowMs - s.lastMs;
+        s.energyWs += 0.5 * (s.lastWatts + watts) * dtMs / 1000.0;
+    }
+    s.lastWatts = watts;
+    s.lastMs = nowMs ? nowMs : 1;
+    publishEnergy();
 }
 
-void SessionLogger::appendRecord(const SessionRecord& rec) {
-    File f = LittleFS.open(LOG_PATH, "a");
+void SessionLogger::setHeaterWatts(uint8_t ch, uint16_t watts) {
+    if (ch >= NUM_CHANNELS || watts == 0 || watts > HEATER_WATTS_MAX) return;
+    _heaterWatts[ch] = watts;
+}
+
+void SessionLogger::publishEnergy() {
+    EnergyView v;
+    v.lifetimeWh = _lifetimeWh;
+    for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+        double wh = _active[i].active ? _active[i].energyWs / 3600.0 : 0.0;
+        v.sessionWh[i] = (float)wh;
+        v.lifetimeWh += wh;
+    }
+    _energy.publish(v);
+}
+
+float SessionLogger::getSessionWh(uint8_t ch) const {
+    if (ch >= NUM_CHANNELS) return 0.0f;
+    return _energy.read().sessionWh[ch];
+}
+
+double SessionLogger::getLifetimeKWh() const {
+    return _energy.read().lifetimeWh / 1000.0;
+}
+
+void SessionLogger::loadEnergy() {
+    EnergyStore e;
+    File f = LittleFS.open(ENERGY_PATH, "r");
     if (!f) return;
-    f.write((const uint8_t*)&rec, sizeof(SessionRecord));
+    if (f.read((uint8_t*)&e, sizeof(e)) == sizeof(e) && e.magic == ENERGY_MAGIC &&
+        e.crc == crc32(&e, offsetof(EnergyStore, crc))) {
+        _lifetimeWh = _savedWh = e.lifetimeWh;
+    }
+    f.close();
+}
+
+void SessionLogger::saveEnergy(double lifetimeWh) {
+    EnergyStore e = {};
+    e.magic = ENERGY_MAGIC;
+    e.lifetimeWh = lifetimeWh;
+    e.crc = crc32(&e, offsetof(EnergyStore, crc));
+    File f = LittleFS.open(ENERGY_PATH, "w");
+    if (!f) return;
+    f.write((const uint8_t*)&e, sizeof(e));
     f.close();
-    // Trim to MAX_SESSION_RECORDS
-    if (getSessionCount() > MAX_SESSION_RECORDS) {
-        // Read all, keep last N, rewrite
-        File rf = LittleFS.open(LOG_PATH, "r");
-        if (!rf) return;
-        size_t total = rf.size() / sizeof(SessionRecord);
-        size_t skip = total - MAX_SESSION_RECORDS;
-        rf.seek(skip * sizeof(SessionRecord));
-        uint8_t* buf = new uint8_t[MAX_SESSION_RECORDS * sizeof(SessionRecord)];
-        rf.read(buf, MAX_SESSION_RECORDS * sizeof(SessionRecord));
-        rf.close();
-        File wf = LittleFS.open(LOG_PATH, "w");
-        wf.write(buf, MAX_SESSION_RECORDS * sizeof(SessionRecord));
-        wf.close();
-        delete[] buf;
+}
+
+void SessionLogger::appendRecord(const SessionRecord& rec) {
+    if (!_lock || _hdr.capacity == 0) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    File f = LittleFS.open(LOG_PATH, "r+");
+    if (f) {
+        // Record, then header; LittleFS commits both on close()
+        f.seek(sizeof(LogHeader) + (size_t)_hdr.head * _hdr.recordSize);
+        f.write((const uint8_t*)&rec, sizeof(SessionRecord));
+
+        _hdr.head = (_hdr.head + 1) % _hdr.capacity;
+        if (_hdr.count < _hdr.capacity) _hdr.count++;
+        writeHeader(f);
+        f.close();
     }
+
+    xSemaphoreGive(_lock);
 }
 
 uint16_t SessionLogger::getSessionCount() {
-    File f = LittleFS.open(LOG_PATH, "r");
-    if (!f) return 0;
-    uint16_t count = f.size() / sizeof(SessionRecord);
-    f.close();
-    return count;
+    return _hdr.count;
 }
 
 SessionRecord SessionLogger::getSession(uint16_t idx) {
     SessionRecord rec = {};
+    if (!_lock || idx >= _hdr.count) return rec;
+    xSemaphoreTake(_lock, portMAX_DELAY);
     File f = LittleFS.open(LOG_PATH, "r");
-    if (!f) return rec;
-    f.seek(idx * sizeof(SessionRecord));
-    f.read((uint8_t*)&rec, sizeof(SessionRecord));
-    f.close();
+    if (f) {
+        f.seek(slotOffset(_hdr, idx));
+        f.read((uint8_t*)&rec, sizeof(SessionRecord));
+        f.close();
+    }
+    xSemaphoreGive(_lock);
     return rec;
 }
 
-String SessionLogger::exportJSON() {
-    JsonDocument doc;
-    JsonArray arr = doc["sessions"].to<JsonArray>();
-    uint16_t count = getSessionCount();
-    for (uint16_t i = 0; i < count; i++) {
-        SessionRecord r = getSession(i);
-        JsonObject o = arr.add<JsonObject>();
-        o["start"] = r.startTime;
-        o["duration"] = r.durationSec;
-        o["channel"] = r.channel;
-        o["peakTemp"] = r.peakTempF;
-        o["avgTemp"] = r.avgTempF;
-        o["targetTemp"] = r.targetTempF;
-        o["energyWh"] = r.energyEstWh;
+void SessionLogger::clearAll() {
+    if (!_lock) return;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    // Keep the preallocated slots; an empty header is enough
+    _hdr.head = 0;
+    _hdr.count = 0;
+    File f = LittleFS.open(LOG_PATH, "r+");
+    if (f) {
+        writeHeader(f);
+        f.close();
     }
-    String out;
-    serializeJson(doc, out);
-    return out;
+    xSemaphoreGive(_lock);
 }
 
-void SessionLogger::clearAll() {
-    LittleFS.remove(LOG_PATH);
+// ---------------------------------------------------------------------------
+// File format
+// ---------------------------------------------------------------------------
+
+bool SessionLogger::readHeader(File& f, LogHeader& h) {
+    if (f.size() < sizeof(LogHeader)) return false;
+    f.seek(0);
+    if (f.read((uint8_t*)&h, sizeof(LogHeader)) != sizeof(LogHeader)) return false;
+    if (h.magic != LOG_MAGIC || h.version != LOG_VERSION) return false;
+    if (h.crc != crc32(&h, offsetof(LogHeader, crc))) return false;
+    return h.capacity > 0 && h.count <= h.capacity && h.head < h.capacity;
+}
+
+bool SessionLogger::writeHeader(File& f) {
+    _hdr.crc = crc32(&_hdr, offsetof(LogHeader, crc));
+    f.seek(0);
+    return f.write((const uint8_t*)&_hdr, sizeof(LogHeader)) == sizeof(LogHeader);
+}
+
+size_t SessionLogger::slotOffset(const LogHeader& h, uint16_t idx) const {
+    uint16_t slot = (uint16_t)((h.head + h.capacity - h.count + idx) % h.capacity);
+    return sizeof(LogHeader) + (size_t)slot * h.recordSize;
+}
+
+// Write a fresh, fully preallocated log to TMP_PATH (or LOG_PATH when
+// there is nothing to carry over) holding the newest records of `src`.
+// `srcHdr` null means `src` is the old flat file of bare records.
+void SessionLogger::rebuild(File* src, const LogHeader* srcHdr, uint16_t srcCount) {
+    const char* path = src ? TMP_PATH : LOG_PATH;
+    File f = LittleFS.open(path, "w");
+    if (!f) {
+        Serial.println(F("[SESSION] Cannot create log"));
+        return;
+    }
+
+    uint16_t keep = min(srcCount, (uint16_t)MAX_SESSION_RECORDS);
+    uint16_t skip = srcCount - keep;
+
+    _hdr = {};
+    _hdr.magic = LOG_MAGIC;
+    _hdr.version = LOG_VERSION;
+    _hdr.recordSize = sizeof(SessionRecord);
+    _hdr.capacity = MAX_SESSION_RECORDS;
+    _hdr.head = keep % MAX_SESSION_RECORDS;
+    _hdr.count = keep;
+    writeHeader(f);
+
+    SessionRecord rec;
+    for (uint16_t i = 0; i < MAX_SESSION_RECORDS; i++) {
+        rec = {};
+        if (i < keep) {
+            uint16_t from = skip + i;
+            src->seek(srcHdr ? slotOffset(*srcHdr, from) : (size_t)from * sizeof(SessionRecord));
+            src->read((uint8_t*)&rec, sizeof(SessionRecord));
+        }
+        f.write((const uint8_t*)&rec, sizeof(SessionRecord));
+    }
+    f.close();
+}
+
+// ---------------------------------------------------------------------------
+// SessionExport
+// ---------------------------------------------------------------------------
+
+SessionExport::SessionExport(SessionLogger& log)
+    : _hdr(), _stage(Stage::OPEN), _next(0) {
+    if (!log._lock) return;
+    xSemaphoreTake(log._lock, portMAX_DELAY);
+    _hdr = log._hdr;
+    _file = LittleFS.open(SessionLogger::LOG_PATH, "r");
+    xSemaphoreGive(log._lock);
+    if (!_file) _hdr.count = 0;
+}
+
+SessionExport::~SessionExport() {
+    if (_file) _file.close();
+}
+
+bool SessionExport::nextPiece() {
+    int len = 0;
+    switch (_stage) {
+        case Stage::OPEN:
+            len = snprintf(_piece, sizeof(_piece), "{\"sessions\":[");
+            _stage = Stage::RECORDS;
+            break;
+
+        case Stage::RECORDS: {
+            if (_next >= _hdr.count) {
+                _stage = Stage::CLOSE;
+                return nextPiece();
+            }
+            // Slots run contiguously until the ring wraps to slot 0
+            uint16_t slot = (uint16_t)((_hdr.head + _hdr.capacity - _hdr.count + _next) % _hdr.capacity);
+            if (_next == 0 || slot == 0) {
+                _file.seek(sizeof(SessionLogger::LogHeader) + (size_t)slot * _hdr.recordSize);
+            }
+            SessionRecord r = {};
+            _file.read((uint8_t*)&r, sizeof(SessionRecord));
+            len = snprintf(_piece, sizeof(_piece),
+                           "%s{\"start\":%lu,\"duration\":%lu,\"channel\":%u,"
+                           "\"peakTemp\":%.1f,\"avgTemp\":%.1f,\"targetTemp\":%.1f,"
+                           "\"energyWh\":%.2f}",
+                           _next ? "," : "",
+                           (unsigned long)r.startTime, (unsigned long)r.durationSec, r.channel,
+                           r.peakTempF, r.avgTempF, r.targetTempF, r.energyEstWh);
+            _next++;
+            break;
+        }
+
+        case Stage::CLOSE:
+            len = snprintf(_piece, sizeof(_piece), "]}");
+            _stage = Stage::DONE;
+            break;
+
+        case Stage::DONE:
+            return false;
+    }
+    return setPiece(len);
 }
@@ -1,8 +1,12 @@
 #pragma once
 #include <Arduino.h>
 #include <LittleFS.h>
-#include <ArduinoJson.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
 #include "config.h"
+#include "core/seqlock.h"
+#include "data/chunked_json.h"
 
 struct SessionRecord {
     uint32_t startTime;
@@ -14,29 +18,136 @@ struct SessionRecord {
     float energyEstWh;
 };
 
+// Session history is a fixed-size circular log in one preallocated file:
+//
+//   [LogHeader][slot 0][slot 1] ... [slot MAX_SESSION_RECORDS-1]
+//
+// An append overwrites the slot at `head` and then the header, in
+// place; nothing is read back, trimmed or reallocated. The header is
+// mirrored in RAM, so counting and indexing never touch flash. At 50
+// records the whole file sits in a single LittleFS block.
+//
+// The PID task never touches the file: endSession() leaves the finished
+// record in a small lock-free queue and update(), on the logger task,
+// appends it.
 class SessionLogger {
 public:
     SessionLogger();
     void begin();
-    void update();
+    void update();              // Logger task: pending records, lifetime energy
+
+    // --- PID task (or setup(), before the tasks start) ---
     void startSession(uint8_t ch, float targetTemp);
     void endSession(uint8_t ch);
-    void addDataPoint(uint8_t ch, float temp, float pidOutput);
+
+    // Once per PID tick. `duty` is the fraction the SSR actually
+    // conducted (SSRDriver::getAppliedDuty()), `nowMs` the tick time;
+    // power is integrated over the real interval between ticks.
+    void addDataPoint(uint8_t ch, float temp, float duty, uint32_t nowMs);
+    void setHeaterWatts(uint8_t ch, uint16_t watts);    // Via CMD_SET_HEATER_WATTS
+
+    // --- Any task: read from the energy mailbox the PID task publishes ---
+    float getSessionWh(uint8_t ch) const;       // Running session, 0 if none
+    double getLifetimeKWh() const;              // All sessions ever, incl. running ones
+
     uint16_t getSessionCount();
-    SessionRecord getSession(uint16_t idx);
-    String exportJSON();
+    SessionRecord getSession(uint16_t idx);     // 0 = oldest
     void clearAll();
 private:
+    friend class SessionExport;
+
     struct ActiveSession {
         bool active;
         uint32_t startMs;
         float peakTemp;
         float tempSum;
-        float energySum;
         uint32_t sampleCount;
         float targetTemp;
+        double energyWs;        // Trapezoidal integral of heater power
+        float lastWatts;
+        uint32_t lastMs;        // Previous tick; 0 before the first one
+    };
+
+    // Energy totals, published by the PID task whenever they change
+    struct EnergyView {
+        float sessionWh[NUM_CHANNELS];  // Running sessions
+        double lifetimeWh;              // Finished sessions plus the running ones
+    };
+
+    // Lifetime energy, rewritten by update() after each session end and
+    // every ENERGY_SAVE_INTERVAL_MS while one runs, so a session ended by
+    // pulling the plug still counts up to its last checkpoint
+    struct EnergyStore {
+        uint32_t magic;
+        uint32_t reserved;
+        double lifetimeWh;
+        uint32_t crc;           // CRC-32 of the fields above
     };
+
+    struct LogHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;        // sizeof(SessionRecord) when written
+        uint16_t capacity;          // Slots in the file
+        uint16_t head;              // Next slot to write
+        uint16_t count;             // Valid records, <= capacity
+        uint16_t reserved;
+        uint32_t crc;               // CRC-32 of the fields above
+    };
+
+    static const uint32_t LOG_MAGIC = 0x474C5345;  // "ESLG"
+    static const uint16_t LOG_VERSION = 1;
+
+    static const uint32_t ENERGY_MAGIC = 0x4E455345;   // "ESEN"
+
+    // Finished sessions not yet written; a power of two so the free-running
+    // uint8_t indices wrap cleanly
+    static const uint8_t PENDING_RECORDS = 8;
+
     ActiveSession _active[NUM_CHANNELS];
+    uint16_t _heaterWatts[NUM_CHANNELS];
+    double _lifetimeWh;         // Finished sessions; PID task only
+    Seqlock<EnergyView> _energy;
+    std::atomic<bool> _energyDirty;
+    double _savedWh;            // Last value written; logger task only
+    uint32_t _savedMs;
+    SessionRecord _pending[PENDING_RECORDS];
+    std::atomic<uint8_t> _pendingHead;      // Advanced by the PID task
+    std::atomic<uint8_t> _pendingTail;      // Advanced by the logger task
+    LogHeader _hdr;
+    SemaphoreHandle_t _lock;
     static const char* LOG_PATH;
+    static const char* TMP_PATH;
+    static const char* ENERGY_PATH;
+
     void appendRecord(const SessionRecord& rec);
+    void loadEnergy();
+    void saveEnergy(double lifetimeWh);
+    void publishEnergy();
+    bool readHeader(File& f, LogHeader& h);
+    bool writeHeader(File& f);
+    size_t slotOffset(const LogHeader& h, uint16_t idx) const;
+    void rebuild(File* src, const LogHeader* srcHdr, uint16_t srcCount);
+};
+
+// Incremental JSON export of the session log, {"sessions":[...]}, for
+// chunked HTTP responses. Walks the ring oldest-first through one file
+// handle held for the whole export, formatting one record at a time;
+// memory use does not depend on the number of records. A session that
+// ends mid-export may overwrite the oldest slot before it is read; the
+// output stays well-formed.
+class SessionExport : public ChunkedJson<192> {
+public:
+    explicit SessionExport(SessionLogger& log);
+    ~SessionExport();
+
+private:
+    enum class Stage : uint8_t { OPEN, RECORDS, CLOSE, DONE };
+
+    File _file;
+    SessionLogger::LogHeader _hdr;      // Snapshot taken at construction
+    Stage _stage;
+    uint16_t _next;                     // Next record, 0 = oldest
+
+    bool nextPiece() override;
 };
@@ -1,46 +1,107 @@
 #include "storage.h"
+#include "crc32.h"
 
 // ============================================================
 // ESP-Nail v2 - Versioned NVS Storage Manager
 // ============================================================
 
-StorageManager::StorageManager() {}
+StorageManager::StorageManager() : _open(false), _lock(nullptr), _dirty(0) {
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) _channels[ch] = defaultChannelSettings();
+    _global = defaultGlobalSettings();
+}
 
 bool StorageManager::begin() {
-    bool ok = _prefs.begin(NVS_NAMESPACE, false);
-    if (!ok) {
+    if (!_lock) _lock = xSemaphoreCreateMutex();
+    _open = _prefs.begin(NVS_NAMESPACE, false);
+    if (!_open) {
         Serial.println("[Storage] ERROR: NVS begin failed");
         return false;
     }
 
     uint8_t storedVersion = _prefs.getUChar("version", 0);
-    if (storedVersion != NVS_SETTINGS_VERSION) {
+    if (storedVersion == NVS_LEGACY_KEYS_VERSION) {
+        Serial.println("[Storage] Migrating per-key settings to blobs");
+        migrateLegacyKeys();
+    } else if (storedVersion != NVS_SETTINGS_VERSION) {
         Serial.printf("[Storage] Version mismatch (stored=%d, expected=%d). Resetting to defaults.\n",
                       storedVersion, NVS_SETTINGS_VERSION);
         writeAllDefaults();
         _prefs.putUChar("version", NVS_SETTINGS_VERSION);
     }
 
-    _prefs.end();
+    loadCache();
     Serial.println("[Storage] Initialized OK");
     return true;
 }
 
+// --- Blobs ---
+
+bool StorageManager::writeBlob(const char* key, const void* data, uint16_t len) {
+    if (!_open) return false;
+    uint8_t buf[sizeof(BlobHeader) + sizeof(GlobalSettings)];
+    if (len > sizeof(buf) - sizeof(BlobHeader)) return false;
+
+    BlobHeader hdr = {};
+    hdr.version = BLOB_VERSION;
+    hdr.length = len;
+    hdr.crc = crc32(data, len);
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), data, len);
+
+    size_t total = sizeof(hdr) + len;
+    return _prefs.putBytes(key, buf, total) == total;
+}
+
+bool StorageManager::readBlob(const char* key, void* data, uint16_t len) {
+    if (!_open) return false;
+    uint8_t buf[sizeof(BlobHeader) + sizeof(GlobalSettings)];
+    size_t stored = _prefs.getBytesLength(key);
+    if (stored < sizeof(BlobHeader) || stored > sizeof(buf)) return false;
+    if (_prefs.getBytes(key, buf, stored) != stored) return false;
+
+    BlobHeader hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (hdr.version != BLOB_VERSION || hdr.length != stored - sizeof(hdr) ||
+        hdr.crc != crc32(buf + sizeof(hdr), hdr.length)) {
+        Serial.printf("[Storage] Blob '%s' invalid, using defaults\n", key);
+        return false;
+    }
+    // Older, shorter payloads leave the appended fields at their defaults
+    memcpy(data, buf + sizeof(hdr), min((uint16_t)hdr.length, len));
+    return true;
+}
+
+void StorageManager::loadCache() {
+    char key[8];
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        ChannelSettings s = defaultChannelSettings();
+        snprintf(key, sizeof(key), "ch%u", ch);
+        readBlob(key, &s, sizeof(s));
+        validateChannelSettings(s);
+        _channels[ch] = s;
+    }
+
+    GlobalSettings g = defaultGlobalSettings();
+    readBlob("global", &g, sizeof(g));
+    validateGlobalSettings(g);
+    _global = g;
+}
+
 // --- Channel Settings ---
 
-String StorageManager::channelKey(uint8_t ch, const char* suffix) {
-    char buf[24];
-    snprintf(buf, sizeof(buf), "ch%u_%s", ch, suffix);
-    return String(buf);
+void StorageManager::channelKey(char* buf, size_t len, uint8_t ch, const char* suffix) {
+    snprintf(buf, len, "ch%u_%s", ch, suffix);
 }
 
 ChannelSettings StorageManager::defaultChannelSettings() {
     ChannelSettings s;
+    memset(&s, 0, sizeof(s));   // Padding too: the bytes go to flash
     s.targetTempF = TEMP_DEFAULT_F;
     s.kp = PID_KP_DEFAULT;
     s.ki = PID_KI_DEFAULT;
     s.kd = PID_KD_DEFAULT;
     s.activeProfileIndex = 2;   // "Standard" profile
+    s.heaterWatts = HEATER_WATTS_DEFAULT;
     return s;
 }
 
@@ -57,39 +118,39 @@ void StorageManager::validateChannelSettings(ChannelSettings& s) {
     if (s.activeProfileIndex >= MAX_PROFILES_PER_CH) {
         s.activeProfileIndex = 0;
     }
+    // Heater rating
+    if (s.heaterWatts == 0 || s.heaterWatts > HEATER_WATTS_MAX) {
+        s.heaterWatts = HEATER_WATTS_DEFAULT;
+    }
 }
 
 bool StorageManager::saveChannelSettings(uint8_t ch, const ChannelSettings& settings) {
     if (ch >= NUM_CHANNELS) return false;
 
-    ChannelSettings s = settings;
+    // Copy field by field so padding bytes stay zero in the blob
+    ChannelSettings s = defaultChannelSettings();
+    s.targetTempF        = settings.targetTempF;
+    s.kp                 = settings.kp;
+    s.ki                 = settings.ki;
+    s.kd                 = settings.kd;
+    s.activeProfileIndex = settings.activeProfileIndex;
+    s.heaterWatts        = settings.heaterWatts;
     validateChannelSettings(s);
 
-    _prefs.begin(NVS_NAMESPACE, false);
-    _prefs.putFloat(channelKey(ch, "temp").c_str(),    s.targetTempF);
-    _prefs.putFloat(channelKey(ch, "kp").c_str(),      s.kp);
-    _prefs.putFloat(channelKey(ch, "ki").c_str(),      s.ki);
-    _prefs.putFloat(channelKey(ch, "kd").c_str(),      s.kd);
-    _prefs.putUChar(channelKey(ch, "profIdx").c_str(), s.activeProfileIndex);
-    _prefs.end();
-
-    Serial.printf("[Storage] Saved channel %u settings\n", ch);
+    if (!_lock) return false;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _channels[ch] = s;
+    _dirty |= (1 << ch);
+    xSemaphoreGive(_lock);
+    _debounce.touch(millis());
     return true;
 }
 
 ChannelSettings StorageManager::loadChannelSettings(uint8_t ch) {
-    ChannelSettings s = defaultChannelSettings();
-    if (ch >= NUM_CHANNELS) return s;
-
-    _prefs.begin(NVS_NAMESPACE, true);
-    s.targetTempF       = _prefs.getFloat(channelKey(ch, "temp").c_str(),    s.targetTempF);
-    s.kp                = _prefs.getFloat(channelKey(ch, "kp").c_str(),      s.kp);
-    s.ki                = _prefs.getFloat(channelKey(ch, "ki").c_str(),      s.ki);
-    s.kd                = _prefs.getFloat(channelKey(ch, "kd").c_str(),      s.kd);
-    s.activeProfileIndex = _prefs.getUChar(channelKey(ch, "profIdx").c_str(), s.activeProfileIndex);
-    _prefs.end();
-
-    validateChannelSettings(s);
+    if (ch >= NUM_CHANNELS || !_lock) return defaultChannelSettings();
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    ChannelSettings s = _channels[ch];
+    xSemaphoreGive(_lock);
     return s;
 }
 
@@ -97,17 +158,13 @@ ChannelSettings StorageManager::loadChannelSettings(uint8_t ch) {
 
 GlobalSettings StorageManager::defaultGlobalSettings() {
     GlobalSettings s;
+    memset(&s, 0, sizeof(s));
     s.idleTimeoutMin    = IDLE_TIMEOUT_MIN_DEFAULT;
     s.displayBrightness = 255;
     s.fahrenheit        = true;
     s.startupAutoEnable = false;
     s.wifiMode          = 0;   // AP mode default
-    memset(s.wifiSSID, 0, sizeof(s.wifiSSID));
-    memset(s.wifiPass, 0, sizeof(s.wifiPass));
-    memset(s.mqttHost, 0, sizeof(s.mqttHost));
     s.mqttPort          = MQTT_PORT;
-    memset(s.mqttUser, 0, sizeof(s.mqttUser));
-    memset(s.mqttPass, 0, sizeof(s.mqttPass));
     return s;
 }
 
@@ -131,76 +188,154 @@ void StorageManager::validateGlobalSettings(GlobalSettings& s) {
 }
 
 bool StorageManager::saveGlobalSettings(const GlobalSettings& settings) {
-    GlobalSettings s = settings;
+    GlobalSettings s = defaultGlobalSettings();
+    s.idleTimeoutMin    = settings.idleTimeoutMin;
+    s.displayBrightness = settings.displayBrightness;
+    s.fahrenheit        = settings.fahrenheit;
+    s.startupAutoEnable = settings.startupAutoEnable;
+    s.wifiMode          = settings.wifiMode;
+    strncpy(s.wifiSSID, settings.wifiSSID, sizeof(s.wifiSSID) - 1);
+    strncpy(s.wifiPass, settings.wifiPass, sizeof(s.wifiPass) - 1);
+    strncpy(s.mqttHost, settings.mqttHost, sizeof(s.mqttHost) - 1);
+    s.mqttPort          = settings.mqttPort;
+    strncpy(s.mqttUser, settings.mqttUser, sizeof(s.mqttUser) - 1);
+    strncpy(s.mqttPass, settings.mqttPass, sizeof(s.mqttPass) - 1);
     validateGlobalSettings(s);
 
-    _prefs.begin(NVS_NAMESPACE, false);
-    _prefs.putUInt("idleTimeout",   s.idleTimeoutMin);
-    _prefs.putUChar("brightness",   s.displayBrightness);
-    _prefs.putBool("fahrenheit",    s.fahrenheit);
-    _prefs.putBool("autoEnable",    s.startupAutoEnable);
-    _prefs.putUChar("wifiMode",     s.wifiMode);
-    _prefs.putString("wifiSSID",    s.wifiSSID);
-    _prefs.putString("wifiPass",    s.wifiPass);
-    _prefs.putString("mqttHost",    s.mqttHost);
-    _prefs.putUShort("mqttPort",    s.mqttPort);
-    _prefs.putString("mqttUser",    s.mqttUser);
-    _prefs.putString("mqttPass",    s.mqttPass);
-    _prefs.end();
-
-    Serial.println("[Storage] Saved global settings");
+    if (!_lock) return false;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _global = s;
+    _dirty |= DIRTY_GLOBAL;
+    xSemaphoreGive(_lock);
+    _debounce.touch(millis());
     return true;
 }
 
 GlobalSettings StorageManager::loadGlobalSettings() {
-    GlobalSettings s = defaultGlobalSettings();
+    if (!_lock) return defaultGlobalSettings();
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    GlobalSettings s = _global;
+    xSemaphoreGive(_lock);
+    return s;
+}
+
+// --- Deferred writes ---
+
+void StorageManager::flush() {
+    if (!_open || !_lock) return;
+
+    // Snapshot under the lock, write without it: a save from the UI
+    // meanwhile just marks the blob dirty again for the next flush
+    _debounce.clear();
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    uint8_t dirty = _dirty;
+    _dirty = 0;
+    ChannelSettings cs[NUM_CHANNELS];
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) cs[ch] = _channels[ch];
+    GlobalSettings gs = _global;
+    xSemaphoreGive(_lock);
+    if (!dirty) return;
+
+    uint8_t failed = 0;
+    char key[8];
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        if (!(dirty & (1 << ch))) continue;
+        snprintf(key, sizeof(key), "ch%u", ch);
+        if (writeBlob(key, &cs[ch], sizeof(cs[ch]))) {
+            Serial.printf("[Storage] Saved channel %u settings\n", ch);
+        } else {
+            failed |= (1 << ch);
+        }
+    }
+    if (dirty & DIRTY_GLOBAL) {
+        if (writeBlob("global", &gs, sizeof(gs))) {
+            Serial.println("[Storage] Saved global settings");
+        } else {
+            failed |= DIRTY_GLOBAL;
+        }
+    }
+
+    if (failed) {
+        Serial.printf("[Storage] ERROR: write failed (mask 0x%02X), will retry\n", failed);
+        xSemaphoreTake(_lock, portMAX_DELAY);
+        _dirty |= failed;
+        xSemaphoreGive(_lock);
+        _debounce.touch(millis());
+    }
+}
+
+// --- Legacy per-key layout (NVS_LEGACY_KEYS_VERSION) ---
+
+ChannelSettings StorageManager::loadLegacyChannel(uint8_t ch) {
+    ChannelSettings s = defaultChannelSettings();
+    char key[24];
+    channelKey(key, sizeof(key), ch, "temp");    s.targetTempF = _prefs.getFloat(key, s.targetTempF);
+    channelKey(key, sizeof(key), ch, "kp");      s.kp = _prefs.getFloat(key, s.kp);
+    channelKey(key, sizeof(key), ch, "ki");      s.ki = _prefs.getFloat(key, s.ki);
+    channelKey(key, sizeof(key), ch, "kd");      s.kd = _prefs.getFloat(key, s.kd);
+    channelKey(key, sizeof(key), ch, "profIdx"); s.activeProfileIndex = _prefs.getUChar(key, s.activeProfileIndex);
+    channelKey(key, sizeof(key), ch, "watts");   s.heaterWatts = _prefs.getUShort(key, s.heaterWatts);
+    return s;
+}
 
-    _prefs.begin(NVS_NAMESPACE, true);
+GlobalSettings StorageManager::loadLegacyGlobal() {
+    GlobalSettings s = defaultGlobalSettings();
     s.idleTimeoutMin    = _prefs.getUInt("idleTimeout",   s.idleTimeoutMin);
     s.displayBrightness = _prefs.getUChar("brightness",   s.displayBrightness);
     s.fahrenheit        = _prefs.getBool("fahrenheit",     s.fahrenheit);
     s.startupAutoEnable = _prefs.getBool("autoEnable",     s.startupAutoEnable);
     s.wifiMode          = _prefs.getUChar("wifiMode",      s.wifiMode);
+    _prefs.getString("wifiSSID", s.wifiSSID, sizeof(s.wifiSSID));
+    _prefs.getString("wifiPass", s.wifiPass, sizeof(s.wifiPass));
+    _prefs.getString("mqttHost", s.mqttHost, sizeof(s.mqttHost));
+    _prefs.getString("mqttUser", s.mqttUser, sizeof(s.mqttUser));
+    _prefs.getString("mqttPass", s.mqttPass, sizeof(s.mqttPass));
+    s.mqttPort          = _prefs.getUShort("mqttPort", s.mqttPort);
+    return s;
+}
 
-    // Load strings safely
-    String ssid = _prefs.getString("wifiSSID", "");
-    String pass = _prefs.getString("wifiPass", "");
-    String mqttH = _prefs.getString("mqttHost", "");
-    String mqttU = _prefs.getString("mqttUser", "");
-    String mqttP = _prefs.getString("mqttPass", "");
+void StorageManager::migrateLegacyKeys() {
+    static const char* const CH_KEYS[] = { "temp", "kp", "ki", "kd", "profIdx", "watts" };
+    static const char* const GLOBAL_KEYS[] = {
+        "idleTimeout", "brightness", "fahrenheit", "autoEnable", "wifiMode",
+        "wifiSSID", "wifiPass", "mqttHost", "mqttPort", "mqttUser", "mqttPass"
+    };
 
-    strncpy(s.wifiSSID, ssid.c_str(), sizeof(s.wifiSSID) - 1);
-    strncpy(s.wifiPass, pass.c_str(), sizeof(s.wifiPass) - 1);
-    strncpy(s.mqttHost, mqttH.c_str(), sizeof(s.mqttHost) - 1);
-    strncpy(s.mqttUser, mqttU.c_str(), sizeof(s.mqttUser) - 1);
-    strncpy(s.mqttPass, mqttP.c_str(), sizeof(s.mqttPass) - 1);
+    // Blobs and version go in before any old key is removed: a reset
+    // midway either re-runs the migration from intact keys or skips it
+    ChannelSettings cs[NUM_CHANNELS];
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) cs[ch] = loadLegacyChannel(ch);
+    GlobalSettings gs = loadLegacyGlobal();
 
-    s.mqttPort = _prefs.getUShort("mqttPort", s.mqttPort);
-    _prefs.end();
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) saveChannelSettings(ch, cs[ch]);
+    saveGlobalSettings(gs);
+    flush();
+    _prefs.putUChar("version", NVS_SETTINGS_VERSION);
 
-    validateGlobalSettings(s);
-    return s;
+    char key[24];
+    for (uint8_t ch = 0; ch < NUM_CHANNELS; ch++) {
+        for (const char* suffix : CH_KEYS) {
+            channelKey(key, sizeof(key), ch, suffix);
+            _prefs.remove(key);
+        }
+    }
+    for (const char* k : GLOBAL_KEYS) _prefs.remove(k);
 }
 
 // --- Factory Reset ---
 
 void StorageManager::factoryReset() {
     Serial.println("[Storage] Factory reset - clearing all settings");
-    _prefs.begin(NVS_NAMESPACE, false);
+    if (!_open) return;
     _prefs.clear();
-    _prefs.end();
     writeAllDefaults();
-    _prefs.begin(NVS_NAMESPACE, false);
     _prefs.putUChar("version", NVS_SETTINGS_VERSION);
-    _prefs.end();
     Serial.println("[Storage] Factory reset complete");
 }
 
 uint8_t StorageManager::getSettingsVersion() {
-    _prefs.begin(NVS_NAMESPACE, true);
-    uint8_t v = _prefs.getUChar("version", 0);
-    _prefs.end();
-    return v;
+    if (!_open) return 0;
+    return _prefs.getUChar("version", 0);
 }
 
 void StorageManager::writeAllDefaults() {
@@ -210,4 +345,5 @@ void StorageManager::writeAllDefaults() {
         ChannelSettings cs = defaultChannelSettings();
         saveChannelSettings(ch, cs);
     }
+    flush();
 }
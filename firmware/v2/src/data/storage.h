@@ -4,10 +4,24 @@
 // ESP-Nail v2 - Versioned NVS Storage Manager
 // Persistent settings with version migration and validation
 // ============================================================
+//
+// Each settings struct is one NVS blob ("ch0".."ch3", "global"):
+// a small header with the payload length and a CRC-32, then the struct
+// bytes. Loads are served from a RAM copy filled once in begin(). Fields
+// are only ever appended, so a shorter blob from older firmware keeps
+// defaults for the new tail.
+//
+// Saves only update the RAM copy and mark it dirty; the persist task
+// calls flush() once flushDue(), one putBytes per dirty blob. Callers
+// on any task never wait on flash. The RAM copies are guarded by an
+// internal mutex held for a struct copy at most.
 
 #include <Arduino.h>
 #include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include "config.h"
+#include "write_debounce.h"
 
 // --- Per-Channel Settings ---
 struct ChannelSettings {
@@ -16,6 +30,7 @@ struct ChannelSettings {
     float ki;
     float kd;
     uint8_t activeProfileIndex;
+    uint16_t heaterWatts;       // Coil rating, for energy accounting
 };
 
 // --- Global Settings ---
@@ -48,6 +63,11 @@ public:
     bool saveGlobalSettings(const GlobalSettings& settings);
     GlobalSettings loadGlobalSettings();
 
+    /// Deferred writes: due once the changes have settled
+    bool flushDue(uint32_t nowMs) const { return _debounce.due(nowMs); }
+    bool hasPending() const             { return _debounce.pending(); }
+    void flush();                       // Write all dirty blobs now
+
     /// Reset all stored settings to factory defaults
     void factoryReset();
 
@@ -55,10 +75,38 @@ public:
     uint8_t getSettingsVersion();
 
 private:
-    Preferences _prefs;
-
-    /// Build NVS key string for a channel-specific value
-    String channelKey(uint8_t ch, const char* suffix);
+    struct BlobHeader {
+        uint8_t version;
+        uint8_t reserved;
+        uint16_t length;        // Payload bytes
+        uint32_t crc;           // CRC-32 of the payload
+    };
+
+    static const uint8_t BLOB_VERSION = 1;
+    static const uint8_t DIRTY_GLOBAL = 0x80;   // Bits 0..3: channels
+
+    Preferences _prefs;         // Kept open from begin() on
+    bool _open;
+    SemaphoreHandle_t _lock;    // Guards the RAM copies and _dirty
+    ChannelSettings _channels[NUM_CHANNELS];
+    GlobalSettings _global;
+    uint8_t _dirty;
+    WriteDebounce _debounce;
+
+    /// Build NVS key for a channel-specific value
+    void channelKey(char* buf, size_t len, uint8_t ch, const char* suffix);
+
+    /// Write/read one header + payload blob; read leaves `data` alone on failure
+    bool writeBlob(const char* key, const void* data, uint16_t len);
+    bool readBlob(const char* key, void* data, uint16_t len);
+
+    /// Convert the per-field layout of NVS_LEGACY_KEYS_VERSION to blobs
+    void migrateLegacyKeys();
+    ChannelSettings loadLegacyChannel(uint8_t ch);
+    GlobalSettings loadLegacyGlobal();
+
+    /// Fill the RAM copies from NVS
+    void loadCache();
 
     /// Create default channel settings
     ChannelSettings defaultChannelSettings();
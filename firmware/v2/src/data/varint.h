@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+
+// Zigzag varints for the time-series blocks: a signed delta is zigzag
+// mapped (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) so small magnitudes of
+// either sign take few bytes, then stored 7 bits per byte, low first,
+// with the top bit set on all but the last byte. An int32_t takes 1-5 bytes.
+
+static const uint8_t VARINT_MAX_BYTES = 5;
+
+// Encode `v` into out (room for VARINT_MAX_BYTES); returns the length
+inline uint8_t putVarint(uint8_t* out, int32_t v) {
+    uint32_t z = ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);     // Zigzag
+    uint8_t n = 0;
+    while (z >= 0x80) {
+        out[n++] = (uint8_t)(z | 0x80);
+        z >>= 7;
+    }
+    out[n++] = (uint8_t)z;
+    return n;
+}
+
+// Decode one value from buf[pos..len), advancing pos. False if the
+// buffer ends mid-value or the value runs past VARINT_MAX_BYTES.
+inline bool getVarint(const uint8_t* buf, uint16_t len, uint16_t& pos, int32_t& v) {
+    uint32_t z = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7) {
+        if (pos >= len) return false;
+        uint8_t b = buf[pos++];
+        z |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            v = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+            return true;
+        }
+    }
+    return false;
+}
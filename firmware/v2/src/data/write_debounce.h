@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+#include "config.h"
+
+// When to write settings that were changed in RAM only.
+//
+// Due SETTINGS_DEBOUNCE_MS after the last change, so a burst of encoder
+// detents or menu clicks becomes a single flash write; but no later than
+// SETTINGS_MAX_DEFER_MS after the first one, so a knob that keeps turning
+// still gets saved. touch() from any task, due()/clear() from the
+// persistence task. Owners set their dirty flags before touch() and call
+// clear() before collecting them, so a change is never lost in between.
+
+class WriteDebounce {
+public:
+    WriteDebounce() : _pending(false), _firstMs(0), _lastMs(0) {}
+
+    void touch(uint32_t nowMs) {
+        _lastMs.store(nowMs, std::memory_order_relaxed);
+        if (!_pending.exchange(true, std::memory_order_acq_rel)) {
+            _firstMs.store(nowMs, std::memory_order_relaxed);
+        }
+    }
+
+    bool due(uint32_t nowMs) const {
+        if (!_pending.load(std::memory_order_acquire)) return false;
+        return (nowMs - _lastMs.load(std::memory_order_relaxed)) >= SETTINGS_DEBOUNCE_MS ||
+               (nowMs - _firstMs.load(std::memory_order_relaxed)) >= SETTINGS_MAX_DEFER_MS;
+    }
+
+    bool pending() const { return _pending.load(std::memory_order_acquire); }
+    void clear() { _pending.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> _pending;
+    std::atomic<uint32_t> _firstMs;
+    std::atomic<uint32_t> _lastMs;
+};
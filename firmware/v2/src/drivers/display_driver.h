@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Abstract display interface for swappable display drivers
+class DisplayDriver {
+public:
+    virtual ~DisplayDriver() {}
+    virtual void begin() = 0;
+    virtual void clear() = 0;
+    virtual void display() = 0;     // Blocking: frame is on the panel on return
+    virtual void flush() { display(); }  // Hand the frame off; may return before it is sent
+    virtual void setTextSize(uint8_t size) = 0;
+    virtual void setCursor(int16_t x, int16_t y) = 0;
+    virtual void print(const char* text) = 0;
+    virtual void printf(const char* fmt, ...) = 0;
+    virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) = 0;
+    virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h) = 0;
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h) = 0;
+    virtual void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) = 0;
+    virtual void clearRect(int16_t x, int16_t y, int16_t w, int16_t h) = 0;   // Fill with background
+    virtual void setInvertText(bool invert) = 0;
+    virtual void setColor(uint16_t rgb565) {}  // Foreground for later draws; ignored on mono panels
+    virtual uint16_t width() = 0;
+    virtual uint16_t height() = 0;
+
+    // Partial updates (see ui/widget_tree.h). Without clear(), a flush
+    // only needs to cover regions reported through markDirty(). A driver
+    // that can no longer patch its frame asks for one full redraw.
+    virtual void markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {}
+    virtual bool wantsFullRedraw() { return false; }
+};
+
+// RGB565 colours for DisplayDriver::setColor()
+static const uint16_t COLOR_WHITE  = 0xFFFF;
+static const uint16_t COLOR_ORANGE = 0xFD20;
+static const uint16_t COLOR_GREEN  = 0x07E0;
+static const uint16_t COLOR_CYAN   = 0x07FF;
+static const uint16_t COLOR_RED    = 0xF800;
+static const uint16_t COLOR_GREY   = 0x8410;
@@ -1,10 +1,24 @@
 #include "display_ssd1306.h"
 #include <cstdarg>
 
+// Unchanged columns shorter than this between two changed ones are
+// resent rather than paying for another addressing transaction
+static const uint8_t SPAN_MERGE_GAP = 8;
+
+// Data bytes per I2C transaction, inside the ESP32 Wire buffer
+static const uint8_t I2C_CHUNK = 32;
+
 DisplaySSD1306::DisplaySSD1306()
-    : _oled(OLED_WIDTH, OLED_HEIGHT, &Wire, -1) {}
+    : _oled(OLED_WIDTH, OLED_HEIGHT, &Wire, -1, OLED_I2C_HZ, OLED_I2C_HZ),
+      _pending(_frames[0]), _sending(_frames[1]), _pendingReady(false),
+      _dirtyPages(0xFF), _pendingPages(0),
+      _shadowValid(false), _swapLock(nullptr), _busLock(nullptr),
+      _transferTask(nullptr) {}
 
 void DisplaySSD1306::begin() {
+    _swapLock = xSemaphoreCreateMutex();
+    _busLock = xSemaphoreCreateMutex();
+
     Wire.begin(PIN_SDA, PIN_SCL);
     if (!_oled.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
         Serial.println(F("[DISPLAY] SSD1306 init failed"));
@@ -13,15 +27,131 @@ void DisplaySSD1306::begin() {
     _oled.clearDisplay();
     _oled.setTextColor(SSD1306_WHITE);
     _oled.display();
+
+    memcpy(_shadow, _oled.getBuffer(), BUFFER_SIZE);
+    _shadowValid = true;
 }
 
 void DisplaySSD1306::clear() {
     _oled.clearDisplay();
     _oled.setTextColor(SSD1306_WHITE);
+    _dirtyPages = 0xFF;
+}
+
+void DisplaySSD1306::clearRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    _oled.fillRect(x, y, w, h, SSD1306_BLACK);
+}
+
+void DisplaySSD1306::markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+    int16_t y0 = max((int16_t)0, y);
+    int16_t y1 = min((int16_t)(OLED_HEIGHT - 1), (int16_t)(y + h - 1));
+    for (int16_t page = y0 / 8; page <= y1 / 8; page++) {
+        _dirtyPages |= 1 << page;
+    }
 }
 
 void DisplaySSD1306::display() {
-    _oled.display();
+    flush();
+    transmitPending();
+}
+
+void DisplaySSD1306::flush() {
+    const uint8_t* buf = _oled.getBuffer();
+    if (!buf || !_swapLock) return;  // begin() failed
+    if (!_dirtyPages) return;        // Nothing drawn since the last flush
+
+    xSemaphoreTake(_swapLock, portMAX_DELAY);
+    memcpy(_pending, buf, BUFFER_SIZE);
+    _pendingReady = true;
+    _pendingPages |= _dirtyPages;   // A replaced frame's pages still need sending
+    xSemaphoreGive(_swapLock);
+    _dirtyPages = 0;
+
+    TaskHandle_t task = _transferTask;
+    if (task) xTaskNotifyGive(task);
+}
+
+bool DisplaySSD1306::transmitPending() {
+    if (!_busLock) return false;
+
+    xSemaphoreTake(_busLock, portMAX_DELAY);
+
+    xSemaphoreTake(_swapLock, portMAX_DELAY);
+    bool ready = _pendingReady;
+    uint8_t pages = _pendingPages;
+    if (ready) {
+        uint8_t* t = _sending;
+        _sending = _pending;
+        _pending = t;
+        _pendingReady = false;
+        _pendingPages = 0;
+    }
+    xSemaphoreGive(_swapLock);
+
+    if (ready) sendFrame(_sending, pages);
+
+    xSemaphoreGive(_busLock);
+    return ready;
+}
+
+void DisplaySSD1306::sendFrame(const uint8_t* buf, uint8_t pages) {
+    bool full = !_shadowValid;
+    _shadowValid = true;
+
+    // Buffer layout is page-major: byte (page * WIDTH + col) holds the
+    // 8 vertical pixels of column `col` in that page
+    for (uint8_t page = 0; page < PAGES; page++) {
+        if (!full && !(pages & (1 << page))) continue;  // Untouched, matches shadow
+
+        const uint8_t* row = buf + page * OLED_WIDTH;
+        uint8_t* shadow = _shadow + page * OLED_WIDTH;
+
+        if (full) {
+            sendSpan(page, 0, OLED_WIDTH - 1, row);
+            memcpy(shadow, row, OLED_WIDTH);
+            continue;
+        }
+
+        int16_t start = -1, last = -1;
+        for (int16_t col = 0; col < OLED_WIDTH; col++) {
+            if (row[col] == shadow[col]) continue;
+            if (start >= 0 && col - last > SPAN_MERGE_GAP) {
+                sendSpan(page, start, last, row + start);
+                start = -1;
+            }
+            if (start < 0) start = col;
+            last = col;
+        }
+        if (start >= 0) sendSpan(page, start, last, row + start);
+
+        memcpy(shadow, row, OLED_WIDTH);
+    }
+}
+
+void DisplaySSD1306::sendSpan(uint8_t page, uint8_t col0, uint8_t col1,
+                              const uint8_t* data) {
+    // Horizontal addressing (set by Adafruit begin()) wraps within the
+    // column/page window, so one window covers the whole span
+    Wire.beginTransmission(OLED_ADDR);
+    Wire.write((uint8_t)0x00);              // Co = 0, D/C = 0: command stream
+    Wire.write((uint8_t)SSD1306_COLUMNADDR);
+    Wire.write(col0);
+    Wire.write(col1);
+    Wire.write((uint8_t)SSD1306_PAGEADDR);
+    Wire.write(page);
+    Wire.write(page);
+    Wire.endTransmission();
+
+    uint16_t len = col1 - col0 + 1;
+    while (len > 0) {
+        uint8_t n = len > I2C_CHUNK ? I2C_CHUNK : len;
+        Wire.beginTransmission(OLED_ADDR);
+        Wire.write((uint8_t)0x40);          // D/C = 1: data stream
+        Wire.write(data, n);
+        Wire.endTransmission();
+        data += n;
+        len -= n;
+    }
 }
 
 void DisplaySSD1306::setTextSize(uint8_t size) {
@@ -4,29 +4,22 @@
 #include <Wire.h>
 #include <Adafruit_GFX.h>
 #include <Adafruit_SSD1306.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
 #include "config.h"
+#include "drivers/display_driver.h"
 
-// Abstract display interface for swappable display drivers
-class DisplayDriver {
-public:
-    virtual ~DisplayDriver() {}
-    virtual void begin() = 0;
-    virtual void clear() = 0;
-    virtual void display() = 0;
-    virtual void setTextSize(uint8_t size) = 0;
-    virtual void setCursor(int16_t x, int16_t y) = 0;
-    virtual void print(const char* text) = 0;
-    virtual void printf(const char* fmt, ...) = 0;
-    virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) = 0;
-    virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h) = 0;
-    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h) = 0;
-    virtual void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) = 0;
-    virtual void setInvertText(bool invert) = 0;
-    virtual uint16_t width() = 0;
-    virtual uint16_t height() = 0;
-};
-
-// SSD1306 128x64 OLED implementation
+// SSD1306 128x64 OLED implementation.
+// Each frame is diffed against a shadow of the last frame sent and only
+// the changed column spans of each 8-row page go out, so a mostly static
+// screen costs a few dozen bytes of I2C instead of 1 KB.
+//
+// flush() double-buffers: it copies the drawn frame into the pending
+// slot and wakes the transfer task, which swaps it into the sending
+// slot and does the (blocking) I2C work. The caller can draw the next
+// frame immediately; if it flushes again before the bus catches up,
+// the newer frame replaces the pending one.
 class DisplaySSD1306 : public DisplayDriver {
 public:
     DisplaySSD1306();
@@ -34,6 +27,7 @@ public:
     void begin() override;
     void clear() override;
     void display() override;
+    void flush() override;
     void setTextSize(uint8_t size) override;
     void setCursor(int16_t x, int16_t y) override;
     void print(const char* text) override;
@@ -43,12 +37,42 @@ public:
     void fillRect(int16_t x, int16_t y, int16_t w, int16_t h) override;
     void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) override;
     void setInvertText(bool invert) override;
+    void clearRect(int16_t x, int16_t y, int16_t w, int16_t h) override;
     uint16_t width() override   { return OLED_WIDTH; }
     uint16_t height() override  { return OLED_HEIGHT; }
+    void markDirty(int16_t x, int16_t y, int16_t w, int16_t h) override;
+
+    // Transfer side: the task that calls transmitPending() registers
+    // here to be notified by flush()
+    void setTransferTask(TaskHandle_t task) { _transferTask = task; }
+    bool transmitPending();     // Send the pending frame, if any; blocks on I2C
+
+    // Resend the whole frame on the next transfer (e.g. after the
+    // panel lost power or was written through getRaw())
+    void invalidate()           { _shadowValid = false; }
 
     Adafruit_SSD1306& getRaw() { return _oled; }
 
 private:
+    static const uint16_t PAGES = OLED_HEIGHT / 8;
+    static const uint16_t BUFFER_SIZE = OLED_WIDTH * PAGES;
+
     Adafruit_SSD1306 _oled;
     char _printBuf[64];
+
+    uint8_t _frames[2][BUFFER_SIZE];
+    uint8_t* _pending;              // Latest flushed frame, guarded by _swapLock
+    uint8_t* _sending;              // Owned by whoever holds _busLock
+    bool _pendingReady;
+    uint8_t _dirtyPages;            // Bit per page touched since the last flush()
+    uint8_t _pendingPages;          // Pages to diff in the pending frame
+    uint8_t _shadow[BUFFER_SIZE];   // Frame as last transmitted
+    volatile bool _shadowValid;
+
+    SemaphoreHandle_t _swapLock;    // Held for a 1 KB copy or pointer swap only
+    SemaphoreHandle_t _busLock;     // Held for a whole frame transfer
+    TaskHandle_t volatile _transferTask;
+
+    void sendFrame(const uint8_t* buf, uint8_t pages);
+    void sendSpan(uint8_t page, uint8_t col0, uint8_t col1, const uint8_t* data);
 };
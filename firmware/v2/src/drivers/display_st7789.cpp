@@ -0,0 +1,351 @@
+#include "display_st7789.h"
+#include <cstdarg>
+#include <esp_heap_caps.h>
+#include <driver/gpio.h>
+
+// ST7789 commands
+static const uint8_t ST_SWRESET = 0x01;
+static const uint8_t ST_SLPOUT  = 0x11;
+static const uint8_t ST_NORON   = 0x13;
+static const uint8_t ST_INVON   = 0x21;
+static const uint8_t ST_DISPON  = 0x29;
+static const uint8_t ST_CASET   = 0x2A;
+static const uint8_t ST_RASET   = 0x2B;
+static const uint8_t ST_RAMWR   = 0x2C;
+static const uint8_t ST_MADCTL  = 0x36;
+static const uint8_t ST_COLMOD  = 0x3A;
+
+// spi_transaction_t::user carries the D/C level for preTransfer()
+#define DC_COMMAND  ((void*)0)
+#define DC_DATA     ((void*)1)
+
+DisplayST7789::DisplayST7789()
+    : _opCount(0), _textUsed(0), _overflow(false), _band(nullptr), _hashValid(false),
+      _dirtyBands(0xFFFF),
+      _dev(nullptr), _queued(0), _completed(0), _nextTx(0),
+      _lastFlushBytes(0), _ready(false) {
+    _tx[0] = _tx[1] = nullptr;
+    _txSeq[0] = _txSeq[1] = 0;
+    memset(_trans, 0, sizeof(_trans));
+}
+
+void DisplayST7789::begin() {
+    pinMode(PIN_TFT_DC, OUTPUT);
+    if (PIN_TFT_RST >= 0) {
+        pinMode(PIN_TFT_RST, OUTPUT);
+        digitalWrite(PIN_TFT_RST, LOW);
+        delay(10);
+        digitalWrite(PIN_TFT_RST, HIGH);
+        delay(120);
+    }
+
+    spi_device_interface_config_t dev = {};
+    dev.mode = 0;
+    dev.clock_speed_hz = TFT_SPI_CLOCK_HZ;
+    dev.spics_io_num = PIN_TFT_CS;
+    dev.queue_size = 2 * TRANS_PER_PUSH;
+    dev.pre_cb = preTransfer;
+
+    esp_err_t err = spi_bus_add_device(TC_SPI_HOST, &dev, &_dev);
+    if (err != ESP_OK) {
+        Serial.printf("[DISPLAY] ST7789 add device failed (%d)\n", err);
+        return;
+    }
+
+    _band = new GFXcanvas16(TFT_WIDTH, TFT_BAND_ROWS);
+    size_t txBytes = TFT_WIDTH * TFT_BAND_ROWS * sizeof(uint16_t);
+    _tx[0] = (uint16_t*)heap_caps_malloc(txBytes, MALLOC_CAP_DMA);
+    _tx[1] = (uint16_t*)heap_caps_malloc(txBytes, MALLOC_CAP_DMA);
+    if (!_band || !_band->getBuffer() || !_tx[0] || !_tx[1]) {
+        Serial.println(F("[DISPLAY] ST7789 buffer alloc failed"));
+        return;
+    }
+
+    static const uint8_t colmod = 0x55;     // 16-bit RGB565
+    static const uint8_t madctl = 0x00;
+    sendInit(ST_SWRESET, nullptr, 0);
+    delay(150);
+    sendInit(ST_SLPOUT, nullptr, 0);
+    delay(120);
+    sendInit(ST_COLMOD, &colmod, 1);
+    sendInit(ST_MADCTL, &madctl, 1);
+    sendInit(ST_INVON, nullptr, 0);         // 240x240 IPS modules are inverted
+    sendInit(ST_NORON, nullptr, 0);
+    sendInit(ST_DISPON, nullptr, 0);
+
+    _ready = true;
+    clear();
+    display();
+}
+
+// --- Display list ---
+
+DisplayST7789::DrawOp* DisplayST7789::addOp(Op op) {
+    if (_opCount >= MAX_OPS) {
+        _overflow = true;
+        return nullptr;
+    }
+    DrawOp* o = &_ops[_opCount++];
+    o->op = op;
+    return o;
+}
+
+void DisplayST7789::clear() {
+    _opCount = 0;
+    _textUsed = 0;
+    _overflow = false;
+    _dirtyBands = 0xFFFF;
+}
+
+void DisplayST7789::markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+    int16_t y0 = max((int16_t)0, y);
+    int16_t y1 = min((int16_t)(TFT_HEIGHT - 1), (int16_t)(y + h - 1));
+    for (int16_t band = y0 / TFT_BAND_ROWS; band <= y1 / TFT_BAND_ROWS; band++) {
+        _dirtyBands |= 1 << band;
+    }
+}
+
+bool DisplayST7789::wantsFullRedraw() {
+    return _overflow || _opCount > MAX_OPS * 3 / 4 || _textUsed > TEXT_POOL * 3 / 4;
+}
+
+void DisplayST7789::setTextSize(uint8_t size) {
+    DrawOp* o = addOp(OP_SIZE);
+    if (o) o->a[0] = size;
+}
+
+void DisplayST7789::setCursor(int16_t x, int16_t y) {
+    DrawOp* o = addOp(OP_CURSOR);
+    if (o) { o->a[0] = x; o->a[1] = y; }
+}
+
+void DisplayST7789::print(const char* text) {
+    size_t len = strlen(text);
+    if (_textUsed + len + 1 > TEXT_POOL) {
+        _overflow = true;
+        return;
+    }
+    DrawOp* o = addOp(OP_TEXT);
+    if (!o) return;
+    o->text = _textUsed;
+    memcpy(_textPool + _textUsed, text, len + 1);
+    _textUsed += len + 1;
+}
+
+void DisplayST7789::printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(_printBuf, sizeof(_printBuf), fmt, args);
+    va_end(args);
+    print(_printBuf);
+}
+
+void DisplayST7789::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    DrawOp* o = addOp(OP_LINE);
+    if (o) { o->a[0] = x0; o->a[1] = y0; o->a[2] = x1; o->a[3] = y1; }
+}
+
+void DisplayST7789::drawRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    DrawOp* o = addOp(OP_RECT);
+    if (o) { o->a[0] = x; o->a[1] = y; o->a[2] = w; o->a[3] = h; }
+}
+
+void DisplayST7789::fillRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    DrawOp* o = addOp(OP_FILL);
+    if (o) { o->a[0] = x; o->a[1] = y; o->a[2] = w; o->a[3] = h; }
+}
+
+void DisplayST7789::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    DrawOp* o = addOp(OP_TRI);
+    if (o) {
+        o->a[0] = x0; o->a[1] = y0; o->a[2] = x1;
+        o->a[3] = y1; o->a[4] = x2; o->a[5] = y2;
+    }
+}
+
+void DisplayST7789::setInvertText(bool invert) {
+    DrawOp* o = addOp(OP_INVERT);
+    if (o) o->a[0] = invert;
+}
+
+void DisplayST7789::setColor(uint16_t rgb565) {
+    DrawOp* o = addOp(OP_COLOR);
+    if (o) o->a[0] = (int16_t)rgb565;
+}
+
+void DisplayST7789::clearRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+    DrawOp* o = addOp(OP_CLEAR);
+    if (o) { o->a[0] = x; o->a[1] = y; o->a[2] = w; o->a[3] = h; }
+}
+
+// Draw the whole list into the band sprite, shifted up by bandY;
+// the canvas clips everything outside the band
+void DisplayST7789::replay(int16_t bandY) {
+    GFXcanvas16& c = *_band;
+    uint16_t fg = COLOR_WHITE;
+    bool invert = false;
+    bool opaque = false;            // Text background, as on the SSD1306 driver
+
+    c.fillScreen(0);
+    c.setTextSize(1);
+    c.setCursor(0, -bandY);
+    c.setTextColor(fg);
+
+    for (uint8_t i = 0; i < _opCount; i++) {
+        const DrawOp& o = _ops[i];
+        switch (o.op) {
+            case OP_SIZE:   c.setTextSize(o.a[0]); break;
+            case OP_CURSOR: c.setCursor(o.a[0], o.a[1] - bandY); break;
+            case OP_TEXT:   c.print(_textPool + o.text); break;
+            case OP_LINE:   c.drawLine(o.a[0], o.a[1] - bandY, o.a[2], o.a[3] - bandY, fg); break;
+            case OP_RECT:   c.drawRect(o.a[0], o.a[1] - bandY, o.a[2], o.a[3], fg); break;
+            case OP_FILL:   c.fillRect(o.a[0], o.a[1] - bandY, o.a[2], o.a[3], fg); break;
+            case OP_CLEAR:  c.fillRect(o.a[0], o.a[1] - bandY, o.a[2], o.a[3], 0); break;
+            case OP_TRI:
+                c.fillTriangle(o.a[0], o.a[1] - bandY, o.a[2], o.a[3] - bandY,
+                               o.a[4], o.a[5] - bandY, fg);
+                break;
+            case OP_INVERT:
+            case OP_COLOR:
+                if (o.op == OP_INVERT) {
+                    invert = o.a[0];
+                    opaque = true;
+                } else {
+                    fg = (uint16_t)o.a[0];
+                }
+                if (invert) c.setTextColor(0, fg);
+                else if (opaque) c.setTextColor(fg, 0);
+                else c.setTextColor(fg);
+                break;
+        }
+    }
+}
+
+// --- Transfer ---
+
+void DisplayST7789::flush() {
+    if (!_ready) return;
+
+    _lastFlushBytes = 0;
+    for (uint8_t band = 0; band < BANDS; band++) {
+        if (_hashValid && !(_dirtyBands & (1 << band))) continue;
+        replay(band * TFT_BAND_ROWS);
+
+        // FNV-1a per block; the changed span is first..last dirty block
+        const uint16_t* px = _band->getBuffer();
+        int16_t first = -1, last = -1;
+        for (uint8_t b = 0; b < BLOCKS; b++) {
+            uint32_t h = 2166136261u;
+            for (uint8_t row = 0; row < TFT_BAND_ROWS; row++) {
+                const uint16_t* p = px + row * TFT_WIDTH + b * TFT_BLOCK_COLS;
+                for (uint8_t col = 0; col < TFT_BLOCK_COLS; col++) {
+                    h = (h ^ p[col]) * 16777619u;
+                }
+            }
+            if (!_hashValid || h != _hash[band][b]) {
+                if (first < 0) first = b;
+                last = b;
+            }
+            _hash[band][b] = h;
+        }
+
+        if (first >= 0) push(band, first, last);
+    }
+    _hashValid = true;
+    _dirtyBands = 0;
+}
+
+void DisplayST7789::display() {
+    flush();
+    waitIdle();
+}
+
+void DisplayST7789::push(uint8_t band, uint8_t block0, uint8_t block1) {
+    uint8_t buf = _nextTx;
+    _nextTx ^= 1;
+    waitTx(buf);    // DMA from this buffer's previous push must be done
+
+    uint16_t x0 = block0 * TFT_BLOCK_COLS;
+    uint16_t x1 = (block1 + 1) * TFT_BLOCK_COLS - 1;
+    uint16_t y0 = band * TFT_BAND_ROWS;
+    uint16_t y1 = y0 + TFT_BAND_ROWS - 1;
+    uint16_t w = x1 - x0 + 1;
+
+    // Pack the span rows contiguously, big-endian as the panel expects
+    const uint16_t* src = _band->getBuffer();
+    uint16_t* dst = _tx[buf];
+    for (uint8_t row = 0; row < TFT_BAND_ROWS; row++) {
+        const uint16_t* s = src + row * TFT_WIDTH + x0;
+        for (uint16_t i = 0; i < w; i++) {
+            *dst++ = (uint16_t)((s[i] << 8) | (s[i] >> 8));
+        }
+    }
+
+    spi_transaction_t* t = _trans[buf];
+    memset(t, 0, sizeof(_trans[buf]));
+    const uint8_t cmds[3] = { ST_CASET, ST_RASET, ST_RAMWR };
+    const uint16_t args[2][2] = { { x0, x1 }, { y0, y1 } };
+    for (uint8_t i = 0; i < 3; i++) {
+        t[2 * i].flags = SPI_TRANS_USE_TXDATA;
+        t[2 * i].length = 8;
+        t[2 * i].tx_data[0] = cmds[i];
+        t[2 * i].user = DC_COMMAND;
+    }
+    for (uint8_t i = 0; i < 2; i++) {
+        spi_transaction_t& a = t[2 * i + 1];
+        a.flags = SPI_TRANS_USE_TXDATA;
+        a.length = 32;
+        a.tx_data[0] = args[i][0] >> 8;
+        a.tx_data[1] = args[i][0] & 0xFF;
+        a.tx_data[2] = args[i][1] >> 8;
+        a.tx_data[3] = args[i][1] & 0xFF;
+        a.user = DC_DATA;
+    }
+    size_t bytes = (size_t)w * TFT_BAND_ROWS * sizeof(uint16_t);
+    t[5].length = bytes * 8;
+    t[5].tx_buffer = _tx[buf];
+    t[5].user = DC_DATA;
+
+    for (uint8_t i = 0; i < TRANS_PER_PUSH; i++) {
+        if (spi_device_queue_trans(_dev, &t[i], portMAX_DELAY) == ESP_OK) {
+            _queued++;
+        }
+    }
+    _txSeq[buf] = _queued;
+    _lastFlushBytes += bytes;
+}
+
+// Results come back in queue order, so draining up to a buffer's last
+// transaction frees that buffer
+void DisplayST7789::waitTx(uint8_t buf) {
+    while ((int32_t)(_txSeq[buf] - _completed) > 0) {
+        spi_transaction_t* done = nullptr;
+        if (spi_device_get_trans_result(_dev, &done, portMAX_DELAY) != ESP_OK) break;
+        _completed++;
+    }
+}
+
+void DisplayST7789::waitIdle() {
+    waitTx(0);
+    waitTx(1);
+}
+
+void DisplayST7789::sendInit(uint8_t cmd, const uint8_t* data, uint8_t len) {
+    spi_transaction_t t = {};
+    t.length = 8;
+    t.flags = SPI_TRANS_USE_TXDATA;
+    t.tx_data[0] = cmd;
+    t.user = DC_COMMAND;
+    spi_device_polling_transmit(_dev, &t);
+
+    if (len == 0) return;
+    t = {};
+    t.length = len * 8;
+    t.tx_buffer = data;
+    t.user = DC_DATA;
+    spi_device_polling_transmit(_dev, &t);
+}
+
+void IRAM_ATTR DisplayST7789::preTransfer(spi_transaction_t* t) {
+    gpio_set_level((gpio_num_t)PIN_TFT_DC, t->user == DC_DATA ? 1 : 0);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <driver/spi_master.h>
+#include "config.h"
+#include "drivers/display_driver.h"
+
+// ST7789 240x240 colour TFT on the thermocouple SPI host (see
+// ThermocoupleBus; it must be started first).
+//
+// There is no full-screen framebuffer (240x240x16-bit is 115 KB). The
+// draw calls between clear() and flush() are recorded into a display
+// list instead. flush() replays the list into a single 240 x
+// TFT_BAND_ROWS sprite, one band at a time, hashes each 16-column
+// block and pushes only the span of blocks that changed since the
+// last frame. Pushes go out by DMA from two alternating buffers, so
+// the next band renders while the previous one is on the wire; flush()
+// returns with the last push still in flight.
+
+class DisplayST7789 : public DisplayDriver {
+public:
+    DisplayST7789();
+
+    void begin() override;
+    void clear() override;
+    void display() override;        // flush() + wait for the DMA to drain
+    void flush() override;
+    void setTextSize(uint8_t size) override;
+    void setCursor(int16_t x, int16_t y) override;
+    void print(const char* text) override;
+    void printf(const char* fmt, ...) override;
+    void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) override;
+    void drawRect(int16_t x, int16_t y, int16_t w, int16_t h) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h) override;
+    void drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2) override;
+    void setInvertText(bool invert) override;
+    void setColor(uint16_t rgb565) override;
+    void clearRect(int16_t x, int16_t y, int16_t w, int16_t h) override;
+    uint16_t width() override   { return TFT_WIDTH; }
+    uint16_t height() override  { return TFT_HEIGHT; }
+
+    // Retained-mode frames append to the list instead of clearing it;
+    // only bands touched since the last flush are replayed. Once the
+    // list is mostly full the caller is asked to clear() and redraw.
+    // Draws that no longer fit are dropped and a full redraw is then
+    // requested regardless, so nothing stays missing past the next
+    // frame. A full frame of any screen (four-channel MAIN is ~80 ops)
+    // stays under the 3/4 mark.
+    void markDirty(int16_t x, int16_t y, int16_t w, int16_t h) override;
+    bool wantsFullRedraw() override;
+
+    // Push every block on the next flush()
+    void invalidate()           { _hashValid = false; }
+
+    // Bytes of pixel data pushed by the last flush()
+    uint32_t getLastFlushBytes() const { return _lastFlushBytes; }
+
+private:
+    static const uint8_t BANDS = TFT_HEIGHT / TFT_BAND_ROWS;
+    static const uint8_t BLOCKS = TFT_WIDTH / TFT_BLOCK_COLS;
+    static const uint8_t MAX_OPS = 160;
+    static const uint16_t TEXT_POOL = 1024;
+    static const uint8_t TRANS_PER_PUSH = 6;    // CASET, RASET, RAMWR + args
+
+    enum Op : uint8_t { OP_SIZE, OP_CURSOR, OP_TEXT, OP_LINE, OP_RECT,
+                        OP_FILL, OP_TRI, OP_INVERT, OP_COLOR, OP_CLEAR };
+
+    struct DrawOp {
+        Op op;
+        int16_t a[6];
+        uint16_t text;              // Offset into _textPool (OP_TEXT)
+    };
+
+    // Display list
+    DrawOp _ops[MAX_OPS];
+    uint8_t _opCount;
+    char _textPool[TEXT_POOL];
+    uint16_t _textUsed;
+    bool _overflow;                 // Something was dropped since clear()
+    char _printBuf[64];
+
+    // Band sprite and per-block hashes of the frame on the panel
+    GFXcanvas16* _band;
+    uint32_t _hash[BANDS][BLOCKS];
+    bool _hashValid;
+    uint16_t _dirtyBands;           // Bit per band touched since the last flush()
+
+    // DMA
+    spi_device_handle_t _dev;
+    uint16_t* _tx[2];
+    spi_transaction_t _trans[2][TRANS_PER_PUSH];
+    uint32_t _txSeq[2];             // Transactions queued through each buffer
+    uint32_t _queued;
+    uint32_t _completed;
+    uint8_t _nextTx;
+    uint32_t _lastFlushBytes;
+    bool _ready;
+
+    DrawOp* addOp(Op op);
+    void replay(int16_t bandY);
+    void push(uint8_t band, uint8_t block0, uint8_t block1);
+    void waitTx(uint8_t buf);
+    void waitIdle();
+    void sendInit(uint8_t cmd, const uint8_t* data, uint8_t len);
+
+    static void IRAM_ATTR preTransfer(spi_transaction_t* t);
+};
@@ -1,10 +1,18 @@
 #include "encoder.h"
+#include "quadrature.h"
 
-volatile int32_t RotaryEncoder::_isrPos = 0;
-volatile uint32_t RotaryEncoder::_isrLastTime = 0;
+static_assert((ENCODER_RING_SIZE & (ENCODER_RING_SIZE - 1)) == 0,
+              "ENCODER_RING_SIZE must be a power of two");
+
+uint8_t RotaryEncoder::_quadState = Q_START;
+RotaryEncoder::Detent RotaryEncoder::_ring[ENCODER_RING_SIZE];
+std::atomic<uint8_t> RotaryEncoder::_head(0);
+std::atomic<uint8_t> RotaryEncoder::_tail(0);
+std::atomic<uint32_t> RotaryEncoder::_dropped(0);
+TaskHandle_t volatile RotaryEncoder::_notifyTask = nullptr;
 
 RotaryEncoder::RotaryEncoder()
-    : _encoderPos(0), _lastEncoderPos(0),
+    : _steps(0), _lastDetentMs(0), _lastDir(0),
       _buttonState(false), _lastButtonState(false),
       _buttonChangeTime(0), _buttonPressTime(0), _buttonHandled(false) {}
 
@@ -13,22 +21,33 @@ void RotaryEncoder::begin() {
     pinMode(PIN_ENC_DT, INPUT_PULLUP);
     pinMode(PIN_ENC_SW, INPUT_PULLUP);
 
-    attachInterrupt(digitalPinToInterrupt(PIN_ENC_CLK), isrHandler, FALLING);
+    _quadState = Q_START;
+    _head.store(0, std::memory_order_relaxed);
+    _tail.store(0, std::memory_order_relaxed);
 
-    _isrPos = 0;
-    _lastEncoderPos = 0;
+    attachInterrupt(digitalPinToInterrupt(PIN_ENC_CLK), isrHandler, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(PIN_ENC_DT), isrHandler, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(PIN_ENC_SW), buttonIsrHandler, CHANGE);
 }
 
 EncoderEvent RotaryEncoder::poll() {
-    // Rotation
-    noInterrupts();
-    int32_t currentPos = _isrPos;
-    interrupts();
-
-    if (currentPos != _lastEncoderPos) {
-        int32_t delta = currentPos - _lastEncoderPos;
-        _lastEncoderPos = currentPos;
-        return (delta > 0) ? EncoderEvent::ROTATE_CW : EncoderEvent::ROTATE_CCW;
+    // Rotation: fold the run of same-direction detents at the head of
+    // the ring, weighting each by how soon it followed the previous one
+    Detent d;
+    if (peekDetent(d)) {
+        int8_t dir = d.dir;
+        uint32_t steps = 0;
+        do {
+            uint8_t mult = 1;
+            if (dir == _lastDir) mult = accelFor(d.timeMs - _lastDetentMs);
+            steps += mult;
+            _lastDetentMs = d.timeMs;
+            _lastDir = dir;
+            popDetent();
+        } while (peekDetent(d) && d.dir == dir);
+
+        _steps = (uint16_t)min(steps, (uint32_t)UINT16_MAX);
+        return (dir > 0) ? EncoderEvent::ROTATE_CW : EncoderEvent::ROTATE_CCW;
     }
 
     // Button
@@ -63,11 +82,59 @@ EncoderEvent RotaryEncoder::poll() {
     return EncoderEvent::NONE;
 }
 
+bool RotaryEncoder::needsPoll() const {
+    return _buttonState || _lastButtonState ||
+           (millis() - _buttonChangeTime) <= BUTTON_DEBOUNCE_MS;
+}
+
+bool RotaryEncoder::peekDetent(Detent& d) const {
+    uint8_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+    d = _ring[tail & (ENCODER_RING_SIZE - 1)];
+    return true;
+}
+
+void RotaryEncoder::popDetent() {
+    uint8_t tail = _tail.load(std::memory_order_relaxed);
+    _tail.store((uint8_t)(tail + 1), std::memory_order_release);
+}
+
+uint8_t RotaryEncoder::accelFor(uint32_t intervalMs) const {
+    if (intervalMs < ENCODER_ACCEL_FAST_MS) return ENCODER_ACCEL_MAX;
+    if (intervalMs < ENCODER_ACCEL_MED_MS)  return (ENCODER_ACCEL_MAX + 1) / 2;
+    if (intervalMs < ENCODER_ACCEL_SLOW_MS) return 2;
+    return 1;
+}
+
 void IRAM_ATTR RotaryEncoder::isrHandler() {
-    uint32_t now = millis();
-    if ((now - _isrLastTime) < ENCODER_DEBOUNCE_MS) return;
-    _isrLastTime = now;
+    // Both phase pins share this handler: sample both and step the decoder
+    uint8_t pins = (digitalRead(PIN_ENC_DT) << 1) | digitalRead(PIN_ENC_CLK);
+    int8_t dir = quadStep(_quadState, pins);
+    if (!dir) return;
+
+    uint8_t head = _head.load(std::memory_order_relaxed);
+    if ((uint8_t)(head - _tail.load(std::memory_order_acquire)) >= ENCODER_RING_SIZE) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        Detent& slot = _ring[head & (ENCODER_RING_SIZE - 1)];
+        slot.timeMs = millis();
+        slot.dir = dir;
+        _head.store((uint8_t)(head + 1), std::memory_order_release);
+    }
+
+    notifyFromISR();
+}
+
+void IRAM_ATTR RotaryEncoder::buttonIsrHandler() {
+    // Debounced in poll(); the edge only wakes the UI task
+    notifyFromISR();
+}
+
+void IRAM_ATTR RotaryEncoder::notifyFromISR() {
+    TaskHandle_t task = _notifyTask;
+    if (!task) return;
 
-    if (digitalRead(PIN_ENC_DT)) _isrPos++;
-    else _isrPos--;
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(task, UI_NOTIFY_INPUT, eSetBits, &woken);
+    if (woken) portYIELD_FROM_ISR();
 }
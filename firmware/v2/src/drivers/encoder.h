@@ -1,6 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "config.h"
 
 enum class EncoderEvent : uint8_t {
@@ -11,16 +14,45 @@ enum class EncoderEvent : uint8_t {
     LONG_PRESS
 };
 
+// Both encoder phases interrupt on every edge and feed a quadrature
+// state machine; only a complete, valid cycle (one detent) comes out,
+// so contact bounce cancels itself without a time-based debounce.
+// Detents are timestamped into a lock-free single-producer ring that
+// poll() drains on the UI task.
 class RotaryEncoder {
 public:
     RotaryEncoder();
 
     void begin();
+
+    // One event per call. Queued detents in the same direction are
+    // folded into a single ROTATE_* event; getSteps() has its size.
     EncoderEvent poll();
 
+    // Accelerated step count behind the last ROTATE_* event: one per
+    // detent when turned slowly, up to ENCODER_ACCEL_MAX per detent
+    // when spun fast
+    uint16_t getSteps() const { return _steps; }
+
+    // Detents dropped because the ring was full (UI task stalled)
+    uint32_t getDroppedDetents() const { return _dropped.load(std::memory_order_relaxed); }
+
+    // Task to notify (UI_NOTIFY_INPUT) on every detent and button edge
+    void setNotifyTask(TaskHandle_t task) { _notifyTask = task; }
+
+    // True while the button is held or settling: debounce and long-press
+    // timing need poll() to keep running without further edges
+    bool needsPoll() const;
+
 private:
-    volatile int32_t _encoderPos;
-    int32_t _lastEncoderPos;
+    struct Detent {
+        uint32_t timeMs;
+        int8_t dir;                 // +1 CW, -1 CCW
+    };
+
+    uint16_t _steps;
+    uint32_t _lastDetentMs;
+    int8_t _lastDir;
 
     bool _buttonState;
     bool _lastButtonState;
@@ -28,7 +60,20 @@ private:
     uint32_t _buttonPressTime;
     bool _buttonHandled;
 
+    bool peekDetent(Detent& d) const;
+    void popDetent();
+    uint8_t accelFor(uint32_t intervalMs) const;
+
     static void IRAM_ATTR isrHandler();
-    static volatile int32_t _isrPos;
-    static volatile uint32_t _isrLastTime;
+    static void IRAM_ATTR buttonIsrHandler();
+    static void IRAM_ATTR notifyFromISR();
+
+    // ISR state. The ISR is the only writer of _head, poll() the only
+    // writer of _tail; slots are published with release/acquire.
+    static uint8_t _quadState;
+    static Detent _ring[ENCODER_RING_SIZE];
+    static std::atomic<uint8_t> _head;
+    static std::atomic<uint8_t> _tail;
+    static std::atomic<uint32_t> _dropped;
+    static TaskHandle_t volatile _notifyTask;
 };
@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+
+// Quadrature decoder. Inputs are (DT << 1) | CLK, both pulled up, so a
+// detent rests at 0b11. CLK leading (11 -> 10 -> 00 -> 01 -> 11) is CW.
+// A detent is only emitted on the return to 11 from the last state of a
+// full cycle; bounce on either line just walks back and forth.
+enum : uint8_t {
+    Q_START, Q_CW_BEGIN, Q_CW_NEXT, Q_CW_FINAL,
+    Q_CCW_BEGIN, Q_CCW_NEXT, Q_CCW_FINAL,
+    Q_EMIT_CW = 0x10, Q_EMIT_CCW = 0x20
+};
+
+static const uint8_t DRAM_ATTR QUAD_TABLE[7][4] = {
+    //  00          01           10           11
+    { Q_START,    Q_CCW_BEGIN, Q_CW_BEGIN,  Q_START },               // START
+    { Q_CW_NEXT,  Q_START,     Q_CW_BEGIN,  Q_START },               // CW_BEGIN (10)
+    { Q_CW_NEXT,  Q_CW_FINAL,  Q_CW_BEGIN,  Q_START },               // CW_NEXT (00)
+    { Q_CW_NEXT,  Q_CW_FINAL,  Q_START,     Q_START | Q_EMIT_CW },   // CW_FINAL (01)
+    { Q_CCW_NEXT, Q_CCW_BEGIN, Q_START,     Q_START },               // CCW_BEGIN (01)
+    { Q_CCW_NEXT, Q_CCW_BEGIN, Q_CCW_FINAL, Q_START },               // CCW_NEXT (00)
+    { Q_CCW_NEXT, Q_START,     Q_CCW_FINAL, Q_START | Q_EMIT_CCW },  // CCW_FINAL (10)
+};
+
+// Advance `state` by one pin sample; +1 / -1 when that completes a CW /
+// CCW detent, else 0. Called from the encoder ISR.
+inline int8_t IRAM_ATTR quadStep(uint8_t& state, uint8_t pins) {
+    uint8_t next = QUAD_TABLE[state & 0x0F][pins & 0x03];
+    state = next & 0x0F;
+    if (next & Q_EMIT_CW) return 1;
+    if (next & Q_EMIT_CCW) return -1;
+    return 0;
+}
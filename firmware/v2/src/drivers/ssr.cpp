@@ -1,47 +1,242 @@
 #include "ssr.h"
 
+bool SSRDriver::_timerReady = false;
+SSRDriver* SSRDriver::_all[NUM_CHANNELS] = {};
+volatile bool SSRDriver::_latchedOff = false;
+SSRDriver* SSRDriver::_burst[NUM_CHANNELS] = {};
+volatile uint8_t SSRDriver::_burstMaxOn = NUM_CHANNELS;
+bool SSRDriver::_halfCycleRunning = false;
+esp_timer_handle_t SSRDriver::_halfCycleTimer = nullptr;
+
 SSRDriver::SSRDriver()
-    : _pin(0), _dutyCycle(0), _state(false), _stuck(false),
-      _periodStart(0), _stuckCheckStart(0), _avgTempDelta(0), _stuckSamples(0) {}
+    : _pin(0), _index(0), _mode(SSRMode::TIME_PROPORTIONAL),
+      _channel(LEDC_CHANNEL_0), _dutyCycle(0),
+      _requestTicks(0), _dutyTicks(0), _hpoint(0),
+      _enabled(false), _scheduled(false), _stuck(false),
+      _burstLevel(0), _burstAcc(0), _burstOn(false),
+      _stuckCheckStart(0), _avgTempDelta(0), _stuckSamples(0) {}
+
+void SSRDriver::configureTimer() {
+    if (_timerReady) return;
+
+    // 1 Hz is below what APB can divide down to at 14 bits; REF_TICK
+    // (1 MHz) gives a divider of ~61.
+    ledc_timer_config_t t = {};
+    t.speed_mode = SSR_LEDC_MODE;
+    t.duty_resolution = (ledc_timer_bit_t)SSR_LEDC_RES_BITS;
+    t.timer_num = SSR_LEDC_TIMER;
+    t.freq_hz = 1000 / SSR_PERIOD_MS;
+    t.clk_cfg = LEDC_USE_REF_TICK;
+
+    if (ledc_timer_config(&t) != ESP_OK) {
+        Serial.println(F("[SSR] LEDC timer config failed"));
+        return;
+    }
+    _timerReady = true;
+}
 
-void SSRDriver::begin(uint8_t pin) {
+void SSRDriver::begin(uint8_t pin, uint8_t index, SSRMode mode) {
     _pin = pin;
+    _index = index;
+    _channel = (ledc_channel_t)(SSR_LEDC_CHANNEL_BASE + index);
+
+    // Hold the pin low until LEDC or the burst ISR takes it over
     pinMode(_pin, OUTPUT);
+    digitalWrite(_pin, LOW);
+
+    configureTimer();
+
+    _mode = SSRMode::TIME_PROPORTIONAL;
+    attachLEDC();
     forceOff();
-    _periodStart = millis();
+    setMode(mode);
+    if (_index < NUM_CHANNELS) _all[_index] = this;
 }
 
-void SSRDriver::setDutyCycle(float percent) {
-    _dutyCycle = constrain(percent, 0.0f, 100.0f);
+void SSRDriver::attachLEDC() {
+    ledc_channel_config_t c = {};
+    c.gpio_num = _pin;
+    c.speed_mode = SSR_LEDC_MODE;
+    c.channel = _channel;
+    c.intr_type = LEDC_INTR_DISABLE;
+    c.timer_sel = SSR_LEDC_TIMER;
+    c.duty = 0;
+    c.hpoint = 0;
+    ledc_channel_config(&c);
+    _dutyTicks = 0;
+    _hpoint = 0;
+    _enabled = false;
 }
 
-void SSRDriver::update() {
-    uint32_t now = millis();
-    uint32_t elapsed = now - _periodStart;
+void SSRDriver::setMode(SSRMode mode) {
+    if (mode == _mode || _index >= NUM_CHANNELS) return;
+
+    forceOff();
+
+    if (mode == SSRMode::BURST_FIRE) {
+        // Hand the pin back to plain GPIO for the half-cycle ISR
+        ledc_stop(SSR_LEDC_MODE, _channel, 0);
+        pinMatrixOutDetach(_pin, false, false);
+        pinMode(_pin, OUTPUT);
+        digitalWrite(_pin, LOW);
 
-    if (elapsed >= SSR_PERIOD_MS) {
-        _periodStart = now;
-        elapsed = 0;
+        // Offset each channel's accumulator so equal duties interleave
+        _burstAcc = (uint16_t)((uint32_t)_index * SSR_BURST_SCALE / NUM_CHANNELS);
+        _burstOn = false;
+        _burstLevel = 0;
+        _mode = mode;
+        _burst[_index] = this;
+        startHalfCycleSource();
+    } else {
+        _burstLevel = 0;
+        _burst[_index] = nullptr;
+        digitalWrite(_pin, LOW);
+        _mode = mode;
+        attachLEDC();
     }
+}
+
+void SSRDriver::setDutyCycle(float percent) {
+    _dutyCycle = constrain(percent, 0.0f, 100.0f);
 
     uint32_t onTimeMs = (uint32_t)(_dutyCycle / 100.0f * SSR_PERIOD_MS);
-    if (onTimeMs < SSR_MIN_ON_MS) onTimeMs = 0;
+    bool truncate = (_mode == SSRMode::TIME_PROPORTIONAL && onTimeMs < SSR_MIN_ON_MS);
+    _requestTicks = truncate ? 0 : (uint32_t)(_dutyCycle / 100.0f * SSR_LEDC_FULL + 0.5f);
 
-    bool shouldBeOn = (elapsed < onTimeMs);
+    if (!_scheduled) applyWindow(0, _requestTicks);
+}
 
-    if (shouldBeOn && !_state) {
-        digitalWrite(_pin, HIGH);
-        _state = true;
-    } else if (!shouldBeOn && _state) {
-        digitalWrite(_pin, LOW);
-        _state = false;
+void SSRDriver::applyWindow(uint32_t hpoint, uint32_t ticks) {
+    if (_latchedOff) return;
+    if (ticks > SSR_LEDC_FULL) ticks = SSR_LEDC_FULL;
+
+    if (_mode == SSRMode::BURST_FIRE) {
+        _dutyTicks = ticks;
+        _hpoint = 0;
+        _burstLevel = (uint16_t)((uint64_t)ticks * SSR_BURST_SCALE / SSR_LEDC_FULL);
+        _enabled = true;
+        if (_latchedOff) forceOff();    // forceAllOff() preempted us
+        return;
     }
+
+    // Keep the window inside the frame; LEDC does not wrap lpoint
+    if (hpoint + ticks > SSR_LEDC_FULL) hpoint = SSR_LEDC_FULL - ticks;
+
+    if (_enabled && ticks == _dutyTicks && hpoint == _hpoint) return;
+
+    _dutyTicks = ticks;
+    _hpoint = hpoint;
+    ledc_set_duty_with_hpoint(SSR_LEDC_MODE, _channel, _dutyTicks, _hpoint);
+    ledc_update_duty(SSR_LEDC_MODE, _channel);
+    _enabled = true;
+    if (_latchedOff) forceOff();        // forceAllOff() preempted us
 }
 
 void SSRDriver::forceOff() {
-    digitalWrite(_pin, LOW);
-    _state = false;
     _dutyCycle = 0;
+    _requestTicks = 0;
+
+    if (_mode == SSRMode::BURST_FIRE) {
+        _burstLevel = 0;        // ISR also clears its accumulator
+        digitalWrite(_pin, LOW);
+        _dutyTicks = 0;
+        _enabled = false;
+        return;
+    }
+
+    if (!_enabled && _dutyTicks == 0) return;
+
+    // ledc_stop() drops the output now; a plain duty change would
+    // only land at the end of the current period.
+    ledc_stop(SSR_LEDC_MODE, _channel, 0);
+    ledc_set_duty(SSR_LEDC_MODE, _channel, 0);
+    _dutyTicks = 0;
+    _enabled = false;
+}
+
+uint32_t SSRDriver::getOnTimeUs() const {
+    return (uint32_t)(((uint64_t)_dutyTicks * SSR_PERIOD_MS * 1000ULL) / SSR_LEDC_FULL);
+}
+
+float SSRDriver::getAppliedDuty() const {
+    if (!_enabled) return 0.0f;
+    if (_mode == SSRMode::BURST_FIRE) return (float)_burstLevel / SSR_BURST_SCALE;
+    return (float)_dutyTicks / SSR_LEDC_FULL;
+}
+
+void SSRDriver::forceAllOff() {
+    _latchedOff = true;
+    for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+        if (_all[i]) _all[i]->forceOff();
+    }
+    // Raw pins too, in case a driver was never begun
+    for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+        ledc_stop(SSR_LEDC_MODE, (ledc_channel_t)(SSR_LEDC_CHANNEL_BASE + i), 0);
+        digitalWrite(SSR_PINS[i], LOW);
+    }
+}
+
+// --- Burst-fire half-cycle source ---
+
+void SSRDriver::startHalfCycleSource() {
+    if (_halfCycleRunning) return;
+
+    if (PIN_ZERO_CROSS >= 0) {
+        // Zero-cross detector pulses once per half-cycle
+        pinMode(PIN_ZERO_CROSS, INPUT);
+        attachInterrupt(digitalPinToInterrupt(PIN_ZERO_CROSS), onHalfCycle, RISING);
+    } else {
+        // No ZC input: free-run at the nominal half-cycle rate and let
+        // zero-crossing SSRs align the actual switching.
+        esp_timer_create_args_t args = {};
+        args.callback = onHalfCycleTimer;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "ssr_burst";
+        if (esp_timer_create(&args, &_halfCycleTimer) != ESP_OK) {
+            Serial.println(F("[SSR] Half-cycle timer create failed"));
+            return;
+        }
+        esp_timer_start_periodic(_halfCycleTimer, 1000000ULL / (2 * MAINS_FREQ_HZ));
+    }
+    _halfCycleRunning = true;
+}
+
+void SSRDriver::onHalfCycleTimer(void* arg) {
+    onHalfCycle();
+}
+
+void IRAM_ATTR SSRDriver::onHalfCycle() {
+    static uint8_t rr = 0;     // Rotate priority when the cap defers pulses
+    uint8_t on = 0;
+
+    for (uint8_t k = 0; k < NUM_CHANNELS; k++) {
+        uint8_t i = (rr + k) % NUM_CHANNELS;
+        SSRDriver* d = _burst[i];
+        if (!d) continue;
+
+        uint16_t level = d->_burstLevel;
+        bool fire = false;
+
+        if (level == 0) {
+            d->_burstAcc = 0;
+        } else {
+            uint32_t acc = (uint32_t)d->_burstAcc + level;
+            if (acc >= SSR_BURST_SCALE && on < _burstMaxOn) {
+                fire = true;
+                acc -= SSR_BURST_SCALE;
+            }
+            // Bound the backlog from deferred pulses
+            if (acc > 2 * SSR_BURST_SCALE) acc = 2 * SSR_BURST_SCALE;
+            d->_burstAcc = (uint16_t)acc;
+        }
+
+        if (fire) on++;
+        if (fire != d->_burstOn) {
+            digitalWrite(d->_pin, fire ? HIGH : LOW);
+            d->_burstOn = fire;
+        }
+    }
+    rr = (rr + 1) % NUM_CHANNELS;
 }
 
 void SSRDriver::reportTempChange(float deltaPerSecond) {
@@ -1,39 +1,105 @@
 #pragma once
 
 #include <Arduino.h>
+#include <driver/ledc.h>
+#include <esp_timer.h>
 #include "config.h"
 
-// SSR driver with time-proportioning and stuck detection.
-// The SSR switches AC power in a slow on/off cycle (1s period)
-// with duty cycle controlled by PID output percentage.
+// SSR driver with selectable modulation and stuck detection.
+//
+// TIME_PROPORTIONAL: slow on/off cycle (1s period) with duty cycle
+// controlled by PID output percentage. Edges are generated by the LEDC
+// peripheral, so the on-time has ~61 us resolution regardless of when
+// the PID task runs; a new duty takes effect at the next period
+// boundary (glitch-free). When an SSRScheduler owns the driver,
+// setDutyCycle() only records the request and the scheduler places the
+// on-window in the frame.
+//
+// BURST_FIRE: whole mains half-cycles, spread evenly by a first-order
+// sigma-delta (error accumulator) evaluated once per half-cycle, from
+// the zero-cross input if PIN_ZERO_CROSS is wired or from a free-running
+// esp_timer otherwise. No minimum on-time truncation: 1% output is one
+// half-cycle in every hundred.
+
+enum class SSRMode : uint8_t {
+    TIME_PROPORTIONAL,
+    BURST_FIRE
+};
 
 class SSRDriver {
 public:
     SSRDriver();
 
-    void begin(uint8_t pin);
-    void setDutyCycle(float percent);   // 0-100%
-    void update();                      // Call in PID loop
-    void forceOff();
+    void begin(uint8_t pin, uint8_t index, SSRMode mode = SSR_MODULATION_DEFAULT);
+    void setMode(SSRMode mode);
+    SSRMode getMode() const { return _mode; }
+
+    void setDutyCycle(float percent);   // 0-100%, latched next period
+    void forceOff();                    // Immediate, mid-period
+
+    // Scheduler hooks: window [hpoint, hpoint + ticks) within the frame.
+    // In burst-fire mode only the length is used (as the density).
+    void setScheduled(bool scheduled)   { _scheduled = scheduled; }
+    uint32_t getRequestedTicks() const  { return _requestTicks; }
+    void applyWindow(uint32_t hpoint, uint32_t ticks);
+    uint32_t getPhaseTicks() const      { return _hpoint; }
 
-    bool isOn() const       { return _state; }
     float getDutyCycle() const { return _dutyCycle; }
+    uint32_t getOnTimeUs() const;
+    // Fraction of each period the output really conducts: after min-on
+    // truncation, scheduling and burst quantisation, 0 when stopped
+    float getAppliedDuty() const;
+    bool isOn() const       { return getAppliedDuty() > 0.0f; }     // Conducts some of each period
     uint8_t getPin() const  { return _pin; }
 
     // Stuck detection (requires external temp feedback)
     void reportTempChange(float deltaPerSecond);
     bool isStuck() const    { return _stuck; }
 
+    // Drop every SSR output low immediately (safety path). Latches:
+    // applyWindow() does nothing until rearm() is called.
+    static void forceAllOff();
+    static void rearm()                 { _latchedOff = false; }
+    static bool isLatchedOff()          { return _latchedOff; }
+
+    // Cap on burst-fire channels conducting in the same half-cycle;
+    // a deferred pulse fires on the next half-cycle instead.
+    static void setBurstConcurrency(uint8_t maxOn) { _burstMaxOn = maxOn; }
+
 private:
     uint8_t _pin;
+    uint8_t _index;
+    SSRMode _mode;
+    ledc_channel_t _channel;
     float _dutyCycle;
-    bool _state;
+    uint32_t _requestTicks;
+    uint32_t _dutyTicks;
+    uint32_t _hpoint;
+    bool _enabled;
+    bool _scheduled;
     bool _stuck;
 
-    uint32_t _periodStart;
+    // Burst-fire state (level written by PID task, rest ISR-owned)
+    volatile uint16_t _burstLevel;      // 0..SSR_BURST_SCALE
+    uint16_t _burstAcc;
+    bool _burstOn;
 
     // Stuck detection
     uint32_t _stuckCheckStart;
     float _avgTempDelta;
     uint8_t _stuckSamples;
+
+    static bool _timerReady;
+    static void configureTimer();
+    void attachLEDC();
+
+    static SSRDriver* _all[NUM_CHANNELS];       // Every begun driver, by index
+    static volatile bool _latchedOff;
+    static SSRDriver* _burst[NUM_CHANNELS];
+    static volatile uint8_t _burstMaxOn;
+    static bool _halfCycleRunning;
+    static esp_timer_handle_t _halfCycleTimer;
+    static void startHalfCycleSource();
+    static void IRAM_ATTR onHalfCycle();
+    static void onHalfCycleTimer(void* arg);
 };
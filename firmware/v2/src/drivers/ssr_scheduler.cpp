@@ -0,0 +1,152 @@
+#include "ssr_scheduler.h"
+
+SSRScheduler::SSRScheduler() : _budgetA(SSR_CURRENT_BUDGET_A), _scale(1.0f) {
+    for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+        _drivers[i] = nullptr;
+        _granted[i] = 0;
+        _coilA[i] = SSR_COIL_CURRENT_A;
+    }
+}
+
+void SSRScheduler::attach(uint8_t ch, SSRDriver* driver, float coilCurrentA) {
+    if (ch >= NUM_CHANNELS || driver == nullptr) return;
+    _drivers[ch] = driver;
+    _coilA[ch] = coilCurrentA > 0.0f ? coilCurrentA : SSR_COIL_CURRENT_A;
+    driver->setScheduled(true);
+}
+
+uint8_t SSRScheduler::getMaxConcurrent() const {
+    uint8_t attached = 0;
+    float maxCoil = 0.0f;
+    for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+        if (!_drivers[i]) continue;
+        attached++;
+        if (_coilA[i] > maxCoil) maxCoil = _coilA[i];
+    }
+    if (attached == 0) return 0;
+    if (_budgetA <= 0.0f || maxCoil <= 0.0f) return attached;
+
+    // Sized for the worst-case coil; a budget below one coil still
+    // allows a single coil at a time rather than none.
+    uint8_t lanes = (uint8_t)(_budgetA / maxCoil);
+    if (lanes < 1) lanes = 1;
+    if (lanes > attached) lanes = attached;
+    return lanes;
+}
+
+void SSRScheduler::update() {
+    uint32_t request[NUM_CHANNELS];
+    uint32_t offset[NUM_CHANNELS];
+    uint32_t granted[NUM_CHANNELS];
+
+    for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+        request[i] = _drivers[i] ? _drivers[i]->getRequestedTicks() : 0;
+    }
+
+    uint8_t maxOn = getMaxConcurrent();
+    _scale = plan(request, NUM_CHANNELS, maxOn, offset, granted);
+    SSRDriver::setBurstConcurrency(maxOn > 0 ? maxOn : NUM_CHANNELS);
+
+    for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+        _granted[i] = _drivers[i] ? granted[i] : 0;
+        if (_drivers[i]) _drivers[i]->applyWindow(offset[i], granted[i]);
+    }
+}
+
+float SSRScheduler::plan(const uint32_t* request, uint8_t count, uint8_t maxLanes,
+                         uint32_t* offset, uint32_t* granted) {
+    if (count > MAX_WINDOWS) count = MAX_WINDOWS;
+    if (maxLanes < 1) maxLanes = 1;
+    if (maxLanes > count) maxLanes = count > 0 ? count : 1;
+
+    // Proportional cut when total on-time exceeds lane capacity
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        granted[i] = min(request[i], (uint32_t)SSR_LEDC_FULL);
+        offset[i] = 0;
+        total += granted[i];
+    }
+
+    uint32_t capacity = (uint32_t)maxLanes * SSR_LEDC_FULL;
+    float scale = 1.0f;
+    if (total > capacity) {
+        scale = (float)capacity / (float)total;
+        total = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            granted[i] = (uint32_t)((float)granted[i] * scale);
+            total += granted[i];
+        }
+    }
+
+    // Longest window first (count <= 4, insertion sort is fine)
+    uint8_t order[MAX_WINDOWS];
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t j = i;
+        while (j > 0 && granted[order[j - 1]] < granted[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    // Open only as many lanes as the total needs; each window goes to
+    // the emptiest lane, so with one lane they sit back to back.
+    // offset[] holds the position within the lane until lanes are placed.
+    uint8_t lanes = (uint8_t)((total + SSR_LEDC_FULL - 1) / SSR_LEDC_FULL);
+    if (lanes < 1) lanes = 1;
+    if (lanes > maxLanes) lanes = maxLanes;
+
+    uint32_t fill[MAX_WINDOWS] = {};
+    uint8_t laneOf[MAX_WINDOWS] = {};
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t i = order[k];
+        if (granted[i] == 0) continue;
+
+        uint8_t best = 0;
+        for (uint8_t l = 1; l < lanes; l++) {
+            if (fill[l] < fill[best]) best = l;
+        }
+        if (fill[best] + granted[i] > SSR_LEDC_FULL && lanes < maxLanes) best = lanes++;
+
+        laneOf[i] = best;
+        fill[best] += granted[i];
+    }
+
+    // Fragmentation (e.g. 3 x 66% in 2 lanes fits by total but no two
+    // windows share a lane): shrink every window of an overfull lane by
+    // the same factor, then lay the lanes out back to back.
+    uint32_t pos[MAX_WINDOWS] = {};
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t i = order[k];
+        if (granted[i] == 0) continue;
+        uint8_t l = laneOf[i];
+        if (fill[l] > SSR_LEDC_FULL) {
+            float laneScale = (float)SSR_LEDC_FULL / (float)fill[l];
+            if (laneScale < scale) scale = laneScale;
+            granted[i] = (uint32_t)((uint64_t)granted[i] * SSR_LEDC_FULL / fill[l]);
+        }
+        offset[i] = pos[l];
+        pos[l] += granted[i];
+    }
+    for (uint8_t l = 0; l < lanes; l++) fill[l] = pos[l];
+
+    // LEDC cannot wrap a window past the frame end, so instead of a
+    // common origin each lane gets an even share of its own slack:
+    // lane 0 starts at 0, the last lane ends at SSR_LEDC_FULL.
+    if (lanes > 1) {
+        uint32_t origin[MAX_WINDOWS];
+        for (uint8_t l = 0; l < lanes; l++) {
+            origin[l] = (SSR_LEDC_FULL - fill[l]) * l / (lanes - 1);
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            if (granted[i] > 0) offset[i] += origin[laneOf[i]];
+        }
+    }
+
+    return scale;
+}
+
+float SSRScheduler::getGranted(uint8_t ch) const {
+    if (ch >= NUM_CHANNELS) return 0.0f;
+    return 100.0f * _granted[ch] / SSR_LEDC_FULL;
+}
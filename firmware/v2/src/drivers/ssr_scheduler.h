@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "drivers/ssr.h"
+
+// Multi-channel SSR scheduler.
+// All SSR LEDC channels share one timer, so without coordination every
+// coil turns on at the start of the SSR_PERIOD_MS frame. The scheduler
+// places each channel's on-window at a different offset (LEDC hpoint),
+// packing windows back to back into as few parallel "lanes" as the
+// total on-time needs. The number of lanes is capped by the current
+// budget, so at most that many coils ever conduct at once; if the
+// requests do not fit, every channel's on-time is scaled down by the
+// same factor. Windows that fit by total but not lane by lane are cut
+// per lane, so getGranted() reports what each channel really gets.
+// Lanes are spread across the frame (first left-aligned, last
+// right-aligned, the rest evenly between), so lanes that are not full
+// overlap as little as the non-wrapping LEDC window allows. Burst-fire
+// channels have no window to place; for them the same lane count caps
+// how many fire in any one half-cycle.
+
+class SSRScheduler {
+public:
+    SSRScheduler();
+
+    void attach(uint8_t ch, SSRDriver* driver, float coilCurrentA = SSR_COIL_CURRENT_A);
+    void setCurrentBudget(float amps)   { _budgetA = amps; }    // 0 = unlimited
+    float getCurrentBudget() const      { return _budgetA; }
+
+    // Call once per PID tick after channels have published their duty
+    void update();
+
+    uint8_t getMaxConcurrent() const;
+    float getScale() const              { return _scale; }
+    float getGranted(uint8_t ch) const; // % of the frame after any cut
+
+    // Pack requested on-times (ticks) into at most maxLanes lanes of
+    // SSR_LEDC_FULL ticks. Writes each window's offset and granted
+    // length, and returns the smallest factor any window was cut by
+    // (1.0 = every request granted in full).
+    static float plan(const uint32_t* request, uint8_t count, uint8_t maxLanes,
+                      uint32_t* offset, uint32_t* granted);
+
+    static const uint8_t MAX_WINDOWS = 4;   // plan() scratch size
+
+private:
+    SSRDriver* _drivers[NUM_CHANNELS];
+    float _coilA[NUM_CHANNELS];
+    float _budgetA;
+    float _scale;
+    uint32_t _granted[NUM_CHANNELS];    // Ticks, last update()
+};
+
+static_assert(NUM_CHANNELS <= SSRScheduler::MAX_WINDOWS, "SSRScheduler::plan() scratch too small");
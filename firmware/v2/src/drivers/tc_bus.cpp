@@ -0,0 +1,93 @@
+#include "tc_bus.h"
+
+ThermocoupleBus::ThermocoupleBus() : _count(0), _ready(false) {
+    memset(_devices, 0, sizeof(_devices));
+    memset(_trans, 0, sizeof(_trans));
+    memset(_inFlight, 0, sizeof(_inFlight));
+}
+
+bool ThermocoupleBus::begin(const uint8_t* csPins, uint8_t count) {
+    _count = min(count, (uint8_t)NUM_CHANNELS);
+
+    spi_bus_config_t bus = {};
+    bus.mosi_io_num = PIN_SPI_MOSI;     // Unused by MAX31855, shared with TFT
+    bus.miso_io_num = PIN_SPI_MISO;
+    bus.sclk_io_num = PIN_SPI_SCK;
+    bus.quadwp_io_num = -1;
+    bus.quadhd_io_num = -1;
+    bus.max_transfer_sz = TFT_WIDTH * 2 * TFT_BAND_ROWS;  // One ST7789 band
+
+    esp_err_t err = spi_bus_initialize(TC_SPI_HOST, &bus, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) {  // INVALID_STATE = already up
+        Serial.printf("[TC] SPI bus init failed (%d)\n", err);
+        return false;
+    }
+
+    for (uint8_t i = 0; i < _count; i++) {
+        spi_device_interface_config_t dev = {};
+        dev.mode = 0;
+        dev.clock_speed_hz = TC_SPI_CLOCK_HZ;
+        dev.spics_io_num = csPins[i];
+        dev.cs_ena_pretrans = 1;        // MAX31855 needs t_CSS >= 100 ns
+        dev.queue_size = 1;
+
+        err = spi_bus_add_device(TC_SPI_HOST, &dev, &_devices[i]);
+        if (err != ESP_OK) {
+            Serial.printf("[TC] CH%d add device failed (%d)\n", i + 1, err);
+            return false;
+        }
+
+        _trans[i].flags = SPI_TRANS_USE_RXDATA;
+        _trans[i].length = 32;
+        _trans[i].rxlength = 32;
+    }
+
+    _ready = true;
+
+    // Let the first conversion complete, then prime sensor state
+    delay(100);
+    poll();
+    return true;
+}
+
+void ThermocoupleBus::poll() {
+    if (!_ready) return;
+
+    // Queue every channel first so the driver runs them back to back
+    // from its ISR, then collect in order.
+    bool queued[NUM_CHANNELS];
+    for (uint8_t i = 0; i < _count; i++) {
+        queued[i] = false;
+        if (_inFlight[i]) {
+            // Drain last tick's late transaction; its frame is stale
+            spi_transaction_t* stale = nullptr;
+            if (spi_device_get_trans_result(_devices[i], &stale, 0) != ESP_OK) continue;
+            _inFlight[i] = false;
+        }
+        queued[i] = (spi_device_queue_trans(_devices[i], &_trans[i], 0) == ESP_OK);
+    }
+
+    for (uint8_t i = 0; i < _count; i++) {
+        if (!queued[i]) {
+            _sensors[i].processFrame(0);    // Counts as a read error
+            continue;
+        }
+
+        spi_transaction_t* done = nullptr;
+        if (spi_device_get_trans_result(_devices[i], &done, pdMS_TO_TICKS(10)) != ESP_OK) {
+            _inFlight[i] = true;            // Driver still owns _trans[i]
+            _sensors[i].processFrame(0);
+            continue;
+        }
+
+        const uint8_t* rx = done->rx_data;
+        uint32_t frame = ((uint32_t)rx[0] << 24) | ((uint32_t)rx[1] << 16) |
+                         ((uint32_t)rx[2] << 8)  |  (uint32_t)rx[3];
+        _sensors[i].processFrame(frame);
+    }
+}
+
+Thermocouple* ThermocoupleBus::getSensor(uint8_t ch) {
+    if (ch >= NUM_CHANNELS) return nullptr;
+    return &_sensors[ch];
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+#include <driver/spi_master.h>
+#include "config.h"
+#include "drivers/thermocouple.h"
+
+// Hardware SPI bus manager for the MAX31855 thermocouples.
+// All channels share SCK/MISO on the ESP32 VSPI peripheral; each
+// MAX31855 is a separate device with a hardware-driven CS line.
+// poll() queues one 32-bit transaction per channel, blocks while the
+// peripheral clocks them out back to back, then hands each frame to
+// the matching Thermocouple for decoding. A transaction that times out
+// stays owned by the driver; its slot is not reused until a later poll()
+// has collected (and discarded) the stale result.
+
+class ThermocoupleBus {
+public:
+    ThermocoupleBus();
+
+    bool begin(const uint8_t* csPins, uint8_t count);
+    void poll();                        // Call once per PID tick
+
+    Thermocouple* getSensor(uint8_t ch);
+    uint8_t getCount() const            { return _count; }
+    bool isReady() const                { return _ready; }
+    spi_host_device_t getHost() const   { return TC_SPI_HOST; }
+
+private:
+    Thermocouple _sensors[NUM_CHANNELS];
+    spi_device_handle_t _devices[NUM_CHANNELS];
+    spi_transaction_t _trans[NUM_CHANNELS];
+    bool _inFlight[NUM_CHANNELS];       // Timed out, result not yet collected
+    uint8_t _count;
+    bool _ready;
+};
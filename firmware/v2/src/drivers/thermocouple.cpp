@@ -1,67 +1,94 @@
 #include "thermocouple.h"
 
 Thermocouple::Thermocouple()
-    : _sensor(nullptr), _tempF(0), _tempC(0), _coldJunctionC(0),
+    : _csPin(0), _lastFrame(0), _tempF(0), _tempFQ16(0), _tempC(0), _coldJunctionC(0),
       _status(TCStatus::NOT_READY), _consecutiveErrors(0),
       _lastReadTime(0), _initialized(false) {}
 
-Thermocouple::~Thermocouple() {
-    if (_sensor) {
-        delete _sensor;
-        _sensor = nullptr;
-    }
-}
-
 void Thermocouple::begin(uint8_t csPin) {
-    if (_sensor) delete _sensor;
+    _csPin = csPin;
 
-    _sensor = new Adafruit_MAX31855(PIN_SPI_SCK, csPin, PIN_SPI_MISO);
-    if (!_sensor->begin()) {
-        _status = TCStatus::READ_ERROR;
-        return;
-    }
+    pinMode(_csPin, OUTPUT);
+    digitalWrite(_csPin, HIGH);
+    pinMode(PIN_SPI_SCK, OUTPUT);
+    digitalWrite(PIN_SPI_SCK, LOW);
+    pinMode(PIN_SPI_MISO, INPUT);
 
     _status = TCStatus::NOT_READY;
     _initialized = true;
     _lastReadTime = millis();
 
-    // Initial settling read
+    // Initial settling read (first conversion after power-up is stale)
     delay(100);
-    _sensor->readCelsius();
+    readFrame();
 }
 
 void Thermocouple::update() {
-    if (!_initialized || !_sensor) return;
+    if (!_initialized) return;
 
     uint32_t now = millis();
     if ((now - _lastReadTime) < TC_READ_INTERVAL_MS) return;
     _lastReadTime = now;
 
-    double tempC = _sensor->readCelsius();
-    uint8_t fault = _sensor->readError();
+    processFrame(readFrame());
+}
+
+void Thermocouple::processFrame(uint32_t raw) {
+    _lastFrame = raw;
 
-    if (fault) {
+    // All-zero / all-one frames mean nothing drove MISO (chip missing)
+    if (raw == 0 || raw == 0xFFFFFFFFUL) {
         _consecutiveErrors++;
-        if (fault & MAX31855_FAULT_OPEN)        _status = TCStatus::OPEN_CIRCUIT;
-        else if (fault & MAX31855_FAULT_SHORT_GND) _status = TCStatus::SHORT_GND;
-        else if (fault & MAX31855_FAULT_SHORT_VCC) _status = TCStatus::SHORT_VCC;
-        else                                    _status = TCStatus::READ_ERROR;
+        _status = TCStatus::READ_ERROR;
         return;
     }
 
-    if (isnan(tempC)) {
+    if (raw & MAX31855_FAULT_BIT) {
+        uint8_t fault = raw & 0x07;
         _consecutiveErrors++;
-        _status = TCStatus::READ_ERROR;
+        if (fault & MAX31855_FAULT_OPEN)           _status = TCStatus::OPEN_CIRCUIT;
+        else if (fault & MAX31855_FAULT_SHORT_GND) _status = TCStatus::SHORT_GND;
+        else if (fault & MAX31855_FAULT_SHORT_VCC) _status = TCStatus::SHORT_VCC;
+        else                                       _status = TCStatus::READ_ERROR;
         return;
     }
 
+    // Arithmetic shifts sign-extend the 14- and 12-bit fields
+    int32_t tcRaw = (int32_t)raw >> 18;
+    int32_t cjRaw = (int32_t)(raw << 16) >> 20;
+
     _consecutiveErrors = 0;
-    _tempC = (float)tempC;
+    _tempC = (float)tcRaw * 0.25f;
     _tempF = _tempC * 9.0f / 5.0f + 32.0f;
-    _coldJunctionC = (float)_sensor->readInternal();
+    // F = C * 9/5 + 32 with C = tcRaw / 4, in 16.16
+    _tempFQ16 = (int32_t)(((int64_t)tcRaw * 9 * 65536) / 20) + 32 * 65536;
+    _coldJunctionC = (float)cjRaw * 0.0625f;
     _status = TCStatus::OK;
 }
 
+// Software SPI, mode 0: MAX31855 shifts data out on the falling edge,
+// so sample MISO while SCK is low and then raise it.
+uint32_t Thermocouple::readFrame() {
+    uint32_t frame = 0;
+
+    digitalWrite(PIN_SPI_SCK, LOW);
+    digitalWrite(_csPin, LOW);
+    delayMicroseconds(1);
+
+    for (int8_t i = 31; i >= 0; i--) {
+        digitalWrite(PIN_SPI_SCK, LOW);
+        delayMicroseconds(1);
+        frame <<= 1;
+        if (digitalRead(PIN_SPI_MISO)) frame |= 1;
+        digitalWrite(PIN_SPI_SCK, HIGH);
+        delayMicroseconds(1);
+    }
+
+    digitalWrite(PIN_SPI_SCK, LOW);
+    digitalWrite(_csPin, HIGH);
+    return frame;
+}
+
 const char* Thermocouple::getStatusString() const {
     switch (_status) {
         case TCStatus::OK:           return "OK";
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <Arduino.h>
-#include <Adafruit_MAX31855.h>
 #include "config.h"
 
 enum class TCStatus : uint8_t {
@@ -13,29 +12,53 @@ enum class TCStatus : uint8_t {
     NOT_READY
 };
 
+// MAX31855 32-bit frame layout:
+//   [31:18] thermocouple temp, signed 14-bit, 0.25 C/LSB
+//   [16]    fault (any of [2:0])
+//   [15:4]  cold-junction temp, signed 12-bit, 0.0625 C/LSB
+//   [2]     short to VCC, [1] short to GND, [0] open circuit
+#define MAX31855_FAULT_BIT          0x00010000UL
+#define MAX31855_FAULT_OPEN         0x01
+#define MAX31855_FAULT_SHORT_GND    0x02
+#define MAX31855_FAULT_SHORT_VCC    0x04
+
+// Native MAX31855 driver. Each sample clocks a single 32-bit frame
+// and decodes thermocouple temp, cold junction and fault bits from
+// that same conversion.
 class Thermocouple {
 public:
     Thermocouple();
-    ~Thermocouple();
 
     void begin(uint8_t csPin);
     void update();
 
+    // Decode a raw frame and update status/temps. Exposed so a bus
+    // scheduler can feed frames read elsewhere.
+    void processFrame(uint32_t raw);
+
     float getTemperatureF() const   { return _tempF; }
     float getTemperatureC() const   { return _tempC; }
+    // Same reading as Q16.16 deg F, derived from the integer quarter-degree
+    // count; feeds the fixed-point PID without a float round trip
+    int32_t getTemperatureFQ16() const { return _tempFQ16; }
     float getColdJunctionC() const  { return _coldJunctionC; }
     TCStatus getStatus() const      { return _status; }
     bool isOk() const               { return _status == TCStatus::OK; }
     uint8_t getErrorCount() const   { return _consecutiveErrors; }
+    uint32_t getRawFrame() const    { return _lastFrame; }
     const char* getStatusString() const;
 
 private:
-    Adafruit_MAX31855* _sensor;
+    uint8_t _csPin;
+    uint32_t _lastFrame;
     float _tempF;
+    int32_t _tempFQ16;
     float _tempC;
     float _coldJunctionC;
     TCStatus _status;
     uint8_t _consecutiveErrors;
     uint32_t _lastReadTime;
     bool _initialized;
+
+    uint32_t readFrame();
 };
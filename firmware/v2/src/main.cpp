@@ -14,14 +14,22 @@
 
 // Core
 #include "core/pid.h"
+#include "core/pid_bank.h"
+#include "core/clock.h"
 #include "core/channel.h"
 #include "core/safety.h"
 #include "core/autotune.h"
 
 // Drivers
 #include "drivers/thermocouple.h"
+#include "drivers/tc_bus.h"
 #include "drivers/ssr.h"
+#include "drivers/ssr_scheduler.h"
+#if DISPLAY_TYPE_ST7789
+#include "drivers/display_st7789.h"
+#else
 #include "drivers/display_ssd1306.h"
+#endif
 #include "drivers/encoder.h"
 #include "drivers/buzzer.h"
 
@@ -53,6 +61,7 @@
 #include "data/storage.h"
 #include "data/profiles.h"
 #include "data/session_log.h"
+#include "data/series_recorder.h"
 #include "data/calibration.h"
 
 // ============================================================
@@ -60,17 +69,23 @@
 // ============================================================
 
 // Inter-task queues
-static QueueHandle_t queueTemp;         // PID → UI/Network
 static QueueHandle_t queueCommand;      // UI/Network → PID
 static QueueHandle_t queueFault;        // Safety → UI
-static SemaphoreHandle_t mutexStorage;  // NVS access mutex
+static TaskHandle_t taskUIHandle;       // Notified with UI_NOTIFY_* bits
 
 // Core
 static Channel channels[NUM_CHANNELS];
 static SafetyManager safety;
 
 // Drivers
+static ThermocoupleBus tcBus;
+static SSRScheduler ssrScheduler;
+static PIDBank<NUM_CHANNELS> pidBank;
+#if DISPLAY_TYPE_ST7789
+static DisplayST7789 displayDriver;
+#else
 static DisplaySSD1306 displayDriver;
+#endif
 static RotaryEncoder encoder;
 static Buzzer buzzer;
 
@@ -81,6 +96,9 @@ static ScreenManager screenMgr;
 static Storage storage;
 static ProfileManager profiles;
 static SessionLogger sessionLog;
+#if ENABLE_SERIES_LOG
+static SeriesRecorder seriesLog;
+#endif
 static CalibrationManager calibration;
 
 // Network
@@ -102,6 +120,8 @@ static MQTTClient mqttClient;
 // ============================================================
 void taskPID(void* param) {
     TickType_t lastWake = xTaskGetTickCount();
+    const Clock& clock = SystemClock::instance();
+    uint32_t lastTickMs = clock.nowMs();
 
     for (;;) {
         // Process incoming commands from UI/Network
@@ -114,10 +134,16 @@ void taskPID(void* param) {
                 case ChannelCommand::CMD_ENABLE:
                     ch.enable();
                     sessionLog.startSession(cmd.channel, ch.getTargetTemp());
+                    #if ENABLE_SERIES_LOG
+                    seriesLog.startSession(cmd.channel);
+                    #endif
                     break;
                 case ChannelCommand::CMD_DISABLE:
                     ch.disable();
                     sessionLog.endSession(cmd.channel);
+                    #if ENABLE_SERIES_LOG
+                    seriesLog.endSession(cmd.channel);
+                    #endif
                     break;
                 case ChannelCommand::CMD_SET_TEMP:
                     ch.setTargetTemp(cmd.value);
@@ -145,39 +171,74 @@ void taskPID(void* param) {
                 case ChannelCommand::CMD_CLEAR_FAULT:
                     ch.disable();
                     break;
+                case ChannelCommand::CMD_SET_HEATER_WATTS:
+                    sessionLog.setHeaterWatts(cmd.channel, (uint16_t)cmd.value);
+                    break;
             }
         }
 
-        // Update all channels (TC read + PID + SSR)
+        // Read all thermocouples in one batched SPI burst
+        tcBus.poll();
+
+        // Stage every channel, then run all PID loops in one pass
         for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
             channels[i].update();
+        }
+        // Integrate over the measured interval, not the nominal one, so
+        // vTaskDelayUntil jitter neither skips nor double-counts a step
+        uint32_t nowMs = clock.nowMs();
+        pidBank.compute(nowMs - lastTickMs);
+        lastTickMs = nowMs;
 
-            // Publish temp updates to UI/Network
-            TempUpdate update = channels[i].getTempUpdate();
-
-            // Apply calibration offset for display
-            if (calibration.isCalibrated(i)) {
-                update.currentTemp = calibration.getCalibratedTemp(i, update.currentTemp);
-            }
-
-            xQueueOverwrite(queueTemp, &update);  // Latest wins
-
-            // Session logging data point
-            if (channels[i].isActive()) {
-                sessionLog.addDataPoint(i, update.currentTemp, update.pidOutput);
-            }
+        // Apply outputs (state + SSR)
+        for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+            channels[i].applyOutput();
         }
 
+        // Stagger SSR on-windows within the shared frame
+        ssrScheduler.update();
+
         // Check for idle timeout triggering channel shutdowns
         if (safety.isIdleTimedOut()) {
             for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
                 if (channels[i].isActive()) {
                     channels[i].disable();
                     sessionLog.endSession(i);
+                    #if ENABLE_SERIES_LOG
+                    seriesLog.endSession(i);
+                    #endif
                 }
             }
         }
 
+        // Publish each channel's latest state to its mailbox; UI, web,
+        // BLE and MQTT read these directly, no kernel queue in between
+        bool screenChanged = false;
+        for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+            float displayTemp = channels[i].getCurrentTemp();
+            if (calibration.isCalibrated(i)) {
+                displayTemp = calibration.getCalibratedTemp(i, displayTemp);
+            }
+            if (channels[i].publishSnapshot(displayTemp)) {
+                screenChanged = true;
+            }
+
+            // Session logging data point
+            if (channels[i].isActive()) {
+                sessionLog.addDataPoint(i, displayTemp,
+                                        channels[i].getSSR().getAppliedDuty(), nowMs);
+                #if ENABLE_SERIES_LOG
+                seriesLog.addSample(i, displayTemp, channels[i].getTargetTemp(),
+                                    channels[i].getPIDOutput());
+                #endif
+            }
+        }
+
+        // Wake the UI only when there is something new to draw
+        if (screenChanged && taskUIHandle) {
+            xTaskNotify(taskUIHandle, UI_NOTIFY_STATE, eSetBits);
+        }
+
         vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(PID_SAMPLE_MS));
     }
 }
@@ -194,35 +255,56 @@ void taskSafety(void* param) {
 
         // Check all channels for faults
         for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
-            if (channels[i].isFaulted()) {
-                if (!channels[i].isTCOk()) {
-                    safety.setFault(FAULT_TC_ERROR, i, channels[i].getCurrentTemp());
+            ChannelSnapshot snap = channels[i].snapshot();
+            if (snap.isFaulted()) {
+                if (!snap.tcOk) {
+                    safety.setFault(FAULT_TC_ERROR, i, snap.currentTemp);
                 }
-                if (channels[i].getCurrentTemp() >= TEMP_ABS_MAX_F) {
-                    safety.setFault(FAULT_OVERTEMP, i, channels[i].getCurrentTemp());
+                if (snap.currentTemp >= TEMP_ABS_MAX_F) {
+                    safety.setFault(FAULT_OVERTEMP, i, snap.currentTemp);
                 }
             }
         }
 
+        // Fault screen + alarm without waiting for the UI refresh floor
+        if (uxQueueMessagesWaiting(queueFault) > 0 && taskUIHandle) {
+            xTaskNotify(taskUIHandle, UI_NOTIFY_FAULT, eSetBits);
+        }
+
         vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(100));
     }
 }
 
 // ============================================================
 // Task: UI (Core 0)
-// Encoder input, display rendering, menu navigation
+// Encoder input, display rendering, menu navigation.
+// Event-driven: sleeps until the encoder ISR, the PID task (snapshot
+// changed on screen) or the safety task (fault) notifies it, with a
+// DISPLAY_IDLE_REFRESH_MS floor for blinking/uptime content.
 // ============================================================
 void taskUI(void* param) {
-    TickType_t lastWake = xTaskGetTickCount();
-    TempUpdate latestTemps[NUM_CHANNELS] = {};
+    ChannelSnapshot latest[NUM_CHANNELS];
+    TickType_t lastRender = xTaskGetTickCount();
+    bool redraw = true;
+
+    encoder.setNotifyTask(xTaskGetCurrentTaskHandle());
 
     for (;;) {
-        // Read latest temps from PID task
-        TempUpdate update;
-        while (xQueueReceive(queueTemp, &update, 0) == pdTRUE) {
-            if (update.channel < NUM_CHANNELS) {
-                latestTemps[update.channel] = update;
-            }
+        // Button debounce/long-press and buzzer notes need a short tick;
+        // otherwise sleep until notified or the refresh floor is due
+        TickType_t wait = (encoder.needsPoll() || buzzer.isPlaying())
+                              ? pdMS_TO_TICKS(UI_POLL_MS)
+                              : pdMS_TO_TICKS(DISPLAY_IDLE_REFRESH_MS);
+        uint32_t bits = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &bits, wait);
+
+        if (bits & (UI_NOTIFY_STATE | UI_NOTIFY_FAULT)) {
+            redraw = true;
+        }
+
+        // Latest state of every channel from the PID task's mailboxes
+        for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+            latest[i] = channels[i].snapshot();
         }
 
         // Read fault events
@@ -230,28 +312,52 @@ void taskUI(void* param) {
         while (xQueueReceive(queueFault, &faultEvt, 0) == pdTRUE) {
             screenMgr.setScreen(Screen::FAULT);
             buzzer.playAlarm();
+            redraw = true;
         }
 
-        // Process encoder
-        EncoderEvent evt = encoder.poll();
-        if (evt != EncoderEvent::NONE) {
+        // Process encoder; bounces that yield no event don't redraw
+        EncoderEvent evt;
+        while ((evt = encoder.poll()) != EncoderEvent::NONE) {
             safety.resetIdleTimer();
-            screenMgr.handleEvent(evt, channels, latestTemps, queueCommand,
-                                  safety, profiles, storage, calibration);
+            screenMgr.handleEvent(evt, encoder.getSteps(), latest,
+                                  queueCommand, safety, profiles, storage, calibration);
+            redraw = true;
         }
 
         // Update buzzer (non-blocking)
         buzzer.update();
 
+        TickType_t now = xTaskGetTickCount();
+        if ((now - lastRender) >= pdMS_TO_TICKS(DISPLAY_IDLE_REFRESH_MS)) {
+            redraw = true;
+        }
+
         // Render display
-        displayDriver.clear();
-        screenMgr.render(&displayDriver, channels, latestTemps, NUM_CHANNELS,
-                         safety, profiles);
-        displayDriver.display();
+        if (redraw) {
+            screenMgr.render(&displayDriver, latest, NUM_CHANNELS,
+                             safety, profiles);
+            displayDriver.flush();      // Sent by taskDisplay (OLED) or DMA (TFT)
+            lastRender = now;
+            redraw = false;
+        }
+    }
+}
+
+// ============================================================
+// Task: Display transfer (Core 0)
+// Pushes flushed frames to the OLED so taskUI never waits on I2C.
+// The TFT needs no task: its flush() queues SPI DMA directly.
+// ============================================================
+#if !DISPLAY_TYPE_ST7789
+void taskDisplay(void* param) {
+    displayDriver.setTransferTask(xTaskGetCurrentTaskHandle());
 
-        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(DISPLAY_UPDATE_MS));
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        displayDriver.transmitPending();
     }
 }
+#endif
 
 // ============================================================
 // Task: Network (Core 0)
@@ -262,11 +368,11 @@ void taskNetwork(void* param) {
     // Initialize networking (after WiFi stack is ready)
     #if ENABLE_WIFI
     {
-        xSemaphoreTake(mutexStorage, portMAX_DELAY);
         GlobalSettings gs = storage.loadGlobalSettings();
-        xSemaphoreGive(mutexStorage);
-
         wifiMgr.begin(gs.wifiMode, gs.wifiSSID, gs.wifiPass);
+        #if ENABLE_SERIES_LOG
+        webServer.setSeriesRecorder(&seriesLog);
+        #endif
         webServer.begin(&wifiMgr, channels, &safety, &profiles,
                         &sessionLog, &calibration, &storage, queueCommand);
         mdnsService.begin();
@@ -279,10 +385,7 @@ void taskNetwork(void* param) {
 
     #if ENABLE_MQTT
     {
-        xSemaphoreTake(mutexStorage, portMAX_DELAY);
         GlobalSettings gs = storage.loadGlobalSettings();
-        xSemaphoreGive(mutexStorage);
-
         mqttClient.begin(gs.mqttHost, gs.mqttPort, gs.mqttUser, gs.mqttPass);
     }
     #endif
@@ -330,11 +433,31 @@ void taskLogger(void* param) {
 
     for (;;) {
         sessionLog.update();
+        #if ENABLE_SERIES_LOG
+        seriesLog.update();
+        #endif
 
         vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(1000));
     }
 }
 
+// ============================================================
+// Task: Persist (Core 0, lowest priority)
+// Debounced NVS writes of settings changed from UI/web
+// ============================================================
+void taskPersist(void* param) {
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(SETTINGS_POLL_MS));
+
+        // Whichever side is due, write both: one flash burst
+        uint32_t now = millis();
+        if (storage.flushDue(now) || profiles.flushDue(now)) {
+            storage.flush();
+            profiles.flush();
+        }
+    }
+}
+
 // ============================================================
 // Arduino setup() - runs once, creates all RTOS tasks
 // ============================================================
@@ -347,15 +470,16 @@ void setup() {
     Serial.println(F("==================================="));
 
     // Create inter-task communication
-    queueTemp    = xQueueCreate(QUEUE_TEMP_SIZE, sizeof(TempUpdate));
     queueCommand = xQueueCreate(QUEUE_CMD_SIZE, sizeof(ChannelCommand));
     queueFault   = xQueueCreate(QUEUE_FAULT_SIZE, sizeof(FaultEvent));
-    mutexStorage = xSemaphoreCreateMutex();
 
     // Initialize storage
     storage.begin();
     profiles.begin();
     sessionLog.begin();
+    #if ENABLE_SERIES_LOG
+    seriesLog.begin();
+    #endif
     calibration.begin();
 
     // Initialize safety
@@ -365,12 +489,17 @@ void setup() {
     GlobalSettings gs = storage.loadGlobalSettings();
     safety.setIdleTimeout(gs.idleTimeoutMin);
 
+    tcBus.begin(TC_CS_PINS, NUM_CHANNELS);
+
     for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
-        channels[i].begin(i, SSR_PINS[i], TC_CS_PINS[i]);
+        channels[i].begin(i, SSR_PINS[i], tcBus.getSensor(i), pidBank.view(i));
+        ssrScheduler.attach(i, &channels[i].getSSR());
 
         ChannelSettings cs = storage.loadChannelSettings(i);
         channels[i].setTargetTemp(cs.targetTempF);
         channels[i].setPIDTunings(cs.kp, cs.ki, cs.kd);
+        sessionLog.setHeaterWatts(i, cs.heaterWatts);
+        channels[i].publishSnapshot(channels[i].getCurrentTemp());
 
         Serial.printf("  CH%d: %.0fF  PID(%.1f, %.2f, %.1f)\n",
                        i + 1, cs.targetTempF, cs.kp, cs.ki, cs.kd);
@@ -406,7 +535,12 @@ void setup() {
         TASK_SAFETY_STACK, NULL, TASK_SAFETY_PRIORITY, NULL, TASK_SAFETY_CORE);
 
     xTaskCreatePinnedToCore(taskUI, "UI",
-        TASK_UI_STACK, NULL, TASK_UI_PRIORITY, NULL, TASK_UI_CORE);
+        TASK_UI_STACK, NULL, TASK_UI_PRIORITY, &taskUIHandle, TASK_UI_CORE);
+
+    #if !DISPLAY_TYPE_ST7789
+    xTaskCreatePinnedToCore(taskDisplay, "Display",
+        TASK_DISPLAY_STACK, NULL, TASK_DISPLAY_PRIORITY, NULL, TASK_DISPLAY_CORE);
+    #endif
 
     #if ENABLE_WIFI || ENABLE_BLE
     xTaskCreatePinnedToCore(taskNetwork, "Network",
@@ -416,6 +550,9 @@ void setup() {
     xTaskCreatePinnedToCore(taskLogger, "Logger",
         TASK_LOGGER_STACK, NULL, TASK_LOGGER_PRIORITY, NULL, TASK_LOGGER_CORE);
 
+    xTaskCreatePinnedToCore(taskPersist, "Persist",
+        TASK_PERSIST_STACK, NULL, TASK_PERSIST_PRIORITY, NULL, TASK_PERSIST_CORE);
+
     Serial.println(F("\nAll tasks launched. System running."));
 }
 
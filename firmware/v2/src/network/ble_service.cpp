@@ -60,10 +60,11 @@ void BLEService::update(Channel* channels, uint8_t numCh) {
     JsonDocument doc;
     JsonArray arr = doc["ch"].to<JsonArray>();
     for (uint8_t i = 0; i < numCh; i++) {
+        ChannelSnapshot snap = channels[i].snapshot();
         JsonObject o = arr.add<JsonObject>();
-        o["t"] = channels[i].getCurrentTemp();
-        o["s"] = channels[i].getTargetTemp();
-        o["o"] = channels[i].getPIDOutput();
+        o["t"] = snap.currentTemp;
+        o["s"] = snap.targetTemp;
+        o["o"] = snap.pidOutput;
     }
     String out; serializeJson(doc, out);
     _tempChar->setValue(out.c_str());
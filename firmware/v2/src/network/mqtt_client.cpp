@@ -37,13 +37,14 @@ void MQTTClient::reconnect() {
     }
 }
 
-void MQTTClient::publishChannel(uint8_t ch, Channel& channel) {
+void MQTTClient::publishChannel(uint8_t ch, const Channel& channel) {
     if (!_client.connected()) return;
+    ChannelSnapshot snap = channel.snapshot();
     String base = String(MQTT_TOPIC_PREFIX) + "ch" + String(ch) + "/";
-    _client.publish((base + "temp").c_str(), String(channel.getCurrentTemp(), 1).c_str());
-    _client.publish((base + "target").c_str(), String(channel.getTargetTemp(), 0).c_str());
-    _client.publish((base + "state").c_str(), channel.getStateString());
-    _client.publish((base + "output").c_str(), String(channel.getPIDOutput(), 1).c_str());
+    _client.publish((base + "temp").c_str(), String(snap.currentTemp, 1).c_str());
+    _client.publish((base + "target").c_str(), String(snap.targetTemp, 0).c_str());
+    _client.publish((base + "state").c_str(), snap.getStateString());
+    _client.publish((base + "output").c_str(), String(snap.pidOutput, 1).c_str());
 }
 
 void MQTTClient::publishHADiscovery() {
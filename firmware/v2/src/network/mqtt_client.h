@@ -10,7 +10,7 @@ public:
     MQTTClient();
     void begin(const char* host, uint16_t port, const char* user, const char* pass);
     void update();
-    void publishChannel(uint8_t ch, Channel& channel);
+    void publishChannel(uint8_t ch, const Channel& channel);
     bool isConnected() { return _client.connected(); }
 private:
     WiFiClient _wifiClient;
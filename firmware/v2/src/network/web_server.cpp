@@ -1,9 +1,11 @@
 #if ENABLE_WIFI
 #include "web_server.h"
+#include <memory>
 #include "core/channel.h"
 #include "core/safety.h"
 #include "data/profiles.h"
 #include "data/session_log.h"
+#include "data/history_query.h"
 #include "data/calibration.h"
 #include "data/storage.h"
 #include "network/wifi_manager.h"
@@ -13,7 +15,7 @@
 
 WebServer::WebServer() : _server(WEB_SERVER_PORT), _ws("/ws"),
     _channels(nullptr), _safety(nullptr), _profiles(nullptr),
-    _logger(nullptr), _cal(nullptr), _storage(nullptr),
+    _logger(nullptr), _series(nullptr), _cal(nullptr), _storage(nullptr),
     _cmdQueue(nullptr), _lastBroadcast(0) {}
 
 void WebServer::begin(WiFiManager* wifi, Channel* channels, SafetyManager* safety,
@@ -51,13 +53,16 @@ void WebServer::setupAPI() {
         doc["uptime"] = millis() / 1000;
         JsonArray chs = doc["channels"].to<JsonArray>();
         for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+            ChannelSnapshot snap = _channels[i].snapshot();
             JsonObject c = chs.add<JsonObject>();
             c["id"] = i;
-            c["state"] = _channels[i].getStateString();
-            c["currentTemp"] = _channels[i].getCurrentTemp();
-            c["targetTemp"] = _channels[i].getTargetTemp();
-            c["pidOutput"] = _channels[i].getPIDOutput();
+            c["state"] = snap.getStateString();
+            c["currentTemp"] = snap.currentTemp;
+            c["targetTemp"] = snap.targetTemp;
+            c["pidOutput"] = snap.pidOutput;
+            c["sessionWh"] = _logger->getSessionWh(i);
         }
+        doc["lifetimeKWh"] = _logger->getLifetimeKWh();
         JsonObject s = doc["safety"].to<JsonObject>();
         s["faults"] = _safety->getFaults();
         s["idleRemaining"] = _safety->getIdleMinRemaining();
@@ -105,11 +110,67 @@ void WebServer::setupAPI() {
             xQueueSend(_cmdQueue, &cmd, 0);
         });
 
-    // GET /api/session/log
+    // GET /api/session/log - streamed; the exporter lives as long as the response
     _server.on("/api/session/log", HTTP_GET, [this](AsyncWebServerRequest* req) {
-        req->send(200, "application/json", _logger->exportJSON());
+        std::shared_ptr<SessionExport> exp = std::make_shared<SessionExport>(*_logger);
+        AsyncWebServerResponse* res = req->beginChunkedResponse("application/json",
+            [exp](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+                return exp->read(buf, maxLen);
+            });
+        req->send(res);
     });
 
+    #if ENABLE_SERIES_LOG
+    // GET /api/history/sessions - every boot's recorded sessions; registered
+    // first, as /api/history also matches its sub-paths
+    _server.on("/api/history/sessions", HTTP_GET, [this](AsyncWebServerRequest* req) {
+        if (!_series) { req->send(404); return; }
+        std::shared_ptr<HistorySessions> list = std::make_shared<HistorySessions>(*_series);
+        if (!list->ok()) { req->send(503); return; }
+        AsyncWebServerResponse* res = req->beginChunkedResponse("application/json",
+            [list](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+                return list->read(buf, maxLen);
+            });
+        req->send(res);
+    });
+
+    // GET /api/history?ch=&from=&to=&points= or ?session=&points= -
+    // LTTB-reduced, streamed from flash
+    _server.on("/api/history", HTTP_GET, [this](AsyncWebServerRequest* req) {
+        if (!_series) { req->send(404); return; }
+        long points = req->hasParam("points") ? req->getParam("points")->value().toInt()
+                                              : HISTORY_DEFAULT_POINTS;
+        points = constrain(points, 3L, (long)HISTORY_MAX_POINTS);
+
+        std::shared_ptr<HistoryQuery> q;
+        if (req->hasParam("session")) {
+            uint32_t id = strtoul(req->getParam("session")->value().c_str(), nullptr, 10);
+            SeriesSession s;
+            if (!_series->getSession(id, s)) { req->send(404); return; }
+            q = std::make_shared<HistoryQuery>(*_series, id, (uint16_t)points);
+        } else {
+            long ch = req->hasParam("ch") ? req->getParam("ch")->value().toInt() : 0;
+            if (ch < 0 || ch >= NUM_CHANNELS) { req->send(400); return; }
+            uint32_t now = millis() / 1000;
+            uint32_t to = req->hasParam("to") ? req->getParam("to")->value().toInt() : now;
+            // Negative `from`: seconds before `to`
+            long from = req->hasParam("from") ? req->getParam("from")->value().toInt()
+                                              : -(long)HISTORY_DEFAULT_SPAN_S;
+            if (from < 0) from = max((long)to + from, 0L);
+            q = std::make_shared<HistoryQuery>(*_series, (uint8_t)ch, (uint32_t)from, to, (uint16_t)points);
+        }
+
+        // Flash reads and LTTB run in bounded slices from the chunk callback
+        if (!q->begin()) { req->send(503); return; }
+        AsyncWebServerResponse* res = req->beginChunkedResponse("application/json",
+            [q](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+                if (!q->step()) return RESPONSE_TRY_AGAIN;
+                return q->read(buf, maxLen);
+            });
+        req->send(res);
+    });
+    #endif
+
     // GET /api/settings
     _server.on("/api/settings", HTTP_GET, [this](AsyncWebServerRequest* req) {
         GlobalSettings gs = _storage->loadGlobalSettings();
@@ -117,14 +178,63 @@ void WebServer::setupAPI() {
         doc["idleTimeout"] = gs.idleTimeoutMin;
         doc["fahrenheit"] = gs.fahrenheit;
         doc["brightness"] = gs.displayBrightness;
+        JsonArray watts = doc["heaterWatts"].to<JsonArray>();
+        for (uint8_t i = 0; i < NUM_CHANNELS; i++) {
+            watts.add(_storage->loadChannelSettings(i).heaterWatts);
+        }
         String out; serializeJson(doc, out);
         req->send(200, "application/json", out);
     });
 
+    // POST /api/settings - partial update; {"heaterWatts":[w0,w1,...]},
+    // null entries leave that channel alone
+    _server.on("/api/settings", HTTP_POST,
+        [](AsyncWebServerRequest* req) {},
+        NULL,
+        [this](AsyncWebServerRequest* req, uint8_t* data, size_t len, size_t idx, size_t total) {
+            if (idx != 0 || len != total) { req->send(413); return; }
+            JsonDocument doc;
+            if (deserializeJson(doc, data, len)) { req->send(400); return; }
+
+            JsonArrayConst watts = doc["heaterWatts"];
+            if (!watts.isNull()) {
+                if (watts.size() > NUM_CHANNELS) { req->send(400, "application/json", "{\"ok\":false}"); return; }
+                // Validate everything before applying anything
+                for (JsonVariantConst w : watts) {
+                    if (w.isNull()) continue;
+                    long v = w.is<long>() ? w.as<long>() : -1;
+                    if (v < 1 || v > HEATER_WATTS_MAX) {
+                        req->send(400, "application/json", "{\"ok\":false}");
+                        return;
+                    }
+                }
+                uint8_t ch = 0;
+                for (JsonVariantConst w : watts) {
+                    if (!w.isNull()) {
+                        ChannelSettings cs = _storage->loadChannelSettings(ch);
+                        cs.heaterWatts = w.as<uint16_t>();
+                        _storage->saveChannelSettings(ch, cs);
+                        ChannelCommand cmd = {}; cmd.type = ChannelCommand::CMD_SET_HEATER_WATTS;
+                        cmd.channel = ch; cmd.value = cs.heaterWatts;
+                        xQueueSend(_cmdQueue, &cmd, 0);
+                    }
+                    ch++;
+                }
+            }
+            req->send(200, "application/json", "{\"ok\":true}");
+        });
+
     // OTA upload
     #if ENABLE_OTA
     _server.on("/api/ota/upload", HTTP_POST,
-        [](AsyncWebServerRequest* req) { req->send(200, "application/json", "{\"ok\":true,\"message\":\"Rebooting...\"}"); delay(1000); ESP.restart(); },
+        [this](AsyncWebServerRequest* req) {
+            req->send(200, "application/json", "{\"ok\":true,\"message\":\"Rebooting...\"}");
+            // Don't lose settings still waiting out the write debounce
+            _storage->flush();
+            _profiles->flush();
+            delay(1000);
+            ESP.restart();
+        },
         [](AsyncWebServerRequest* req, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
             if (!index) { Update.begin(UPDATE_SIZE_UNKNOWN); }
             Update.write(data, len);
@@ -142,12 +252,13 @@ void WebServer::broadcastTemps(Channel* channels, uint8_t numCh) {
     doc["type"] = "temp";
     JsonArray chs = doc["channels"].to<JsonArray>();
     for (uint8_t i = 0; i < numCh; i++) {
+        ChannelSnapshot snap = channels[i].snapshot();
         JsonObject c = chs.add<JsonObject>();
         c["id"] = i;
-        c["temp"] = channels[i].getCurrentTemp();
-        c["target"] = channels[i].getTargetTemp();
-        c["output"] = channels[i].getPIDOutput();
-        c["state"] = channels[i].getStateString();
+        c["temp"] = snap.currentTemp;
+        c["target"] = snap.targetTemp;
+        c["output"] = snap.pidOutput;
+        c["state"] = snap.getStateString();
     }
     doc["uptime"] = millis() / 1000;
     doc["idleRemaining"] = _safety->getIdleMinRemaining();
@@ -10,6 +10,7 @@ class Channel;
 class SafetyManager;
 class ProfileManager;
 class SessionLogger;
+class SeriesRecorder;
 class CalibrationManager;
 class Storage;
 class WiFiManager;
@@ -21,6 +22,7 @@ public:
                ProfileManager* profiles, SessionLogger* logger,
                CalibrationManager* cal, Storage* storage, QueueHandle_t cmdQueue);
     void broadcastTemps(Channel* channels, uint8_t numCh);
+    void setSeriesRecorder(SeriesRecorder* series) { _series = series; }     // Enables /api/history
 private:
     AsyncWebServer _server;
     AsyncWebSocket _ws;
@@ -28,6 +30,7 @@ private:
     SafetyManager* _safety;
     ProfileManager* _profiles;
     SessionLogger* _logger;
+    SeriesRecorder* _series;
     CalibrationManager* _cal;
     Storage* _storage;
     QueueHandle_t _cmdQueue;
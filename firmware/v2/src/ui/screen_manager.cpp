@@ -4,18 +4,124 @@
 #include "data/profiles.h"
 #include "data/storage.h"
 #include "data/calibration.h"
-#include "drivers/display_ssd1306.h"
+#include "drivers/display_driver.h"
 #include "ui/widgets.h"
 
+static const char* const CHANNEL_NAMES[] = { "C1", "C2", "C3", "C4" };
+static const char* const SETTINGS_LABELS[] = { "PID / Heater", "Profiles", "Idle Timeout",
+                                               "WiFi", "System Info", "Factory Reset", "<< Back" };
+
+// Boxes of the retained MAIN and SET_TEMP widgets: {x, y, text size}.
+// Channel rows are relative to the row's top edge (the marker has a
+// fixed size).
+struct Place { int16_t x, y; uint8_t size; };
+
+#if DISPLAY_TYPE_ST7789
+// 240x240 TFT
+static const Place BIG_TEMP   = { 12, 40, 6 };
+static const Place BIG_UNIT   = { 200, 40, 3 };
+static const Place SETPOINT   = { 12, 112, 2 };
+static const Place DUTY       = { 156, 112, 2 };
+static const Place IDLE_MIN   = { 12, 144, 2 };
+static const ui::Rect TEMP_BAR = { 12, 184, 216, 24 };
+static const int16_t ROW_Y0 = 16, ROW_PITCH = 54;
+static const Place ROW_MARKER = { 2, 12, 0 };
+static const Place ROW_NAME   = { 12, 8, 2 };
+static const Place ROW_TEMP   = { 44, 0, 3 };
+static const Place ROW_TARGET = { 164, 8, 2 };
+static const Place ROW_STATE  = { 44, 28, 2 };
+static const Place EDIT_TEMP  = { 30, 80, 6 };
+static const Place EDIT_UNIT  = { 212, 80, 3 };
+#else
+// 128x64 OLED
+static const Place BIG_TEMP   = { 4, 16, 3 };
+static const Place BIG_UNIT   = { 112, 16, 1 };
+static const Place SETPOINT   = { 0, 44, 1 };
+static const Place DUTY       = { 70, 44, 1 };
+static const Place IDLE_MIN   = { 100, 0, 1 };
+static const ui::Rect TEMP_BAR = { 0, 56, 128, 8 };
+static const int16_t ROW_Y0 = 11, ROW_PITCH = 13;
+static const Place ROW_MARKER = { 0, 0, 0 };
+static const Place ROW_NAME   = { 7, 1, 1 };
+static const Place ROW_TEMP   = { 24, 1, 1 };
+static const Place ROW_TARGET = { 66, 1, 1 };
+static const Place ROW_STATE  = { 100, 1, 1 };
+static const Place EDIT_TEMP  = { 10, 18, 3 };
+static const Place EDIT_UNIT  = { 106, 20, 2 };
+#endif
+
+ScreenManager::ChannelRow::ChannelRow(uint8_t row)
+    : marker(ROW_MARKER.x, ROW_Y0 + row * ROW_PITCH + ROW_MARKER.y),
+      name(ROW_NAME.x, ROW_Y0 + row * ROW_PITCH + ROW_NAME.y, 2, ROW_NAME.size),
+      temp(ROW_TEMP.x, ROW_Y0 + row * ROW_PITCH + ROW_TEMP.y, 6, ROW_TEMP.size,
+           "%5.0fF", 1.0f, " ---F"),
+      target(ROW_TARGET.x, ROW_Y0 + row * ROW_PITCH + ROW_TARGET.y, 4, ROW_TARGET.size,
+             ">%3.0f", 1.0f),
+      state(ROW_STATE.x, ROW_Y0 + row * ROW_PITCH + ROW_STATE.y, 4, ROW_STATE.size) {}
+
 ScreenManager::ScreenManager()
-    : _current(Screen::MAIN), _selectedCh(0), _menuIdx(0), _fineAdj(false) {}
+    : _current(Screen::MAIN), _selectedCh(0), _menuIdx(0), _fineAdj(false),
+      _editTargetF(TEMP_DEFAULT_F),
+      _editKp(PID_KP_DEFAULT), _editKi(PID_KI_DEFAULT), _editKd(PID_KD_DEFAULT),
+      _heaterWatts(HEATER_WATTS_DEFAULT),
+      _rendered(Screen::MAIN), _renderedValid(false),
+      _header(false), _footer(true),
+      _bigTemp(BIG_TEMP.x, BIG_TEMP.y, 5, BIG_TEMP.size, "%5.1f", 0.1f, "---.-"),
+      _bigUnit(BIG_UNIT.x, BIG_UNIT.y, 1, BIG_UNIT.size),
+      _setpoint(SETPOINT.x, SETPOINT.y, 9, SETPOINT.size, "SET:%.0fF", 1.0f),
+      _output(DUTY.x, DUTY.y, 4, DUTY.size, "%3.0f%%", 1.0f),
+      _idleMin(IDLE_MIN.x, IDLE_MIN.y, 4, IDLE_MIN.size, "%.0fm", 1.0f),
+      _tempBar(TEMP_BAR.x, TEMP_BAR.y, TEMP_BAR.w, TEMP_BAR.h),
+      _rows{ ChannelRow(0), ChannelRow(1), ChannelRow(2), ChannelRow(3) },
+      _editTemp(EDIT_TEMP.x, EDIT_TEMP.y, 5, EDIT_TEMP.size, "%5.0f", 1.0f),
+      _editUnit(EDIT_UNIT.x, EDIT_UNIT.y, 1, EDIT_UNIT.size),
+      _menu{ ui::MenuItemWidget(13), ui::MenuItemWidget(20), ui::MenuItemWidget(27),
+             ui::MenuItemWidget(34), ui::MenuItemWidget(41), ui::MenuItemWidget(48),
+             ui::MenuItemWidget(55) },
+      _tuneChannel(8, 20, 10, 1, "Channel %.0f", 1.0f),
+      _tuneBar(8, 32, 112, 10),
+      _tunePercent(8, 48, 4, 1, "%.0f%%", 1.0f) {
+    // Insertion order is drawing order
+    _mainSingle.add(&_header);
+    _mainSingle.add(&_bigTemp);
+    _mainSingle.add(&_bigUnit);
+    _mainSingle.add(&_setpoint);
+    _mainSingle.add(&_output);
+    _mainSingle.add(&_idleMin);
+    _mainSingle.add(&_tempBar);
+
+    _mainMulti.add(&_header);
+    for (uint8_t i = 0; i < MAX_ROWS && i < NUM_CHANNELS; i++) {
+        _mainMulti.add(&_rows[i].marker);
+        _mainMulti.add(&_rows[i].name);
+        _mainMulti.add(&_rows[i].temp);
+        _mainMulti.add(&_rows[i].target);
+        _mainMulti.add(&_rows[i].state);
+    }
+
+    _setTemp.add(&_header);
+    _setTemp.add(&_editTemp);
+    _setTemp.add(&_editUnit);
+    _setTemp.add(&_footer);
+
+    _settings.add(&_header);
+    for (uint8_t i = 0; i < SETTINGS_ITEMS; i++) {
+        _settings.add(&_menu[i]);
+    }
+
+    _autotune.add(&_header);
+    _autotune.add(&_tuneChannel);
+    _autotune.add(&_tuneBar);
+    _autotune.add(&_tunePercent);
+    _autotune.add(&_footer);
+}
 
 void ScreenManager::setScreen(Screen s) {
     _current = s;
     _menuIdx = 0;
 }
 
-void ScreenManager::handleEvent(EncoderEvent evt, Channel channels[], TempUpdate temps[],
+void ScreenManager::handleEvent(EncoderEvent evt, uint16_t steps, const ChannelSnapshot snaps[],
                                  QueueHandle_t cmdQueue, SafetyManager& safety,
                                  ProfileManager& profiles, Storage& storage,
                                  CalibrationManager& calibration) {
@@ -26,7 +132,7 @@ void ScreenManager::handleEvent(EncoderEvent evt, Channel channels[], TempUpdate
     switch (_current) {
         case Screen::MAIN:
             if (evt == EncoderEvent::PRESS) {
-                cmd.type = channels[ch].isActive() ?
+                cmd.type = snaps[ch].isActive() ?
                     ChannelCommand::CMD_DISABLE : ChannelCommand::CMD_ENABLE;
                 xQueueSend(cmdQueue, &cmd, 0);
             } else if (evt == EncoderEvent::LONG_PRESS) {
@@ -37,28 +143,31 @@ void ScreenManager::handleEvent(EncoderEvent evt, Channel channels[], TempUpdate
                     _selectedCh = (uint8_t)(((int8_t)_selectedCh + d + NUM_CHANNELS) % NUM_CHANNELS);
                 } else {
                     setScreen(Screen::SET_TEMP);
-                    float step = _fineAdj ? TEMP_STEP_FINE : TEMP_STEP_NORMAL;
-                    cmd.type = ChannelCommand::CMD_ADJUST_TEMP;
-                    cmd.value = (evt == EncoderEvent::ROTATE_CW) ? step : -step;
+                    _editTargetF = snaps[ch].targetTemp;
+                    float step = (_fineAdj ? TEMP_STEP_FINE : TEMP_STEP_NORMAL) * steps;
+                    _editTargetF = constrain(_editTargetF + ((evt == EncoderEvent::ROTATE_CW) ? step : -step),
+                                             TEMP_MIN_F, TEMP_MAX_F);
+                    cmd.type = ChannelCommand::CMD_SET_TEMP;
+                    cmd.value = _editTargetF;
                     xQueueSend(cmdQueue, &cmd, 0);
                 }
             }
             break;
 
         case Screen::SET_TEMP: {
-            float step = _fineAdj ? TEMP_STEP_FINE : TEMP_STEP_NORMAL;
+            float step = (_fineAdj ? TEMP_STEP_FINE : TEMP_STEP_NORMAL) * steps;
             if (evt == EncoderEvent::ROTATE_CW || evt == EncoderEvent::ROTATE_CCW) {
-                cmd.type = ChannelCommand::CMD_ADJUST_TEMP;
-                cmd.value = (evt == EncoderEvent::ROTATE_CW) ? step : -step;
+                // Absolute target, so detents queued behind a busy tick
+                // can't be lost or applied against a stale value
+                _editTargetF = constrain(_editTargetF + ((evt == EncoderEvent::ROTATE_CW) ? step : -step),
+                                         TEMP_MIN_F, TEMP_MAX_F);
+                cmd.type = ChannelCommand::CMD_SET_TEMP;
+                cmd.value = _editTargetF;
                 xQueueSend(cmdQueue, &cmd, 0);
             } else if (evt == EncoderEvent::PRESS) {
-                // Save and return
-                xSemaphoreTake(xSemaphoreCreateMutex(), portMAX_DELAY); // simplified
-                ChannelSettings cs;
-                cs.targetTempF = channels[ch].getTargetTemp();
-                cs.kp = channels[ch].getPID().getKp();
-                cs.ki = channels[ch].getPID().getKi();
-                cs.kd = channels[ch].getPID().getKd();
+                // Save (deferred to the persist task) and return
+                ChannelSettings cs = storage.loadChannelSettings(ch);
+                cs.targetTempF = _editTargetF;
                 storage.saveChannelSettings(ch, cs);
                 setScreen(Screen::MAIN);
             } else if (evt == EncoderEvent::LONG_PRESS) {
@@ -72,7 +181,13 @@ void ScreenManager::handleEvent(EncoderEvent evt, Channel channels[], TempUpdate
             else if (evt == EncoderEvent::ROTATE_CCW && _menuIdx > 0) _menuIdx--;
             else if (evt == EncoderEvent::PRESS) {
                 switch (_menuIdx) {
-                    case 0: setScreen(Screen::PID_TUNE); break;
+                    case 0:
+                        _editKp = snaps[ch].kp;
+                        _editKi = snaps[ch].ki;
+                        _editKd = snaps[ch].kd;
+                        _heaterWatts = storage.loadChannelSettings(ch).heaterWatts;
+                        setScreen(Screen::PID_TUNE);
+                        break;
                     case 1: setScreen(Screen::PROFILES); break;
                     case 2: setScreen(Screen::IDLE_TIMEOUT); break;
                     case 3: setScreen(Screen::WIFI_STATUS); break;
@@ -101,22 +216,38 @@ void ScreenManager::handleEvent(EncoderEvent evt, Channel channels[], TempUpdate
 
         case Screen::PID_TUNE:
             if (evt == EncoderEvent::ROTATE_CW || evt == EncoderEvent::ROTATE_CCW) {
-                float delta = (evt == EncoderEvent::ROTATE_CW) ? 0.1f : -0.1f;
-                float kp = channels[ch].getPID().getKp();
-                float ki = channels[ch].getPID().getKi();
-                float kd = channels[ch].getPID().getKd();
+                float delta = ((evt == EncoderEvent::ROTATE_CW) ? 0.1f : -0.1f) * steps;
                 switch (_menuIdx) {
-                    case 0: kp = max(0.0f, kp + delta); break;
-                    case 1: ki = max(0.0f, ki + delta * 0.01f); break;
-                    case 2: kd = max(0.0f, kd + delta); break;
-                    case 3: break; // Auto-tune row
+                    case 0: _editKp = max(0.0f, _editKp + delta); break;
+                    case 1: _editKi = max(0.0f, _editKi + delta * 0.01f); break;
+                    case 2: _editKd = max(0.0f, _editKd + delta); break;
+                    case 3: {
+                        int32_t w = (int32_t)_heaterWatts +
+                            ((evt == EncoderEvent::ROTATE_CW) ? HEATER_WATTS_STEP : -HEATER_WATTS_STEP) * steps;
+                        _heaterWatts = (uint16_t)constrain(w, (int32_t)HEATER_WATTS_STEP, (int32_t)HEATER_WATTS_MAX);
+                        cmd.type = ChannelCommand::CMD_SET_HEATER_WATTS;
+                        cmd.value = _heaterWatts;
+                        xQueueSend(cmdQueue, &cmd, 0);
+
+                        ChannelSettings cs = storage.loadChannelSettings(ch);
+                        cs.heaterWatts = _heaterWatts;
+                        storage.saveChannelSettings(ch, cs);
+                        break;
+                    }
+                    case 4: break; // Auto-tune row
                 }
+                if (_menuIdx > 2) break;
                 cmd.type = ChannelCommand::CMD_SET_PID;
-                cmd.kp = kp; cmd.ki = ki; cmd.kd = kd;
+                cmd.kp = _editKp; cmd.ki = _editKi; cmd.kd = _editKd;
                 xQueueSend(cmdQueue, &cmd, 0);
+
+                // RAM only; a run of detents is written once after it settles
+                ChannelSettings cs = storage.loadChannelSettings(ch);
+                cs.kp = _editKp; cs.ki = _editKi; cs.kd = _editKd;
+                storage.saveChannelSettings(ch, cs);
             } else if (evt == EncoderEvent::PRESS) {
-                if (_menuIdx < 3) _menuIdx++;
-                else if (_menuIdx == 3) {
+                if (_menuIdx < 4) _menuIdx++;
+                else if (_menuIdx == 4) {
                     cmd.type = ChannelCommand::CMD_START_AUTOTUNE;
                     xQueueSend(cmdQueue, &cmd, 0);
                     setScreen(Screen::AUTOTUNE);
@@ -178,82 +309,110 @@ void ScreenManager::handleEvent(EncoderEvent evt, Channel channels[], TempUpdate
     }
 }
 
-void ScreenManager::render(DisplayDriver* d, Channel channels[], TempUpdate temps[],
+void ScreenManager::render(DisplayDriver* d, const ChannelSnapshot snaps[],
                             uint8_t numCh, SafetyManager& safety, ProfileManager& profiles) {
+    ui::WidgetGroup* group = retainedGroup(_current, numCh);
+    if (!group) {
+        d->clear();
+        renderImmediate(d, snaps, numCh, safety, profiles);
+        _rendered = _current;
+        _renderedValid = true;
+        return;
+    }
+
+    // New screen (or the driver can't patch further): start from blank
+    if (!_renderedValid || _rendered != _current || d->wantsFullRedraw()) {
+        d->clear();
+        group->invalidate();
+        _rendered = _current;
+        _renderedValid = true;
+    }
+
+    updateRetained(snaps, numCh, safety);
+    group->render(d);
+}
+
+ui::WidgetGroup* ScreenManager::retainedGroup(Screen s, uint8_t numCh) {
+    switch (s) {
+        case Screen::MAIN:      return numCh == 1 ? &_mainSingle : &_mainMulti;
+        case Screen::SET_TEMP:  return &_setTemp;
+        case Screen::SETTINGS:  return &_settings;
+        case Screen::AUTOTUNE:  return &_autotune;
+        default:                return nullptr;
+    }
+}
+
+void ScreenManager::updateRetained(const ChannelSnapshot snaps[],
+                                   uint8_t numCh, SafetyManager& safety) {
     switch (_current) {
         case Screen::MAIN:
             if (numCh == 1) {
-                // Single channel large display
-                Widgets::drawHeader(d, channels[0].getStateString());
-                d->setTextSize(3);
-                d->setCursor(4, 16);
-                if (channels[0].isTCOk()) {
-                    d->printf("%5.1f", temps[0].currentTemp);
-                    d->setTextSize(1);
-                    d->setCursor(112, 16);
-                    d->print("F");
+                const ChannelSnapshot& s = snaps[0];
+                _header.set(s.getStateString());
+                if (s.tcOk) {
+                    _bigTemp.set(s.displayTemp);
+                    _bigUnit.set("F");
                 } else {
-                    d->print("---.-");
+                    _bigTemp.setBlank();
+                    _bigUnit.set("");
                 }
-                d->setTextSize(1);
-                d->setCursor(0, 44);
-                d->printf("SET:%.0fF", channels[0].getTargetTemp());
-                d->setCursor(70, 44);
-                d->printf("%3.0f%%", channels[0].getPIDOutput());
-                if (safety.getIdleMinRemaining() > 0 && channels[0].isActive()) {
-                    d->setCursor(100, 0);
-                    d->printf("%um", safety.getIdleMinRemaining());
+                _setpoint.set(s.targetTemp);
+                _output.set(s.pidOutput);
+                if (safety.getIdleMinRemaining() > 0 && s.isActive()) {
+                    _idleMin.set((float)safety.getIdleMinRemaining());
+                } else {
+                    _idleMin.setBlank();
                 }
-                Widgets::drawTempBar(d, 0, 56, 128, 8, temps[0].currentTemp, channels[0].getTargetTemp());
+                _tempBar.set(s.displayTemp, s.targetTemp);
             } else {
-                // Multi-channel compact view
-                Widgets::drawHeader(d, MODEL_NAME);
-                for (uint8_t i = 0; i < numCh && i < 4; i++) {
-                    uint8_t y = 11 + i * 13;
-                    if (i == _selectedCh) {
-                        d->drawTriangle(0, y + 1, 0, y + 9, 4, y + 5);
-                    }
-                    d->setTextSize(1);
-                    d->setCursor(7, y + 1);
-                    d->printf("C%d", i + 1);
-                    d->setCursor(24, y + 1);
-                    if (channels[i].isTCOk()) {
-                        d->printf("%5.0fF", temps[i].currentTemp);
-                    } else {
-                        d->print(" ---F");
-                    }
-                    d->setCursor(66, y + 1);
-                    d->printf(">%3.0f", channels[i].getTargetTemp());
-                    d->setCursor(100, y + 1);
-                    d->print(channels[i].getStateString());
+                _header.set(MODEL_NAME);
+                for (uint8_t i = 0; i < numCh && i < MAX_ROWS; i++) {
+                    ChannelRow& r = _rows[i];
+                    const ChannelSnapshot& s = snaps[i];
+                    r.marker.set(i == _selectedCh);
+                    r.name.set(CHANNEL_NAMES[i]);
+                    if (s.tcOk) r.temp.set(s.displayTemp);
+                    else r.temp.setBlank();
+                    r.target.set(s.targetTemp);
+                    r.state.set(s.getStateString());
                 }
             }
             break;
 
         case Screen::SET_TEMP:
-            Widgets::drawHeader(d, "SET TEMP");
-            d->setTextSize(3);
-            d->setCursor(10, 18);
-            d->printf("%5.0f", channels[_selectedCh].getTargetTemp());
-            d->setTextSize(2);
-            d->setCursor(106, 20);
-            d->print("F");
-            d->setTextSize(1);
-            Widgets::drawFooter(d, _fineAdj ? "FINE +/-1F  [OK]" : "STEP +/-5F  [OK]");
+            _header.set("SET TEMP");
+            _editTemp.set(_editTargetF);
+            _editUnit.set("F");
+            // Base step per detent; faster turns multiply it (RotaryEncoder::getSteps)
+            _footer.set(_fineAdj ? "STEP 1F  FAST=BIGGER" : "STEP 5F  FAST=BIGGER");
             break;
 
-        case Screen::SETTINGS: {
-            Widgets::drawHeader(d, "SETTINGS");
-            const char* items[] = {"PID Tuning", "Profiles", "Idle Timeout",
-                                   "WiFi", "System Info", "Factory Reset", "<< Back"};
-            for (uint8_t i = 0; i < 7; i++) {
-                Widgets::drawMenuItem(d, 13 + i * 7, items[i], i == _menuIdx);
+        case Screen::SETTINGS:
+            _header.set("SETTINGS");
+            for (uint8_t i = 0; i < SETTINGS_ITEMS; i++) {
+                _menu[i].set(SETTINGS_LABELS[i], i == _menuIdx);
             }
             break;
+
+        case Screen::AUTOTUNE: {
+            float prog = snaps[_selectedCh].autotuneProgress * 100.0f;
+            _header.set("AUTO-TUNE");
+            _tuneChannel.set(_selectedCh + 1);
+            _tuneBar.set(prog);
+            _tunePercent.set(prog);
+            _footer.set("Press:cancel");
+            break;
         }
 
+        default: break;
+    }
+}
+
+void ScreenManager::renderImmediate(DisplayDriver* d, const ChannelSnapshot snaps[],
+                                    uint8_t numCh, SafetyManager& safety, ProfileManager& profiles) {
+    switch (_current) {
         case Screen::PROFILES: {
-            Widgets::drawHeader(d, "PROFILES");
+            ui::drawHeader(d, "PROFILES");
             uint8_t activePr = profiles.getActiveProfile(_selectedCh);
             for (uint8_t i = 0; i < MAX_PROFILES_PER_CH && i < 6; i++) {
                 Profile p = profiles.getProfile(_selectedCh, i);
@@ -269,16 +428,16 @@ void ScreenManager::render(DisplayDriver* d, Channel channels[], TempUpdate temp
         }
 
         case Screen::PID_TUNE: {
-            Widgets::drawHeader(d, "PID TUNE");
-            const PIDController& pid = channels[_selectedCh].getPID();
-            const char* labels[] = {"Kp", "Ki", "Kd", "Auto-Tune"};
-            float values[] = {pid.getKp(), pid.getKi(), pid.getKd(), 0};
-            for (uint8_t i = 0; i < 4; i++) {
-                uint8_t y = 14 + i * 11;
-                Widgets::drawMenuItem(d, y, "", i == _menuIdx);
+            ui::drawHeader(d, "PID TUNE");
+            const char* labels[] = {"Kp", "Ki", "Kd"};
+            float values[] = {_editKp, _editKi, _editKd};
+            for (uint8_t i = 0; i < 5; i++) {
+                uint8_t y = 14 + i * 10;
+                ui::drawMenuItem(d, y, "", i == _menuIdx);
                 if (i == _menuIdx) d->setInvertText(true);
                 d->setCursor(4, y);
                 if (i < 3) d->printf("%s: %7.3f", labels[i], values[i]);
+                else if (i == 3) d->printf("Heater: %4uW", _heaterWatts);
                 else d->print(">> Auto-Tune");
                 if (i == _menuIdx) d->setInvertText(false);
             }
@@ -286,17 +445,17 @@ void ScreenManager::render(DisplayDriver* d, Channel channels[], TempUpdate temp
         }
 
         case Screen::IDLE_TIMEOUT:
-            Widgets::drawHeader(d, "IDLE TIMEOUT");
+            ui::drawHeader(d, "IDLE TIMEOUT");
             d->setTextSize(2);
             d->setCursor(16, 24);
             if (safety.getIdleTimeout() == 0) d->print("OFF");
             else d->printf("%u min", safety.getIdleTimeout());
             d->setTextSize(1);
-            Widgets::drawFooter(d, "Turn:adj  Press:save");
+            ui::drawFooter(d, "Turn:adj  Press:save");
             break;
 
         case Screen::WIFI_STATUS:
-            Widgets::drawHeader(d, "WIFI");
+            ui::drawHeader(d, "WIFI");
             d->setTextSize(1);
             d->setCursor(0, 14);
             d->print("Mode: AP/STA");
@@ -306,11 +465,11 @@ void ScreenManager::render(DisplayDriver* d, Channel channels[], TempUpdate temp
             d->print("IP: 192.168.4.1");
             d->setCursor(0, 44);
             d->print("http://espnail.local");
-            Widgets::drawFooter(d, "Press:back");
+            ui::drawFooter(d, "Press:back");
             break;
 
         case Screen::INFO:
-            Widgets::drawHeader(d, "SYS INFO");
+            ui::drawHeader(d, "SYS INFO");
             d->setCursor(0, 14);
             d->printf("Model: %s", MODEL_NAME);
             d->setCursor(0, 24);
@@ -323,19 +482,6 @@ void ScreenManager::render(DisplayDriver* d, Channel channels[], TempUpdate temp
             d->printf("Up: %lus", millis() / 1000);
             break;
 
-        case Screen::AUTOTUNE: {
-            Widgets::drawHeader(d, "AUTO-TUNE");
-            d->setTextSize(1);
-            d->setCursor(8, 20);
-            d->printf("Channel %d", _selectedCh + 1);
-            float prog = channels[_selectedCh].getAutotuneProgress();
-            Widgets::drawProgressBar(d, 8, 32, 112, 10, prog * 100.0f);
-            d->setCursor(8, 48);
-            d->printf("%.0f%%", prog * 100.0f);
-            Widgets::drawFooter(d, "Press:cancel");
-            break;
-        }
-
         case Screen::FAULT: {
             bool blink = (millis() / 500) % 2;
             if (blink) {
@@ -354,7 +500,7 @@ void ScreenManager::render(DisplayDriver* d, Channel channels[], TempUpdate temp
             if (faults & FAULT_TC_ERROR) { d->setCursor(4, y); d->print("THERMOCOUPLE ERROR"); y += 10; }
             if (faults & FAULT_IDLE_TIMEOUT) { d->setCursor(4, y); d->print("IDLE TIMEOUT"); y += 10; }
             if (faults & FAULT_SSR_STUCK) { d->setCursor(4, y); d->print("SSR STUCK"); y += 10; }
-            Widgets::drawFooter(d, "Press:clear");
+            ui::drawFooter(d, "Press:clear");
             break;
         }
 
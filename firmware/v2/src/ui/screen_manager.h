@@ -3,6 +3,7 @@
 #include <Arduino.h>
 #include "config.h"
 #include "drivers/encoder.h"
+#include "ui/widget_tree.h"
 
 enum class Screen : uint8_t {
     MAIN,
@@ -19,8 +20,7 @@ enum class Screen : uint8_t {
 };
 
 // Forward declarations
-class Channel;
-struct TempUpdate;
+struct ChannelSnapshot;
 class SafetyManager;
 class ProfileManager;
 class Storage;
@@ -43,19 +43,74 @@ public:
     bool isFineAdjust() const           { return _fineAdj; }
     void toggleFineAdjust()             { _fineAdj = !_fineAdj; }
 
-    // Process encoder events and dispatch to current screen handler
-    void handleEvent(EncoderEvent evt, Channel channels[], TempUpdate temps[],
+    // Process encoder events and dispatch to current screen handler.
+    // `steps` is the accelerated size of a ROTATE_* event
+    // (RotaryEncoder::getSteps()); value editors scale by it, menus
+    // move one row per event. Channel state comes only from `snaps`
+    // (the PID task's mailboxes); editors keep their own value and
+    // send it as an absolute command.
+    void handleEvent(EncoderEvent evt, uint16_t steps, const ChannelSnapshot snaps[],
                      QueueHandle_t cmdQueue, SafetyManager& safety,
                      ProfileManager& profiles, Storage& storage,
                      CalibrationManager& calibration);
 
-    // Render current screen
-    void render(DisplayDriver* d, Channel channels[], TempUpdate temps[],
+    // Render current screen. MAIN, SET_TEMP, SETTINGS and AUTOTUNE are
+    // retained (only changed widgets redraw); the rest clear and redraw.
+    // MAIN and SET_TEMP have their own layout on the ST7789 build; the
+    // other screens use the OLED coordinates on either panel.
+    void render(DisplayDriver* d, const ChannelSnapshot snaps[],
                 uint8_t numCh, SafetyManager& safety, ProfileManager& profiles);
 
 private:
+    static const uint8_t SETTINGS_ITEMS = 7;
+    static const uint8_t MAX_ROWS = 4;      // Multi-channel MAIN rows
+
     Screen _current;
     uint8_t _selectedCh;
     uint8_t _menuIdx;
     bool _fineAdj;
+    // Editor values for the selected channel, seeded on entry
+    float _editTargetF;                     // SET_TEMP
+    float _editKp, _editKi, _editKd;        // PID_TUNE
+    uint16_t _heaterWatts;                  // PID_TUNE
+
+    Screen _rendered;                       // Screen currently on the panel
+    bool _renderedValid;
+
+    // Retained widgets; header/footer are shared between screens
+    ui::BannerWidget _header;
+    ui::BannerWidget _footer;
+    ui::ValueWidget _bigTemp;
+    ui::LabelWidget _bigUnit;
+    ui::ValueWidget _setpoint;
+    ui::ValueWidget _output;
+    ui::ValueWidget _idleMin;
+    ui::TempBarWidget _tempBar;
+    struct ChannelRow {
+        explicit ChannelRow(uint8_t row);
+        ui::MarkerWidget marker;
+        ui::LabelWidget name;
+        ui::ValueWidget temp;
+        ui::ValueWidget target;
+        ui::LabelWidget state;
+    };
+    ChannelRow _rows[MAX_ROWS];
+    ui::ValueWidget _editTemp;
+    ui::LabelWidget _editUnit;
+    ui::MenuItemWidget _menu[SETTINGS_ITEMS];
+    ui::ValueWidget _tuneChannel;
+    ui::ProgressBarWidget _tuneBar;
+    ui::ValueWidget _tunePercent;
+
+    ui::WidgetGroup _mainSingle;
+    ui::WidgetGroup _mainMulti;
+    ui::WidgetGroup _setTemp;
+    ui::WidgetGroup _settings;
+    ui::WidgetGroup _autotune;
+
+    ui::WidgetGroup* retainedGroup(Screen s, uint8_t numCh);
+    void updateRetained(const ChannelSnapshot snaps[],
+                        uint8_t numCh, SafetyManager& safety);
+    void renderImmediate(DisplayDriver* d, const ChannelSnapshot snaps[],
+                         uint8_t numCh, SafetyManager& safety, ProfileManager& profiles);
 };
@@ -0,0 +1,248 @@
+#include "ui/widget_tree.h"
+#include "ui/widgets.h"
+#include "config.h"
+
+namespace ui {
+
+// Size-1 glyph cell of the built-in 5x7 font
+static const int16_t CHAR_W = 6;
+static const int16_t CHAR_H = 8;
+
+// Key of a blank/placeholder value; never produced by a real reading
+static const int32_t KEY_BLANK = INT32_MIN;
+
+static int32_t pointerKey(const void* p) {
+    return (int32_t)(intptr_t)p;
+}
+
+// ---------------------------------------------------------------------------
+// Widget
+// ---------------------------------------------------------------------------
+Widget::Widget(int16_t x, int16_t y, int16_t w, int16_t h)
+    : _key(KEY_BLANK + 1), _dirty(true) {
+    _bounds.x = x;
+    _bounds.y = y;
+    _bounds.w = w;
+    _bounds.h = h;
+}
+
+void Widget::erase(DisplayDriver* d) {
+    layout(d);
+    d->clearRect(_bounds.x, _bounds.y, _bounds.w, _bounds.h);
+}
+
+void Widget::paint(DisplayDriver* d) {
+    draw(d);
+    d->markDirty(_bounds.x, _bounds.y, _bounds.w, _bounds.h);
+    _dirty = false;
+}
+
+void Widget::update(int32_t key) {
+    if (key != _key) {
+        _key = key;
+        _dirty = true;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// LabelWidget
+// ---------------------------------------------------------------------------
+LabelWidget::LabelWidget(int16_t x, int16_t y, uint8_t maxChars, uint8_t textSize)
+    : Widget(x, y, maxChars * CHAR_W * textSize, CHAR_H * textSize),
+      _text(""), _size(textSize) {}
+
+void LabelWidget::set(const char* text) {
+    _text = text;
+    update(pointerKey(text));
+}
+
+void LabelWidget::draw(DisplayDriver* d) {
+    d->setTextSize(_size);
+    d->setCursor(_bounds.x, _bounds.y);
+    d->print(_text);
+}
+
+// ---------------------------------------------------------------------------
+// ValueWidget
+// ---------------------------------------------------------------------------
+ValueWidget::ValueWidget(int16_t x, int16_t y, uint8_t maxChars, uint8_t textSize,
+                         const char* fmt, float resolution, const char* blank)
+    : Widget(x, y, maxChars * CHAR_W * textSize, CHAR_H * textSize),
+      _fmt(fmt), _blank(blank), _resolution(resolution), _value(0.0f),
+      _isBlank(true), _size(textSize) {}
+
+void ValueWidget::set(float value) {
+    _value = value;
+    _isBlank = false;
+    update((int32_t)lroundf(value / _resolution));
+}
+
+void ValueWidget::setBlank() {
+    _isBlank = true;
+    update(KEY_BLANK);
+}
+
+void ValueWidget::draw(DisplayDriver* d) {
+    d->setTextSize(_size);
+    d->setCursor(_bounds.x, _bounds.y);
+    if (_isBlank) d->print(_blank);
+    else d->printf(_fmt, _value);
+}
+
+// ---------------------------------------------------------------------------
+// BannerWidget
+// ---------------------------------------------------------------------------
+BannerWidget::BannerWidget(bool footer)
+    : Widget(0, 0, 0, 10), _text(""), _footer(footer) {}
+
+void BannerWidget::set(const char* text) {
+    _text = text;
+    update(pointerKey(text));
+}
+
+void BannerWidget::layout(DisplayDriver* d) {
+    _bounds.w = static_cast<int16_t>(d->width());
+    _bounds.y = _footer ? static_cast<int16_t>(d->height()) - 10 : 0;
+}
+
+void BannerWidget::draw(DisplayDriver* d) {
+    if (_footer) drawFooter(d, _text);
+    else drawHeader(d, _text);
+}
+
+// ---------------------------------------------------------------------------
+// TempBarWidget - keyed on the fill width in pixels and the at-target colour
+// ---------------------------------------------------------------------------
+TempBarWidget::TempBarWidget(int16_t x, int16_t y, int16_t w, int16_t h)
+    : Widget(x, y, w, h), _current(0.0f), _target(0.0f) {}
+
+void TempBarWidget::set(float currentTemp, float targetTemp) {
+    _current = currentTemp;
+    _target = targetTemp;
+
+    if (targetTemp <= 0.0f) {
+        update(KEY_BLANK);
+        return;
+    }
+    float ratio = constrain(currentTemp / targetTemp, 0.0f, 1.0f);
+    int32_t fillW = static_cast<int16_t>((_bounds.w - 2) * ratio);
+    update(fillW | (ratio >= 1.0f ? 0x10000 : 0));
+}
+
+void TempBarWidget::draw(DisplayDriver* d) {
+    drawTempBar(d, _bounds.x, _bounds.y, _bounds.w, _bounds.h, _current, _target);
+}
+
+// ---------------------------------------------------------------------------
+// ProgressBarWidget - keyed on the fill width in pixels
+// ---------------------------------------------------------------------------
+ProgressBarWidget::ProgressBarWidget(int16_t x, int16_t y, int16_t w, int16_t h)
+    : Widget(x, y, w, h), _percent(0.0f) {}
+
+void ProgressBarWidget::set(float percent) {
+    _percent = constrain(percent, 0.0f, 100.0f);
+    update(static_cast<int16_t>((_bounds.w - 2) * (_percent / 100.0f)));
+}
+
+void ProgressBarWidget::draw(DisplayDriver* d) {
+    drawProgressBar(d, _bounds.x, _bounds.y, _bounds.w, _bounds.h, _percent);
+}
+
+// ---------------------------------------------------------------------------
+// StatusIconWidget
+// ---------------------------------------------------------------------------
+StatusIconWidget::StatusIconWidget(int16_t x, int16_t y)
+    : Widget(x, y, 3 * CHAR_W, CHAR_H), _state(ChannelState::OFF) {}
+
+void StatusIconWidget::set(ChannelState state) {
+    _state = state;
+    update(static_cast<int32_t>(state));
+}
+
+void StatusIconWidget::draw(DisplayDriver* d) {
+    drawStatusIcon(d, _bounds.x, _bounds.y, _state);
+}
+
+// ---------------------------------------------------------------------------
+// MenuItemWidget
+// ---------------------------------------------------------------------------
+MenuItemWidget::MenuItemWidget(int16_t y)
+    : Widget(0, y, 0, 10), _text(""), _selected(false) {}
+
+void MenuItemWidget::set(const char* text, bool selected) {
+    _text = text;
+    _selected = selected;
+    update(pointerKey(text) ^ (selected ? 1 : 0));
+}
+
+void MenuItemWidget::layout(DisplayDriver* d) {
+    _bounds.w = static_cast<int16_t>(d->width());
+}
+
+void MenuItemWidget::draw(DisplayDriver* d) {
+    drawMenuItem(d, _bounds.y, _text, _selected);
+}
+
+// ---------------------------------------------------------------------------
+// MarkerWidget
+// ---------------------------------------------------------------------------
+MarkerWidget::MarkerWidget(int16_t x, int16_t y)
+    : Widget(x, y + 1, 5, 9), _shown(false) {}
+
+void MarkerWidget::set(bool shown) {
+    _shown = shown;
+    update(shown ? 1 : 0);
+}
+
+void MarkerWidget::draw(DisplayDriver* d) {
+    if (!_shown) return;
+    int16_t x = _bounds.x, y = _bounds.y - 1;
+    d->drawTriangle(x, y + 1, x, y + 9, x + 4, y + 5);
+}
+
+// ---------------------------------------------------------------------------
+// WidgetGroup
+// ---------------------------------------------------------------------------
+WidgetGroup::WidgetGroup() : _count(0) {}
+
+void WidgetGroup::add(Widget* w) {
+    if (_count < MAX_WIDGETS) _items[_count++] = w;
+}
+
+void WidgetGroup::invalidate() {
+    for (uint8_t i = 0; i < _count; i++) _items[i]->invalidate();
+}
+
+uint8_t WidgetGroup::render(DisplayDriver* d) {
+    // Spread dirtiness to everything sharing pixels with a dirty widget
+    bool spread = true;
+    while (spread) {
+        spread = false;
+        for (uint8_t i = 0; i < _count; i++) {
+            if (!_items[i]->isDirty()) continue;
+            for (uint8_t j = 0; j < _count; j++) {
+                if (_items[j]->isDirty()) continue;
+                if (_items[i]->bounds().intersects(_items[j]->bounds())) {
+                    _items[j]->invalidate();
+                    spread = true;
+                }
+            }
+        }
+    }
+
+    // Erase every dirty box before drawing any, so a later widget's
+    // erase can't punch a hole in an earlier one
+    uint8_t drawn = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_items[i]->isDirty()) _items[i]->erase(d);
+    }
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_items[i]->isDirty()) {
+            _items[i]->paint(d);
+            drawn++;
+        }
+    }
+    return drawn;
+}
+
+} // namespace ui
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <Arduino.h>
+#include "drivers/display_driver.h"
+#include "core/channel.h"
+
+// Retained-mode layer over ui/widgets.h.
+//
+// Each widget owns a fixed box on screen and keeps the last value it
+// drew, quantised to what is actually visible (0.1F, one bar pixel, one
+// percent...). set() only marks it dirty when that visible value moves.
+// WidgetGroup::render() then re-rasterises just the dirty widgets:
+// clearRect() over their boxes, redraw, markDirty() so the driver can
+// limit the next flush to those regions. Screens that are not retained
+// still clear and redraw every frame through ui/widgets.h directly.
+
+namespace ui {
+
+struct Rect {
+    int16_t x, y, w, h;
+
+    bool intersects(const Rect& o) const {
+        return x < o.x + o.w && o.x < x + w && y < o.y + o.h && o.y < y + h;
+    }
+};
+
+class Widget {
+public:
+    Widget(int16_t x, int16_t y, int16_t w, int16_t h);
+    virtual ~Widget() {}
+
+    // Two-phase redraw, driven by WidgetGroup: erase() clears the box
+    // of a dirty widget, paint() draws it and reports the box
+    void erase(DisplayDriver* d);
+    void paint(DisplayDriver* d);
+
+    void invalidate()               { _dirty = true; }
+    bool isDirty() const            { return _dirty; }
+    const Rect& bounds() const      { return _bounds; }
+
+protected:
+    virtual void draw(DisplayDriver* d) = 0;
+    virtual void layout(DisplayDriver* d) {}    // Boxes that depend on the panel size
+
+    // Mark dirty if `key` (the quantised visible value) changed
+    void update(int32_t key);
+
+    Rect _bounds;
+
+private:
+    int32_t _key;
+    bool _dirty;
+};
+
+// Fixed text
+class LabelWidget : public Widget {
+public:
+    LabelWidget(int16_t x, int16_t y, uint8_t maxChars, uint8_t textSize = 1);
+
+    void set(const char* text);     // Literal/static, compared by pointer
+
+protected:
+    void draw(DisplayDriver* d) override;
+
+private:
+    const char* _text;
+    uint8_t _size;
+};
+
+// Number formatted with one float conversion: `fmt` gets the value
+// rounded to `resolution`. Formatting only happens on a visible change.
+class ValueWidget : public Widget {
+public:
+    ValueWidget(int16_t x, int16_t y, uint8_t maxChars, uint8_t textSize,
+                const char* fmt, float resolution, const char* blank = "");
+
+    void set(float value);
+    void setBlank();                // Show the placeholder instead
+
+protected:
+    void draw(DisplayDriver* d) override;
+
+private:
+    const char* _fmt;
+    const char* _blank;
+    float _resolution;
+    float _value;
+    bool _isBlank;
+    uint8_t _size;
+};
+
+// Full-width inverted banner, top or bottom
+class BannerWidget : public Widget {
+public:
+    explicit BannerWidget(bool footer = false);
+
+    void set(const char* text);     // Literal/static, compared by pointer
+
+protected:
+    void draw(DisplayDriver* d) override;
+    void layout(DisplayDriver* d) override;
+
+private:
+    const char* _text;
+    bool _footer;
+};
+
+class TempBarWidget : public Widget {
+public:
+    TempBarWidget(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    void set(float currentTemp, float targetTemp);
+
+protected:
+    void draw(DisplayDriver* d) override;
+
+private:
+    float _current;
+    float _target;
+};
+
+class ProgressBarWidget : public Widget {
+public:
+    ProgressBarWidget(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    void set(float percent);
+
+protected:
+    void draw(DisplayDriver* d) override;
+
+private:
+    float _percent;
+};
+
+class StatusIconWidget : public Widget {
+public:
+    StatusIconWidget(int16_t x, int16_t y);
+
+    void set(ChannelState state);
+
+protected:
+    void draw(DisplayDriver* d) override;
+
+private:
+    ChannelState _state;
+};
+
+class MenuItemWidget : public Widget {
+public:
+    explicit MenuItemWidget(int16_t y);
+
+    void set(const char* text, bool selected);
+
+protected:
+    void draw(DisplayDriver* d) override;
+    void layout(DisplayDriver* d) override;
+
+private:
+    const char* _text;
+    bool _selected;
+};
+
+// Selection pointer (filled triangle)
+class MarkerWidget : public Widget {
+public:
+    MarkerWidget(int16_t x, int16_t y);
+
+    void set(bool shown);
+
+protected:
+    void draw(DisplayDriver* d) override;
+
+private:
+    bool _shown;
+};
+
+// Widgets of one screen, drawn in insertion order. A redraw erases its
+// box first, so every widget overlapping a dirty one is redrawn with it
+// (in order) to keep the stacking intact.
+class WidgetGroup {
+public:
+    static const uint8_t MAX_WIDGETS = 32;
+
+    WidgetGroup();
+
+    void add(Widget* w);
+    void invalidate();
+    uint8_t render(DisplayDriver* d);   // Returns widgets drawn
+
+private:
+    Widget* _items[MAX_WIDGETS];
+    uint8_t _count;
+};
+
+} // namespace ui
@@ -19,9 +19,12 @@ void drawTempBar(DisplayDriver* d, int16_t x, int16_t y, int16_t w, int16_t h,
     if (ratio < 0.0f) ratio = 0.0f;
     if (ratio > 1.0f) ratio = 1.0f;
 
+    // Orange while heating up, green once at target (colour panels only)
     int16_t fillW = static_cast<int16_t>((w - 2) * ratio);
     if (fillW > 0) {
+        d->setColor(ratio >= 1.0f ? COLOR_GREEN : COLOR_ORANGE);
         d->fillRect(x + 1, y + 1, fillW, h - 2);
+        d->setColor(COLOR_WHITE);
     }
 
     // Draw a single-pixel target marker at the right inner edge
@@ -33,19 +36,22 @@ void drawTempBar(DisplayDriver* d, int16_t x, int16_t y, int16_t w, int16_t h,
 // ---------------------------------------------------------------------------
 void drawStatusIcon(DisplayDriver* d, int16_t x, int16_t y, ChannelState state) {
     const char* label;
+    uint16_t color;
     switch (state) {
-        case ChannelState::OFF:       label = "OFF"; break;
-        case ChannelState::HEATING:   label = "HEA"; break;
-        case ChannelState::HOLDING:   label = "HLD"; break;
-        case ChannelState::COOLDOWN:  label = "COL"; break;
-        case ChannelState::AUTOTUNE:  label = "TUN"; break;
-        case ChannelState::FAULT:     label = "FLT"; break;
-        default:                      label = "???"; break;
+        case ChannelState::OFF:       label = "OFF"; color = COLOR_GREY;   break;
+        case ChannelState::HEATING:   label = "HEA"; color = COLOR_ORANGE; break;
+        case ChannelState::HOLDING:   label = "HLD"; color = COLOR_GREEN;  break;
+        case ChannelState::COOLDOWN:  label = "COL"; color = COLOR_CYAN;   break;
+        case ChannelState::AUTOTUNE:  label = "TUN"; color = COLOR_ORANGE; break;
+        case ChannelState::FAULT:     label = "FLT"; color = COLOR_RED;    break;
+        default:                      label = "???"; color = COLOR_WHITE;  break;
     }
 
     d->setTextSize(1);
     d->setCursor(x, y);
+    d->setColor(color);
     d->print(label);
+    d->setColor(COLOR_WHITE);
 }
 
 // ---------------------------------------------------------------------------
@@ -1,7 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
-#include "drivers/display_ssd1306.h"
+#include "drivers/display_driver.h"
 #include "core/channel.h"
 
 namespace ui {
@@ -0,0 +1,167 @@
+#pragma once
+
+// Closed-loop harness: a real Channel (state machine, PIDBank slot,
+// autotuner, SSRDriver on the simulated LEDC) wired to a ThermalPlant
+// through a real Thermocouple fed MAX31855 frames. Mirrors one channel
+// of taskPID: read, update(), PIDBank::compute(dt), applyOutput(),
+// publishSnapshot().
+//
+// Expects the firmware sources and sim_hal.h to be compiled into the
+// same test program.
+
+#include <vector>
+#include <functional>
+#include "core/channel.h"
+#include "core/pid_bank.h"
+#include "core/clock.h"
+#include "drivers/thermocouple.h"
+#include "sim_hal.h"
+#include "thermal_plant.h"
+
+// MAX31855 frame for a junction at tcC (0.25 C steps, as the chip reports)
+inline uint32_t max31855Frame(float tcC, float cjC = 25.0f) {
+    int32_t tc = (int32_t)lroundf(tcC * 4.0f);
+    int32_t cj = (int32_t)lroundf(cjC * 16.0f);
+    tc = constrain(tc, (int32_t)-8192, (int32_t)8191);
+    cj = constrain(cj, (int32_t)-2048, (int32_t)2047);
+    return ((uint32_t)(tc & 0x3FFF) << 18) | ((uint32_t)(cj & 0x0FFF) << 4);
+}
+
+// Clock backed by the simulated timebase
+class SimClock : public Clock {
+public:
+    uint32_t nowMs() const override { return millis(); }
+};
+
+struct StepMetrics {
+    float riseTimeS;            // 10% -> 90% of the step, -1 = never
+    float overshootF;           // Peak above setpoint
+    float settlingTimeS;        // Time of last exit from +/- band
+    float rippleF;              // Peak-to-peak over the final window
+    float steadyStateErrorF;    // Mean error over the final window
+    bool settled;               // Final window stayed inside the band
+};
+
+class ClosedLoopSim {
+public:
+    explicit ClosedLoopSim(const PlantParams& params = PlantParams(), uint8_t ch = 0)
+        : _plant((sim::reset(), params)), _channel(_clock), _ch(ch),
+          _fault(0), _lastTickMs(0) {
+        _channel.begin(ch, SSR_PINS[ch], &_tc, _bank.view(ch));
+        _channel.setPIDTunings(PID_KP_DEFAULT, PID_KI_DEFAULT, PID_KD_DEFAULT);
+        _tc.processFrame(max31855Frame(_plant.temperatureC()));
+    }
+
+    Channel& channel()                  { return _channel; }
+    ThermalPlant& plant()               { return _plant; }
+    Thermocouple& thermocouple()        { return _tc; }
+    bool heaterOn() const               { return sim::pinLevel(SSR_PINS[_ch]); }
+    float seconds() const               { return (float)sim::nowUs() / 1e6f; }
+
+    // Report a MAX31855 fault (MAX31855_FAULT_*) instead of readings; 0 clears
+    void setTCFault(uint8_t fault)      { _fault = fault; }
+
+    // Trace of true coil temperature (F), one sample per PID tick
+    const std::vector<float>& trace() const { return _trace; }
+    float tickSeconds() const           { return (float)PID_SAMPLE_MS / 1000.0f; }
+
+    void run(float seconds) {
+        runUntil([]() { return false; }, seconds);
+    }
+
+    // Run until `done` holds after a PID tick; false on timeout
+    bool runUntil(const std::function<bool()>& done, float maxSeconds) {
+        uint32_t stepUs = (uint32_t)(_plant.stepSeconds() * 1e6f);
+        uint64_t endUs = sim::nowUs() + (uint64_t)(maxSeconds * 1e6f);
+
+        while (sim::nowUs() < endUs) {
+            sim::advanceUs(stepUs);
+            _plant.step(heaterOn());
+
+            if (millis() - _lastTickMs >= PID_SAMPLE_MS) {
+                tick();
+                if (done()) return true;
+            }
+        }
+        return false;
+    }
+
+    // Enable at setpointF from the current state and measure the response
+    StepMetrics stepResponse(float setpointF, float seconds,
+                             float bandF = 5.0f, float windowS = 60.0f) {
+        float startF = _plant.temperatureF();
+        size_t first = _trace.size();
+
+        _channel.setTargetTemp(setpointF);
+        _channel.enable();
+        run(seconds);
+
+        std::vector<float> t(_trace.begin() + first, _trace.end());
+        return analyze(t, tickSeconds(), startF, setpointF, bandF, windowS);
+    }
+
+    // Relay autotune at setpointF; returns the (possibly invalid) result
+    AutotuneResult autotune(float setpointF, float maxSeconds) {
+        _channel.setTargetTemp(setpointF);
+        _channel.startAutotune();
+        runUntil([this]() { return !_channel.isAutotuning(); }, maxSeconds);
+        return _channel.getAutotuneResult();
+    }
+
+    static StepMetrics analyze(const std::vector<float>& t, float dtS, float startF,
+                               float setpointF, float bandF, float windowS) {
+        StepMetrics m = { -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, false };
+        if (t.empty()) return m;
+
+        float span = setpointF - startF;
+        int i10 = -1, i90 = -1, lastOut = -1;
+        float peak = t[0];
+        for (size_t i = 0; i < t.size(); i++) {
+            float frac = span != 0.0f ? (t[i] - startF) / span : 1.0f;
+            if (i10 < 0 && frac >= 0.1f) i10 = (int)i;
+            if (i90 < 0 && frac >= 0.9f) i90 = (int)i;
+            if (t[i] > peak) peak = t[i];
+            if (fabsf(t[i] - setpointF) > bandF) lastOut = (int)i;
+        }
+        if (i10 >= 0 && i90 >= 0) m.riseTimeS = (float)(i90 - i10) * dtS;
+        m.overshootF = peak > setpointF ? peak - setpointF : 0.0f;
+        m.settlingTimeS = (float)(lastOut + 1) * dtS;
+
+        size_t window = (size_t)(windowS / dtS);
+        if (window == 0 || window > t.size()) window = t.size();
+        size_t from = t.size() - window;
+        float lo = t[from], hi = t[from], sum = 0.0f;
+        for (size_t i = from; i < t.size(); i++) {
+            lo = fminf(lo, t[i]);
+            hi = fmaxf(hi, t[i]);
+            sum += t[i];
+        }
+        m.rippleF = hi - lo;
+        m.steadyStateErrorF = sum / (float)window - setpointF;
+        m.settled = (size_t)(lastOut + 1) <= from;
+        return m;
+    }
+
+private:
+    SimClock _clock;
+    ThermalPlant _plant;
+    Thermocouple _tc;
+    PIDBank<NUM_CHANNELS> _bank;
+    Channel _channel;
+    uint8_t _ch;
+    uint8_t _fault;
+    uint32_t _lastTickMs;
+    std::vector<float> _trace;
+
+    void tick() {
+        uint32_t now = millis();
+        _tc.processFrame(_fault ? (MAX31855_FAULT_BIT | _fault)
+                                : max31855Frame(_plant.measuredC()));
+        _channel.update();
+        _bank.compute(now - _lastTickMs);
+        _channel.applyOutput();
+        _channel.publishSnapshot();
+        _lastTickMs = now;
+        _trace.push_back(_plant.temperatureF());
+    }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+// Host shim for the subset of the Arduino-ESP32 core the firmware uses,
+// so core/ and drivers/ compile in the native test env. Only
+// declarations live here: a test either links the simulator
+// (sim/sim_hal.h) or provides its own millis() stub (test_pid.cpp).
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <algorithm>
+
+#define HIGH        0x1
+#define LOW         0x0
+#define INPUT       0x01
+#define OUTPUT      0x03
+#define RISING      0x01
+#define FALLING     0x02
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define F(s)        (s)
+
+using std::min;
+using std::max;
+using std::abs;
+
+template <typename T>
+T constrain(T v, T lo, T hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+uint32_t millis();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t irq, void (*isr)(), int mode);
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+void pinMatrixOutDetach(uint8_t pin, bool invertOut, bool invertEnable);
+
+void tone(uint8_t pin, unsigned int freq, unsigned long durationMs = 0);
+void noTone(uint8_t pin);
+
+class HostSerial {
+public:
+    void begin(unsigned long) {}
+    void print(const char* s)   { fputs(s, stdout); }
+    void println(const char* s) { puts(s); }
+    template <typename... Args>
+    void printf(const char* fmt, Args... args) { ::printf(fmt, args...); }
+};
+static HostSerial Serial __attribute__((unused));
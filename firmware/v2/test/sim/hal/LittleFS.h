@@ -0,0 +1,135 @@
+#pragma once
+
+// Host shim: LittleFS as an in-memory map of paths to byte vectors.
+// hostfs::state().failOpens / writeLimit inject flash failures: the next
+// N opens fail, or writes stop after that many more bytes.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace hostfs {
+
+struct State {
+    std::map<std::string, std::vector<uint8_t>> files;
+    uint32_t failOpens;
+    size_t writeLimit;          // Bytes still writable; SIZE_MAX = no limit
+};
+
+inline State& state() {
+    static State s = { {}, 0, (size_t)-1 };
+    return s;
+}
+
+inline void reset() {
+    state().files.clear();
+    state().failOpens = 0;
+    state().writeLimit = (size_t)-1;
+}
+
+}  // namespace hostfs
+
+class File {
+public:
+    File() : _path(), _pos(0), _open(false), _dir(false), _next(0) {}
+
+    explicit operator bool() const { return _open; }
+
+    size_t size() const             { return _open && !_dir ? data().size() : 0; }
+    size_t position() const         { return _pos; }
+    bool seek(size_t pos)           { _pos = pos; return _open; }
+    int available() const           { return _pos < size() ? (int)(size() - _pos) : 0; }
+    const char* name() const        { size_t s = _path.rfind('/'); return _path.c_str() + (s == std::string::npos ? 0 : s + 1); }
+    void close()                    { _open = false; }
+
+    size_t read(uint8_t* buf, size_t len) {
+        if (!_open || _dir || _pos >= size()) return 0;
+        size_t n = std::min(len, size() - _pos);
+        memcpy(buf, data().data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+
+    size_t write(const uint8_t* buf, size_t len) {
+        if (!_open || _dir) return 0;
+        size_t& limit = hostfs::state().writeLimit;
+        size_t n = std::min(len, limit);
+        if (limit != (size_t)-1) limit -= n;
+        std::vector<uint8_t>& d = data();
+        if (d.size() < _pos + n) d.resize(_pos + n);
+        memcpy(d.data() + _pos, buf, n);
+        _pos += n;
+        return n;
+    }
+
+    File openNextFile() {
+        File f;
+        if (!_open || !_dir) return f;
+        std::string prefix = _path + "/";
+        size_t i = 0;
+        for (auto& e : hostfs::state().files) {
+            if (e.first.compare(0, prefix.size(), prefix) != 0) continue;
+            if (i++ < _next) continue;
+            _next++;
+            f._path = e.first;
+            f._open = true;
+            return f;
+        }
+        return f;
+    }
+
+private:
+    friend class LittleFSClass;
+    std::string _path;
+    size_t _pos;
+    bool _open;
+    bool _dir;
+    size_t _next;
+
+    std::vector<uint8_t>& data() const { return hostfs::state().files[_path]; }
+};
+
+class LittleFSClass {
+public:
+    bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+
+    File open(const char* path, const char* mode = "r") {
+        File f;
+        hostfs::State& s = hostfs::state();
+        if (s.failOpens) { s.failOpens--; return f; }
+        f._path = path;
+        if (isDir(path)) {
+            f._dir = f._open = true;
+            return f;
+        }
+        bool exists = s.files.count(path) != 0;
+        if (mode[0] == 'r' && !exists) return f;
+        if (mode[0] == 'w') s.files[path].clear();
+        if (mode[0] == 'a') f._pos = s.files[path].size();
+        s.files[path];
+        f._open = true;
+        return f;
+    }
+
+    bool exists(const char* path)   { return isDir(path) || hostfs::state().files.count(path) != 0; }
+    bool mkdir(const char* path)    { dirs()[path] = true; return true; }
+    bool remove(const char* path)   { return hostfs::state().files.erase(path) != 0; }
+
+    bool rename(const char* from, const char* to) {
+        auto& files = hostfs::state().files;
+        auto it = files.find(from);
+        if (it == files.end()) return false;
+        files[to] = it->second;
+        files.erase(from);
+        return true;
+    }
+
+private:
+    static std::map<std::string, bool>& dirs() { static std::map<std::string, bool> d; return d; }
+    static bool isDir(const char* path)         { return dirs().count(path) != 0; }
+};
+
+static LittleFSClass LittleFS __attribute__((unused));
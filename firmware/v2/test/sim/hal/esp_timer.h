@@ -0,0 +1,23 @@
+#pragma once
+
+// Host shim for esp_timer; sim/sim_hal.h fires periodic callbacks as
+// simulated time advances.
+
+#include <stdint.h>
+#include "driver/ledc.h"    // esp_err_t
+
+typedef struct sim_esp_timer* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void* arg);
+typedef enum { ESP_TIMER_TASK = 0 } esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void* arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char* name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs);
+int64_t esp_timer_get_time();
@@ -0,0 +1,12 @@
+#pragma once
+
+// Host shim: FreeRTOS types used in headers shared with the native env
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
@@ -0,0 +1,10 @@
+#pragma once
+
+// Host shim: queues are not simulated; sends are accepted and dropped
+
+#include "freertos/FreeRTOS.h"
+
+typedef void* QueueHandle_t;
+
+inline BaseType_t xQueueSend(QueueHandle_t, const void*, TickType_t)  { return pdTRUE; }
+inline BaseType_t xQueueOverwrite(QueueHandle_t, const void*)        { return pdTRUE; }
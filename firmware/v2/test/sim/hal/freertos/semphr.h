@@ -0,0 +1,13 @@
+#pragma once
+
+// Host shim: tests are single-threaded; mutexes always succeed
+
+#include "freertos/FreeRTOS.h"
+
+typedef void* SemaphoreHandle_t;
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFUL)
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex()                { static int m; return &m; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t)             { return pdTRUE; }
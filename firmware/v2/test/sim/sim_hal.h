@@ -0,0 +1,216 @@
+#pragma once
+
+// Simulated hardware behind the host shims in sim/hal/: one microsecond
+// clock, latched GPIO levels, LEDC channels evaluated as timed outputs
+// and periodic esp_timer callbacks. Header-only; include it from exactly
+// one test translation unit.
+//
+// Time only moves through sim::advanceUs(), so a closed-loop run is
+// deterministic and as fast as the host can integrate it.
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include <esp_timer.h>
+
+namespace sim {
+
+static const uint8_t  GPIO_COUNT = 40;
+static const uint8_t  LEDC_CHANNELS = LEDC_CHANNEL_MAX;
+static const uint8_t  TIMER_SLOTS = 4;
+
+struct LedcTimer {
+    uint32_t freqHz;
+    uint32_t full;              // 1 << duty_resolution
+};
+
+struct LedcChannel {
+    bool routed;                // Output matrix connects it to gpio
+    uint8_t gpio;
+    uint8_t timer;
+    bool running;
+    uint32_t duty, hpoint;
+    bool pending;               // ledc_update_duty() latches at period end
+    uint32_t nextDuty, nextHpoint;
+};
+
+struct PeriodicTimer {
+    esp_timer_cb_t cb;
+    void* arg;
+    uint64_t periodUs;
+    uint64_t nextUs;
+    bool active;
+};
+
+struct State {
+    uint64_t nowUs;
+    uint8_t gpio[GPIO_COUNT];
+    LedcTimer timers[LEDC_TIMER_MAX];
+    LedcChannel ledc[LEDC_CHANNELS];
+    PeriodicTimer periodic[TIMER_SLOTS];
+};
+
+static State state;
+
+// Power-on reset of time, pins and channels. Timer configuration and
+// periodic timers survive, like the driver statics that created them.
+inline void reset() {
+    state.nowUs = 0;
+    memset(state.gpio, 0, sizeof(state.gpio));
+    memset(state.ledc, 0, sizeof(state.ledc));
+    for (uint8_t i = 0; i < TIMER_SLOTS; i++) {
+        state.periodic[i].nextUs = state.periodic[i].periodUs;
+    }
+}
+
+inline uint64_t nowUs() { return state.nowUs; }
+
+inline uint64_t periodUs(const LedcChannel& c) {
+    uint32_t hz = state.timers[c.timer].freqHz;
+    return hz ? 1000000ULL / hz : 0;
+}
+
+inline bool ledcLevel(const LedcChannel& c, uint64_t t) {
+    uint64_t period = periodUs(c);
+    if (!c.running || c.duty == 0 || period == 0) return false;
+    uint64_t full = state.timers[c.timer].full;
+    uint64_t phase = (t % period) * full / period;
+    return phase >= c.hpoint && phase < (uint64_t)c.hpoint + c.duty;
+}
+
+// Output level seen by whatever is wired to the pin (the SSR input)
+inline bool pinLevel(uint8_t pin) {
+    for (uint8_t i = 0; i < LEDC_CHANNELS; i++) {
+        if (state.ledc[i].routed && state.ledc[i].gpio == pin) return ledcLevel(state.ledc[i], state.nowUs);
+    }
+    return pin < GPIO_COUNT && state.gpio[pin];
+}
+
+inline void advanceUs(uint64_t us) {
+    uint64_t target = state.nowUs + us;
+
+    for (uint8_t i = 0; i < LEDC_CHANNELS; i++) {
+        LedcChannel& c = state.ledc[i];
+        uint64_t period = periodUs(c);
+        if (c.pending && period && (state.nowUs / period) != (target / period)) {
+            c.duty = c.nextDuty;
+            c.hpoint = c.nextHpoint;
+            c.pending = false;
+        }
+    }
+
+    for (;;) {
+        PeriodicTimer* due = nullptr;
+        for (uint8_t i = 0; i < TIMER_SLOTS; i++) {
+            PeriodicTimer& p = state.periodic[i];
+            if (p.active && p.nextUs <= target && (!due || p.nextUs < due->nextUs)) due = &p;
+        }
+        if (!due) break;
+        state.nowUs = due->nextUs;
+        due->nextUs += due->periodUs;
+        due->cb(due->arg);
+    }
+    state.nowUs = target;
+}
+
+} // namespace sim
+
+// --- Arduino core ---
+
+uint32_t millis()                       { return (uint32_t)(sim::state.nowUs / 1000); }
+void delay(uint32_t ms)                 { sim::advanceUs((uint64_t)ms * 1000); }
+void delayMicroseconds(uint32_t us)     { sim::advanceUs(us); }
+void pinMode(uint8_t, uint8_t)          {}
+void digitalWrite(uint8_t pin, uint8_t val) { if (pin < sim::GPIO_COUNT) sim::state.gpio[pin] = val ? 1 : 0; }
+int digitalRead(uint8_t pin)            { return pin < sim::GPIO_COUNT ? sim::state.gpio[pin] : 0; }
+void attachInterrupt(uint8_t, void (*)(), int) {}
+void tone(uint8_t, unsigned int, unsigned long) {}
+void noTone(uint8_t)                    {}
+
+void pinMatrixOutDetach(uint8_t pin, bool, bool) {
+    for (uint8_t i = 0; i < sim::LEDC_CHANNELS; i++) {
+        if (sim::state.ledc[i].gpio == pin) sim::state.ledc[i].routed = false;
+    }
+}
+
+// --- LEDC ---
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* conf) {
+    if (conf->timer_num >= LEDC_TIMER_MAX || conf->freq_hz == 0) return ESP_FAIL;
+    sim::state.timers[conf->timer_num].freqHz = conf->freq_hz;
+    sim::state.timers[conf->timer_num].full = 1UL << conf->duty_resolution;
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* conf) {
+    if (conf->channel >= sim::LEDC_CHANNELS) return ESP_FAIL;
+    sim::LedcChannel& c = sim::state.ledc[conf->channel];
+    c.routed = true;
+    c.gpio = (uint8_t)conf->gpio_num;
+    c.timer = conf->timer_sel;
+    c.duty = conf->duty;
+    c.hpoint = conf->hpoint;
+    c.pending = false;
+    c.running = true;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty_with_hpoint(ledc_mode_t, ledc_channel_t ch, uint32_t duty, uint32_t hpoint) {
+    if (ch >= sim::LEDC_CHANNELS) return ESP_FAIL;
+    sim::state.ledc[ch].nextDuty = duty;
+    sim::state.ledc[ch].nextHpoint = hpoint;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t mode, ledc_channel_t ch, uint32_t duty) {
+    return ledc_set_duty_with_hpoint(mode, ch, duty, 0);
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t, ledc_channel_t ch) {
+    if (ch >= sim::LEDC_CHANNELS) return ESP_FAIL;
+    sim::LedcChannel& c = sim::state.ledc[ch];
+    if (!c.running) {
+        // Restart after ledc_stop(): the new duty applies immediately
+        c.duty = c.nextDuty;
+        c.hpoint = c.nextHpoint;
+        c.running = true;
+        c.pending = false;
+    } else {
+        c.pending = true;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_stop(ledc_mode_t, ledc_channel_t ch, uint32_t) {
+    if (ch >= sim::LEDC_CHANNELS) return ESP_FAIL;
+    sim::state.ledc[ch].running = false;
+    sim::state.ledc[ch].pending = false;
+    return ESP_OK;
+}
+
+// --- esp_timer ---
+
+struct sim_esp_timer { uint8_t slot; };
+static sim_esp_timer simTimerHandles[sim::TIMER_SLOTS];
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    for (uint8_t i = 0; i < sim::TIMER_SLOTS; i++) {
+        sim::PeriodicTimer& p = sim::state.periodic[i];
+        if (p.cb) continue;
+        p.cb = args->callback;
+        p.arg = args->arg;
+        simTimerHandles[i].slot = i;
+        *out = &simTimerHandles[i];
+        return ESP_OK;
+    }
+    return ESP_FAIL;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    sim::PeriodicTimer& p = sim::state.periodic[timer->slot];
+    p.periodUs = periodUs;
+    p.nextUs = sim::state.nowUs + periodUs;
+    p.active = true;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() { return (int64_t)sim::state.nowUs; }
@@ -0,0 +1,65 @@
+#pragma once
+
+// First-order-plus-dead-time model of a coil heater:
+//
+//   C * dT/dt = P * u(t - L) - k * (T - Tamb)
+//
+// C = mass * specific heat (J/K), P = heater wattage, k = lumped
+// convective/conductive loss (W/K), L = transport delay from the heater
+// element to the thermocouple junction, u = SSR state (0/1).
+// Steady-state rise at full power is P/k, time constant C/k.
+
+#include <stdint.h>
+#include <vector>
+
+struct PlantParams {
+    float massG = 60.0f;            // Coil + sheath
+    float specificHeat = 0.5f;      // J/(g*K), stainless
+    float heaterW = 100.0f;
+    float lossWPerK = 0.15f;
+    float ambientC = 25.0f;
+    float deadTimeS = 2.0f;
+    float tcNoiseC = 0.0f;          // Peak uniform noise on the reading
+};
+
+class ThermalPlant {
+public:
+    explicit ThermalPlant(const PlantParams& p = PlantParams(), float stepS = 0.001f)
+        : _p(p), _stepS(stepS), _tempC(p.ambientC), _head(0), _noise(0x2545F491u) {
+        size_t n = (size_t)(p.deadTimeS / stepS + 0.5f);
+        _delay.assign(n > 0 ? n : 1, 0.0f);
+    }
+
+    // Integrate one step with the SSR at `heaterOn`
+    void step(bool heaterOn) {
+        float u = _delay[_head];
+        _delay[_head] = heaterOn ? 1.0f : 0.0f;
+        _head = (_head + 1) % _delay.size();
+
+        float capacity = _p.massG * _p.specificHeat;
+        float q = _p.heaterW * u - _p.lossWPerK * (_tempC - _p.ambientC);
+        _tempC += q / capacity * _stepS;
+    }
+
+    float temperatureC() const          { return _tempC; }
+    float temperatureF() const          { return _tempC * 9.0f / 5.0f + 32.0f; }
+    void setTemperatureC(float c)       { _tempC = c; }
+    float stepSeconds() const           { return _stepS; }
+    const PlantParams& params() const   { return _p; }
+
+    // What the thermocouple sees, with optional deterministic noise
+    float measuredC() {
+        if (_p.tcNoiseC <= 0.0f) return _tempC;
+        _noise ^= _noise << 13; _noise ^= _noise >> 17; _noise ^= _noise << 5;
+        float r = (float)(_noise & 0xFFFF) / 65535.0f * 2.0f - 1.0f;
+        return _tempC + r * _p.tcNoiseC;
+    }
+
+private:
+    PlantParams _p;
+    float _stepS;
+    float _tempC;
+    std::vector<float> _delay;      // Heater history, deadTimeS long
+    size_t _head;
+    uint32_t _noise;
+};
@@ -1,5 +1,5 @@
 // ============================================================
-// Unit Tests: Channel State Machine
+// Unit Tests: Channel State Machine + closed-loop benchmarks
 // Run with: pio test -e test
 // ============================================================
 
@@ -7,92 +7,340 @@
 
 #include <unity.h>
 
-// These tests verify the channel state machine logic.
-// Since Channel depends on hardware (GPIO, MAX31855), full
-// integration tests require hardware or mocks.
-// Here we test the state transition logic conceptually.
+// Channel runs against the host simulator: simulated LEDC/GPIO
+// (sim/sim_hal.h), a MAX31855 fed from a first-order-plus-dead-time
+// coil model (sim/thermal_plant.h), and the taskPID loop in
+// sim/closed_loop.h. Minutes of heating run in milliseconds.
+
+#include "../src/core/pid.cpp"
+#include "../src/core/pid_bank.cpp"
+#include "../src/core/autotune.cpp"
+#include "../src/core/channel.cpp"
+#include "../src/drivers/thermocouple.cpp"
+#include "../src/drivers/ssr.cpp"
+#include "../src/drivers/ssr_scheduler.cpp"
+#include "sim/closed_loop.h"
+
+static const float F_PER_C = 9.0f / 5.0f;
+
+static float toC(float f) { return (f - 32.0f) / F_PER_C; }
 
 void setUp(void) {}
 void tearDown(void) {}
 
-// State transition tests (logic verification)
+// --- State transitions ---
 
 void test_channel_state_off_to_heating() {
-    // When channel.enable() is called from OFF state,
-    // channel should transition to HEATING
-    // (Verified via integration test with hardware)
-    TEST_PASS_MESSAGE("OFF -> enable() -> HEATING");
+    ClosedLoopSim s;
+    TEST_ASSERT_TRUE(s.channel().getState() == ChannelState::OFF);
+    s.channel().enable();
+    TEST_ASSERT_TRUE(s.channel().getState() == ChannelState::HEATING);
 }
 
 void test_channel_state_heating_to_holding() {
-    // When current temp comes within TEMP_HOLDING_BAND_F of target,
-    // state should transition from HEATING to HOLDING
-    TEST_PASS_MESSAGE("HEATING -> within 10F of target -> HOLDING");
+    ClosedLoopSim s;
+    s.channel().setTargetTemp(400.0f);
+    s.channel().enable();
+    bool holding = s.runUntil([&]() {
+        return s.channel().getState() == ChannelState::HOLDING;
+    }, 600.0f);
+    TEST_ASSERT_TRUE(holding);
+    TEST_ASSERT_FLOAT_WITHIN(TEMP_HOLDING_BAND_F, 400.0f, s.channel().getCurrentTemp());
 }
 
 void test_channel_state_holding_to_heating() {
-    // When temp drifts beyond TEMP_HEATING_BAND_F from target,
-    // state should transition back from HOLDING to HEATING
-    TEST_PASS_MESSAGE("HOLDING -> >20F from target -> HEATING");
+    ClosedLoopSim s;
+    s.channel().setTargetTemp(400.0f);
+    s.channel().enable();
+    s.runUntil([&]() { return s.channel().getState() == ChannelState::HOLDING; }, 600.0f);
+
+    // Raising the target by more than the heating band re-enters HEATING
+    s.channel().setTargetTemp(400.0f + TEMP_HEATING_BAND_F + 10.0f);
+    s.run(1.0f);
+    TEST_ASSERT_TRUE(s.channel().getState() == ChannelState::HEATING);
 }
 
 void test_channel_state_disable_hot_to_cooldown() {
-    // When channel.disable() is called while temp > 150F,
-    // should go to COOLDOWN (not directly OFF)
-    TEST_PASS_MESSAGE("active + disable() + temp>150F -> COOLDOWN");
+    ClosedLoopSim s;
+    s.plant().setTemperatureC(toC(400.0f));
+    s.run(1.0f);
+    s.channel().enable();
+    s.channel().disable();
+    TEST_ASSERT_TRUE(s.channel().getState() == ChannelState::COOLDOWN);
+    TEST_ASSERT_FALSE(s.heaterOn());
 }
 
 void test_channel_state_cooldown_to_off() {
-    // When temp drops below 150F in COOLDOWN,
-    // should transition to OFF
-    TEST_PASS_MESSAGE("COOLDOWN + temp<150F -> OFF");
+    ClosedLoopSim s;
+    s.plant().setTemperatureC(toC(300.0f));
+    s.run(1.0f);
+    s.channel().enable();
+    s.channel().disable();
+
+    bool off = s.runUntil([&]() {
+        return s.channel().getState() == ChannelState::OFF;
+    }, 3600.0f);
+    TEST_ASSERT_TRUE(off);
+    TEST_ASSERT_LESS_THAN(TEMP_COOLDOWN_THRESH_F + 1.0f, s.channel().getCurrentTemp());
 }
 
 void test_channel_state_tc_error_to_fault() {
-    // When thermocouple has TC_ERROR_COUNT_MAX consecutive errors
-    // while channel is active, should transition to FAULT
-    TEST_PASS_MESSAGE("active + TC errors >= 10 -> FAULT");
+    ClosedLoopSim s;
+    s.channel().enable();
+    s.run(1.0f);
+    s.setTCFault(MAX31855_FAULT_OPEN);
+
+    bool fault = s.runUntil([&]() { return s.channel().isFaulted(); }, 10.0f);
+    TEST_ASSERT_TRUE(fault);
+    TEST_ASSERT_EQUAL_UINT8(TC_ERROR_COUNT_MAX, s.channel().getTCErrorCount());
+    TEST_ASSERT_FALSE(s.heaterOn());
 }
 
 void test_channel_state_overtemp_to_fault() {
-    // When temperature exceeds TEMP_ABS_MAX_F (1050F),
-    // should immediately transition to FAULT
-    TEST_PASS_MESSAGE("active + temp >= 1050F -> FAULT");
+    ClosedLoopSim s;
+    s.channel().enable();
+    s.run(1.0f);
+    s.plant().setTemperatureC(toC(TEMP_ABS_MAX_F + 5.0f));
+    s.run(0.5f);
+    TEST_ASSERT_TRUE(s.channel().isFaulted());
+    TEST_ASSERT_FALSE(s.channel().getPID().isEnabled());
 }
 
 void test_channel_state_fault_blocks_enable() {
-    // When in FAULT state, enable() should be rejected
-    TEST_PASS_MESSAGE("FAULT + enable() -> stays FAULT");
+    ClosedLoopSim s;
+    s.channel().enable();
+    s.setTCFault(MAX31855_FAULT_SHORT_GND);
+    s.runUntil([&]() { return s.channel().isFaulted(); }, 10.0f);
+
+    s.channel().enable();
+    TEST_ASSERT_TRUE(s.channel().getState() == ChannelState::FAULT);
 }
 
+// --- Autotune ---
+
 void test_channel_autotune_state() {
-    // startAutotune() should put channel in AUTOTUNE state
-    // and disable PID controller
-    TEST_PASS_MESSAGE("startAutotune() -> AUTOTUNE state, PID disabled");
+    ClosedLoopSim s;
+    s.channel().startAutotune();
+    TEST_ASSERT_TRUE(s.channel().getState() == ChannelState::AUTOTUNE);
+    TEST_ASSERT_FALSE(s.channel().getPID().isEnabled());
+
+    // Relay starts on full power below the setpoint
+    s.run(1.5f);
+    TEST_ASSERT_TRUE(s.heaterOn());
 }
 
 void test_channel_autotune_complete_returns_to_heating() {
-    // When autotune completes, channel should return to HEATING
-    // with new PID values applied
-    TEST_PASS_MESSAGE("AUTOTUNE complete -> HEATING with new tunings");
+    ClosedLoopSim s;
+    AutotuneResult r = s.autotune(600.0f, 300.0f);
+
+    TEST_ASSERT_TRUE(r.valid);
+    TEST_ASSERT_TRUE(s.channel().isActive());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, r.kp, s.channel().getPID().getKp());
 }
 
+// --- Control ---
+
 void test_channel_temp_clamping() {
-    // setTargetTemp should clamp to [0, 999] range
-    // Values below 0 become 0, above 999 become 999
-    TEST_PASS_MESSAGE("setTargetTemp(-50) -> 0F, setTargetTemp(1500) -> 999F");
+    ClosedLoopSim s;
+    s.channel().setTargetTemp(-50.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, TEMP_MIN_F, s.channel().getTargetTemp());
+    s.channel().setTargetTemp(1500.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, TEMP_MAX_F, s.channel().getTargetTemp());
 }
 
 void test_channel_ssr_duty_cycle() {
-    // With PID output at 50%, SSR should be on for 500ms
-    // out of 1000ms period
-    TEST_PASS_MESSAGE("PID=50% -> SSR on 500ms/1000ms period");
+    ClosedLoopSim s;
+    SSRDriver& ssr = s.channel().getSSR();
+    ssr.setDutyCycle(50.0f);
+    TEST_ASSERT_EQUAL_UINT32(SSR_PERIOD_MS * 500, ssr.getOnTimeUs());
+
+    // Measure the simulated pin over two full periods after the latch.
+    // Advance the HAL directly: ticking the OFF channel would force the SSR off.
+    sim::advanceUs(SSR_PERIOD_MS * 1000UL);
+    uint32_t onMs = 0;
+    for (uint32_t i = 0; i < 2 * SSR_PERIOD_MS; i++) {
+        sim::advanceUs(1000);
+        if (s.heaterOn()) onMs++;
+    }
+    TEST_ASSERT_UINT32_WITHIN(2, SSR_PERIOD_MS, onMs);
 }
 
 void test_channel_ssr_min_on_time() {
-    // With very low PID output (below SSR_MIN_ON_MS threshold),
-    // SSR should stay completely off (avoid flickering)
-    TEST_PASS_MESSAGE("PID < 5% -> SSR stays off (min on-time threshold)");
+    ClosedLoopSim s;
+    SSRDriver& ssr = s.channel().getSSR();
+    ssr.setDutyCycle(100.0f * (SSR_MIN_ON_MS - 1) / SSR_PERIOD_MS);
+    TEST_ASSERT_EQUAL_UINT32(0, ssr.getOnTimeUs());
+    TEST_ASSERT_FALSE(ssr.isOn());
+}
+
+void test_channel_ssr_is_on_follows_duty() {
+    ClosedLoopSim s;
+    SSRDriver& ssr = s.channel().getSSR();
+    TEST_ASSERT_FALSE(ssr.isOn());
+    ssr.setDutyCycle(50.0f);
+    TEST_ASSERT_TRUE(ssr.isOn());
+    ssr.setDutyCycle(0.0f);                     // Still attached, but dark
+    TEST_ASSERT_FALSE(ssr.isOn());
+    ssr.setDutyCycle(50.0f);
+    ssr.forceOff();
+    TEST_ASSERT_FALSE(ssr.isOn());
+}
+
+void test_channel_ssr_force_all_off_latches() {
+    ClosedLoopSim s;
+    SSRDriver& ssr = s.channel().getSSR();
+    ssr.setDutyCycle(50.0f);
+    TEST_ASSERT_TRUE(ssr.isOn());
+
+    SSRDriver::forceAllOff();
+    TEST_ASSERT_FALSE(ssr.isOn());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, ssr.getAppliedDuty());
+
+    // A new duty must not turn the output back on until re-armed
+    ssr.setDutyCycle(80.0f);
+    TEST_ASSERT_FALSE(ssr.isOn());
+    sim::advanceUs(2 * SSR_PERIOD_MS * 1000UL);
+    TEST_ASSERT_FALSE(s.heaterOn());
+
+    SSRDriver::rearm();
+    ssr.setDutyCycle(80.0f);
+    TEST_ASSERT_TRUE(ssr.isOn());
+}
+
+// --- SSR scheduler ---
+
+// Ticks in one frame during which exactly `level` planned windows conduct
+static uint32_t ticksAtConcurrency(const uint32_t* offset, const uint32_t* len, uint8_t n, uint8_t level) {
+    uint32_t ticks = 0;
+    for (uint32_t t = 0; t < SSR_LEDC_FULL; t++) {
+        uint8_t on = 0;
+        for (uint8_t i = 0; i < n; i++) {
+            if (len[i] > 0 && t >= offset[i] && t < offset[i] + len[i]) on++;
+        }
+        if (on == level) ticks++;
+    }
+    return ticks;
+}
+
+void test_ssr_plan_two_lanes_staggered() {
+    uint32_t req[2] = { SSR_LEDC_FULL * 7 / 10, SSR_LEDC_FULL / 2 };
+    uint32_t off[2], len[2];
+    SSRScheduler::plan(req, 2, 2, off, len);
+    for (uint8_t i = 0; i < 2; i++) TEST_ASSERT(off[i] + len[i] <= SSR_LEDC_FULL);
+
+    // Both coils on only for the unavoidable excess over one frame
+    TEST_ASSERT_EQUAL_UINT32(len[0] + len[1] - SSR_LEDC_FULL, ticksAtConcurrency(off, len, 2, 2));
+
+    // Fits in one lane: never two at once
+    req[0] = SSR_LEDC_FULL * 4 / 10; req[1] = SSR_LEDC_FULL * 3 / 10;
+    SSRScheduler::plan(req, 2, 2, off, len);
+    TEST_ASSERT_EQUAL_UINT32(0, ticksAtConcurrency(off, len, 2, 2));
+}
+
+void test_ssr_plan_three_lanes_staggered() {
+    // 3 x 55%: every pair must overlap, but all three only briefly
+    uint32_t req[3] = { SSR_LEDC_FULL * 55 / 100, SSR_LEDC_FULL * 55 / 100, SSR_LEDC_FULL * 55 / 100 };
+    uint32_t off[3], len[3];
+    SSRScheduler::plan(req, 3, 3, off, len);
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_UINT32(req[i], len[i]);
+        TEST_ASSERT(off[i] + len[i] <= SSR_LEDC_FULL);
+    }
+    TEST_ASSERT_UINT32_WITHIN(2, 2 * req[0] - SSR_LEDC_FULL, ticksAtConcurrency(off, len, 3, 3));
+
+    // Two-coil budget: never three at once
+    SSRScheduler::plan(req, 3, 2, off, len);
+    TEST_ASSERT_EQUAL_UINT32(0, ticksAtConcurrency(off, len, 3, 3));
+}
+
+void test_ssr_plan_fragmented_lanes_cut_evenly() {
+    // 3 x 66% in 2 lanes: 1.98 frames fits by total, but no two windows
+    // share a lane. Every window must still fit its lane, and the cut
+    // must show in the grants and the returned scale.
+    uint32_t req[3] = { SSR_LEDC_FULL * 66 / 100, SSR_LEDC_FULL * 66 / 100, SSR_LEDC_FULL * 66 / 100 };
+    uint32_t off[3], len[3];
+    float scale = SSRScheduler::plan(req, 3, 2, off, len);
+
+    uint32_t full = 0, cut = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        TEST_ASSERT(off[i] + len[i] <= SSR_LEDC_FULL);
+        if (len[i] == req[i]) full++;
+        else cut = len[i];
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, full);
+    TEST_ASSERT_UINT32_WITHIN(1, SSR_LEDC_FULL / 2, cut);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f / 132.0f, scale);
+    TEST_ASSERT_EQUAL_UINT32(0, ticksAtConcurrency(off, len, 3, 3));
+}
+
+void test_channel_snapshot_published() {
+    ClosedLoopSim s;
+    TEST_ASSERT_EQUAL_UINT32(0, s.channel().getSnapshotSequence());
+
+    s.channel().setTargetTemp(500.0f);
+    s.channel().enable();
+    s.run(5.0f);
+
+    ChannelSnapshot snap = s.channel().snapshot();
+    TEST_ASSERT_GREATER_THAN(0, s.channel().getSnapshotSequence());
+    TEST_ASSERT_TRUE(snap.state == s.channel().getState());
+    TEST_ASSERT_TRUE(snap.isActive());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, s.channel().getCurrentTemp(), snap.currentTemp);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, snap.currentTemp, snap.displayTemp);   // Uncalibrated
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 500.0f, snap.targetTemp);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, s.channel().getPIDOutput(), snap.pidOutput);
+}
+
+void test_channel_snapshot_change_detection() {
+    ClosedLoopSim s;
+    Channel& ch = s.channel();
+    TEST_ASSERT_TRUE(ch.publishSnapshot(100.0f));           // First publish
+    TEST_ASSERT_FALSE(ch.publishSnapshot(100.0f));
+    TEST_ASSERT_FALSE(ch.publishSnapshot(100.02f));         // Below display resolution
+    TEST_ASSERT_TRUE(ch.publishSnapshot(100.1f));
+
+    ch.setTargetTemp(500.0f);
+    TEST_ASSERT_TRUE(ch.publishSnapshot(100.1f));
+    ch.enable();
+    TEST_ASSERT_TRUE(ch.publishSnapshot(100.1f));           // State changed
+    TEST_ASSERT_FALSE(ch.publishSnapshot(100.1f));
+}
+
+// --- Closed-loop benchmarks (default gains, default coil) ---
+
+static void printMetrics(const char* name, const StepMetrics& m) {
+    char buf[160];
+    snprintf(buf, sizeof(buf),
+             "%s: rise %.1fs  overshoot %.1fF  settle %.1fs  ripple %.2fF  sse %+.2fF",
+             name, m.riseTimeS, m.overshootF, m.settlingTimeS, m.rippleF, m.steadyStateErrorF);
+    TEST_MESSAGE(buf);
+}
+
+void test_closed_loop_step_response() {
+    ClosedLoopSim s;
+    StepMetrics m = s.stepResponse(TEMP_DEFAULT_F, 900.0f);
+    printMetrics("step 77F->710F", m);
+
+    TEST_ASSERT_TRUE(m.settled);
+    TEST_ASSERT_GREATER_THAN(0.0f, m.riseTimeS);
+    TEST_ASSERT_LESS_THAN(25.0f, m.overshootF);
+    TEST_ASSERT_LESS_THAN(5.0f, m.rippleF);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 0.0f, m.steadyStateErrorF);
+}
+
+void test_closed_loop_autotuned_step() {
+    ClosedLoopSim s;
+    AutotuneResult r = s.autotune(TEMP_DEFAULT_F, 300.0f);
+    TEST_ASSERT_TRUE(r.valid);
+
+    // Cool back down, then step with the tuned gains
+    s.channel().disable();
+    s.runUntil([&]() { return s.channel().getState() == ChannelState::OFF; }, 3600.0f);
+    StepMetrics m = s.stepResponse(TEMP_DEFAULT_F, 900.0f);
+    printMetrics("autotuned step", m);
+
+    TEST_ASSERT_TRUE(m.settled);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 0.0f, m.steadyStateErrorF);
 }
 
 // --- Runner ---
@@ -112,6 +360,15 @@ int main(int argc, char** argv) {
     RUN_TEST(test_channel_temp_clamping);
     RUN_TEST(test_channel_ssr_duty_cycle);
     RUN_TEST(test_channel_ssr_min_on_time);
+    RUN_TEST(test_channel_ssr_is_on_follows_duty);
+    RUN_TEST(test_channel_ssr_force_all_off_latches);
+    RUN_TEST(test_ssr_plan_two_lanes_staggered);
+    RUN_TEST(test_ssr_plan_three_lanes_staggered);
+    RUN_TEST(test_ssr_plan_fragmented_lanes_cut_evenly);
+    RUN_TEST(test_channel_snapshot_published);
+    RUN_TEST(test_channel_snapshot_change_detection);
+    RUN_TEST(test_closed_loop_step_response);
+    RUN_TEST(test_closed_loop_autotuned_step);
 
     return UNITY_END();
 }
@@ -0,0 +1,79 @@
+// ============================================================
+// Unit Tests: Rotary encoder quadrature decoding
+// Run with: pio test -e test
+// ============================================================
+
+#ifdef UNIT_TEST
+
+#include <unity.h>
+
+#include "../src/drivers/quadrature.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Pin samples are (DT << 1) | CLK, starting from the 0b11 detent
+static int feed(uint8_t& state, const uint8_t* pins, size_t n) {
+    int sum = 0;
+    for (size_t i = 0; i < n; i++) sum += quadStep(state, pins[i]);
+    return sum;
+}
+
+void test_quadrature_cw_detent() {
+    const uint8_t seq[] = { 0b10, 0b00, 0b01, 0b11 };
+    uint8_t state = Q_START;
+    for (uint8_t i = 0; i < 3; i++) TEST_ASSERT_EQUAL_INT32(0, quadStep(state, seq[i]));
+    TEST_ASSERT_EQUAL_INT32(1, quadStep(state, seq[3]));
+    TEST_ASSERT_EQUAL_INT32(Q_START, state);
+}
+
+void test_quadrature_ccw_detent() {
+    const uint8_t seq[] = { 0b01, 0b00, 0b10, 0b11 };
+    uint8_t state = Q_START;
+    for (uint8_t i = 0; i < 3; i++) TEST_ASSERT_EQUAL_INT32(0, quadStep(state, seq[i]));
+    TEST_ASSERT_EQUAL_INT32(-1, quadStep(state, seq[3]));
+    TEST_ASSERT_EQUAL_INT32(Q_START, state);
+}
+
+void test_quadrature_bounce_emits_once() {
+    // CLK chatters at the start, DT at the end; still one detent each way
+    const uint8_t cw[] = { 0b10, 0b11, 0b10, 0b00, 0b01, 0b00, 0b01, 0b11 };
+    const uint8_t ccw[] = { 0b01, 0b11, 0b01, 0b00, 0b10, 0b00, 0b10, 0b11 };
+    uint8_t state = Q_START;
+    TEST_ASSERT_EQUAL_INT32(1, feed(state, cw, sizeof(cw)));
+    TEST_ASSERT_EQUAL_INT32(-1, feed(state, ccw, sizeof(ccw)));
+    TEST_ASSERT_EQUAL_INT32(Q_START, state);
+}
+
+void test_quadrature_partial_and_invalid_ignored() {
+    // Half a step and back, then a jump over two transitions
+    const uint8_t half[] = { 0b10, 0b00, 0b10, 0b11 };
+    const uint8_t jump[] = { 0b00, 0b11, 0b01, 0b10, 0b11 };
+    uint8_t state = Q_START;
+    TEST_ASSERT_EQUAL_INT32(0, feed(state, half, sizeof(half)));
+    TEST_ASSERT_EQUAL_INT32(0, feed(state, jump, sizeof(jump)));
+    TEST_ASSERT_EQUAL_INT32(Q_START, state);
+}
+
+void test_quadrature_full_turns() {
+    const uint8_t cw[] = { 0b10, 0b00, 0b01, 0b11 };
+    uint8_t state = Q_START;
+    int sum = 0;
+    for (uint8_t d = 0; d < 20; d++) sum += feed(state, cw, sizeof(cw));
+    TEST_ASSERT_EQUAL_INT32(20, sum);
+}
+
+// --- Runner ---
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_quadrature_cw_detent);
+    RUN_TEST(test_quadrature_ccw_detent);
+    RUN_TEST(test_quadrature_bounce_emits_once);
+    RUN_TEST(test_quadrature_partial_and_invalid_ignored);
+    RUN_TEST(test_quadrature_full_turns);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TEST
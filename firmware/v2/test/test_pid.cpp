@@ -14,7 +14,6 @@
 #include <algorithm>
 static uint32_t _millis_val = 0;
 uint32_t millis() { return _millis_val; }
-void advance_millis(uint32_t ms) { _millis_val += ms; }
 float constrain(float val, float lo, float hi) {
     return std::max(lo, std::min(hi, val));
 }
@@ -27,8 +26,11 @@ float constrain(float val, float lo, float hi) {
 #define PID_OUTPUT_MIN 0.0f
 #define PID_OUTPUT_MAX 100.0f
 #define PID_DERIVATIVE_FILTER 0.1f
+#include "../src/core/fixed.h"
 #include "../src/core/pid.h"
 #include "../src/core/pid.cpp"
+#include "../src/core/pid_bank.h"
+#include "../src/core/pid_bank.cpp"
 #endif
 
 void setUp(void) {
@@ -40,103 +42,91 @@ void tearDown(void) {}
 // --- Tests ---
 
 void test_pid_init_defaults() {
-    PIDController pid;
+    PIDController<> pid;
     TEST_ASSERT_FALSE(pid.isEnabled());
     TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, pid.getOutput());
     TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, pid.getSetpoint());
 }
 
 void test_pid_disabled_returns_zero() {
-    PIDController pid;
+    PIDController<> pid;
     pid.begin(8.0, 0.2, 2.0, 250);
     pid.setSetpoint(710.0);
     // Not enabled - should return 0
-    advance_millis(250);
-    float out = pid.compute(500.0);
+    float out = pid.compute(500.0, 250);
     TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, out);
 }
 
 void test_pid_basic_proportional() {
-    PIDController pid;
+    PIDController<> pid;
     pid.begin(1.0, 0.0, 0.0, 250);  // P-only
     pid.setOutputLimits(0, 100);
     pid.setSetpoint(100.0);
     pid.setEnabled(true);
 
     // First call: initializes, returns 0
-    advance_millis(250);
-    pid.compute(50.0);
+    pid.compute(50.0, 250);
 
     // Second call: error = 100 - 50 = 50, P = 1.0 * 50 = 50
-    advance_millis(250);
-    float out = pid.compute(50.0);
+    float out = pid.compute(50.0, 250);
     TEST_ASSERT_FLOAT_WITHIN(1.0, 50.0, out);
 }
 
 void test_pid_output_clamping() {
-    PIDController pid;
+    PIDController<> pid;
     pid.begin(10.0, 0.0, 0.0, 250);  // High gain
     pid.setOutputLimits(0, 100);
     pid.setSetpoint(999.0);
     pid.setEnabled(true);
 
-    advance_millis(250);
-    pid.compute(0.0);  // Init
+    pid.compute(0.0, 250);  // Init
 
-    advance_millis(250);
-    float out = pid.compute(0.0);  // Error = 999, P = 9990
+    float out = pid.compute(0.0, 250);  // Error = 999, P = 9990
     TEST_ASSERT_FLOAT_WITHIN(0.01, 100.0, out);  // Clamped to max
 }
 
 void test_pid_zero_output_at_setpoint() {
-    PIDController pid;
+    PIDController<> pid;
     pid.begin(1.0, 0.0, 0.0, 250);
     pid.setOutputLimits(0, 100);
     pid.setSetpoint(710.0);
     pid.setEnabled(true);
 
-    advance_millis(250);
-    pid.compute(710.0);  // Init
+    pid.compute(710.0, 250);  // Init
 
-    advance_millis(250);
-    float out = pid.compute(710.0);  // Error = 0
+    float out = pid.compute(710.0, 250);  // Error = 0
     TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, out);
 }
 
 void test_pid_integral_accumulates() {
-    PIDController pid;
+    PIDController<> pid;
     pid.begin(0.0, 1.0, 0.0, 250);  // I-only, Ki=1.0
     pid.setOutputLimits(0, 100);
     pid.setSetpoint(100.0);
     pid.setEnabled(true);
 
-    advance_millis(250);
-    pid.compute(50.0);  // Init
+    pid.compute(50.0, 250);  // Init
 
     // Each compute: integral += Ki_scaled * error
     // Ki_scaled = 1.0 * 0.25 = 0.25, error = 50
     // integral += 0.25 * 50 = 12.5 per step
 
-    advance_millis(250);
-    float out1 = pid.compute(50.0);
+    float out1 = pid.compute(50.0, 250);
     TEST_ASSERT(out1 > 0.0);
 
-    advance_millis(250);
-    float out2 = pid.compute(50.0);
+    float out2 = pid.compute(50.0, 250);
     TEST_ASSERT(out2 > out1);  // Integral growing
 }
 
 void test_pid_reset_clears_state() {
-    PIDController pid;
+    PIDController<> pid;
     pid.begin(1.0, 1.0, 1.0, 250);
     pid.setOutputLimits(0, 100);
     pid.setSetpoint(500.0);
     pid.setEnabled(true);
 
-    advance_millis(250);
-    pid.compute(100.0);
-    advance_millis(250);
-    pid.compute(100.0);
+    pid.compute(100.0, 250);
+    pid.compute(100.0, 250);
 
     pid.reset();
 
@@ -146,7 +136,7 @@ void test_pid_reset_clears_state() {
 }
 
 void test_pid_setpoint_clamped() {
-    PIDController pid;
+    PIDController<> pid;
     pid.setSetpoint(-100.0);
     TEST_ASSERT_FLOAT_WITHIN(0.01, TEMP_MIN_F, pid.getSetpoint());
 
@@ -154,26 +144,30 @@ void test_pid_setpoint_clamped() {
     TEST_ASSERT_FLOAT_WITHIN(0.01, TEMP_MAX_F, pid.getSetpoint());
 }
 
-void test_pid_sample_time_respected() {
-    PIDController pid;
-    pid.begin(1.0, 0.0, 0.0, 250);
+void test_pid_late_tick_not_skipped() {
+    PIDController<> pid;
+    pid.begin(0.0, 1.0, 0.0, 250);  // I-only
     pid.setSetpoint(100.0);
     pid.setEnabled(true);
 
-    advance_millis(250);
-    pid.compute(50.0);  // Init
+    pid.compute(50.0, 250);  // Init
+
+    // A tick that woke at 249ms still integrates (no sample-time gate)
+    float out = pid.compute(50.0, 249);
+    TEST_ASSERT(out > 0);
 
-    // Call before sample time elapsed - should return previous output
-    advance_millis(100);  // Only 100ms, need 250
-    float out = pid.compute(50.0);
+    // Half the interval contributes half a step: Ki * error * 0.5
+    float before = pid.getITerm();
+    pid.compute(50.0, 125);
+    TEST_ASSERT_FLOAT_WITHIN(0.05, 25.0, pid.getITerm() - before);
 
-    advance_millis(150);  // Now at 250ms total
-    float out2 = pid.compute(50.0);
-    TEST_ASSERT(out2 != out || out2 > 0);  // Should compute now
+    // No time elapsed: output unchanged
+    float held = pid.getOutput();
+    TEST_ASSERT_FLOAT_WITHIN(0.001, held, pid.compute(10.0, 0));
 }
 
 void test_pid_enable_disable_bumpless() {
-    PIDController pid;
+    PIDController<> pid;
     pid.begin(1.0, 1.0, 0.0, 250);
     pid.setOutputLimits(0, 100);
     pid.setSetpoint(500.0);
@@ -181,8 +175,7 @@ void test_pid_enable_disable_bumpless() {
 
     // Accumulate some integral
     for (int i = 0; i < 10; i++) {
-        advance_millis(250);
-        pid.compute(400.0);
+        pid.compute(400.0, 250);
     }
     float accumulated = pid.getITerm();
     TEST_ASSERT(accumulated > 0);
@@ -195,6 +188,88 @@ void test_pid_enable_disable_bumpless() {
     TEST_ASSERT_FLOAT_WITHIN(0.01, 0.0, pid.getITerm());  // Reset
 }
 
+// --- Fixed-point kernel ---
+
+void test_fixed_arithmetic() {
+    Q16_16 a(1.5f), b(-2.25f);
+    TEST_ASSERT_EQUAL_INT32(98304, a.raw());
+    TEST_ASSERT_EQUAL_INT32(-221184, (a * b).raw());            // -3.375
+    TEST_ASSERT_EQUAL_INT32(-43690, (a / b).raw());             // -0.6666, truncated
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, (Q16_16(30000.0f) * Q16_16(30000.0f)).raw());
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, (b / Q16_16(0.0f)).raw());
+}
+
+void test_pid_fixed_tracks_float() {
+    PIDController<float> pf;
+    PIDController<Q16_16> pq;
+    pf.begin(8.0, 0.2, 2.0, 250);
+    pq.begin(8.0, 0.2, 2.0, 250);
+    pf.setSetpoint(710.0); pq.setSetpoint(710.0);
+    pf.setEnabled(true);   pq.setEnabled(true);
+
+    for (int i = 0; i < 40; i++) {
+        float t = 690.0f + (float)i * 0.75f;
+        float of = pf.compute(t, 250);
+        float oq = pq.compute(t, 250);
+        TEST_ASSERT_FLOAT_WITHIN(0.05, of, oq);
+    }
+}
+
+void test_pid_fixed_bit_exact() {
+    // Golden raw outputs: must match on the ESP32 and the native env
+    PIDController<Q16_16> pid;
+    pid.begin(1.0, 0.5, 0.5, 250);
+    pid.setTunings(1.0, 0.5, 0.5);
+    pid.setSetpoint(100.0);
+    pid.setEnabled(true);
+
+    const float temps[] = { 90.0f, 91.5f, 93.25f, 95.0f, 96.75f, 98.0f };
+    const int32_t expected[] = { 0, 607026, 526661, 434058, 329006, 254735 };
+    for (int i = 0; i < 6; i++) {
+        pid.compute(temps[i], 250);
+        TEST_ASSERT_EQUAL_INT32(expected[i], pid.getRawOutput().raw());
+    }
+}
+
+void test_pid_fixed_integer_inputs() {
+    // dt scale is built in integer math: exact on and off nominal
+    TEST_ASSERT_EQUAL_INT32(Q16_16::ONE, pidDtScale<Q16_16>(250, 250).raw());
+    TEST_ASSERT_EQUAL_INT32(Q16_16::ONE / 2, pidDtScale<Q16_16>(125, 250).raw());
+    TEST_ASSERT_EQUAL_INT32(PID_DT_MAX_SCALE * Q16_16::ONE, pidDtScale<Q16_16>(60000, 250).raw());
+
+    // A raw Q16.16 measurement drives the kernel exactly like the float one
+    PIDController<Q16_16> pf, pq;
+    pf.begin(1.0, 0.5, 0.5, 250); pq.begin(1.0, 0.5, 0.5, 250);
+    pf.setSetpoint(100.0);        pq.setSetpoint(100.0);
+    pf.setEnabled(true);          pq.setEnabled(true);
+    const float temps[] = { 90.0f, 91.5f, 93.25f, 95.0f };
+    for (int i = 0; i < 4; i++) {
+        pf.compute(temps[i], 240);
+        pq.computeQ16(Q16_16(temps[i]).raw(), 240);
+        TEST_ASSERT_EQUAL_INT32(pf.getRawOutput().raw(), pq.getRawOutput().raw());
+    }
+}
+
+void test_pid_bank_matches_controller() {
+    PIDController<> ref;
+    PIDBank<NUM_CHANNELS> bank;
+    PIDBank<NUM_CHANNELS>::View v = bank.view(NUM_CHANNELS - 1);
+    ref.begin(8.0, 0.2, 2.0, 250);
+    v.begin(8.0, 0.2, 2.0, 250);
+    ref.setSetpoint(450.0); v.setSetpoint(450.0);
+    ref.setEnabled(true);   v.setEnabled(true);
+
+    for (int i = 0; i < 20; i++) {
+        float t = 400.0f + (float)i * 2.5f;
+        uint32_t dt = 240 + (i % 3) * 10;   // Jittered ticks
+        ref.compute(t, dt);
+        v.stage(t);
+        bank.compute(dt);
+        TEST_ASSERT_EQUAL_FLOAT(ref.getOutput(), v.getOutput());
+        TEST_ASSERT_EQUAL_FLOAT(ref.getITerm(), v.getITerm());
+    }
+}
+
 // --- Runner ---
 int main(int argc, char** argv) {
     UNITY_BEGIN();
@@ -207,8 +282,13 @@ int main(int argc, char** argv) {
     RUN_TEST(test_pid_integral_accumulates);
     RUN_TEST(test_pid_reset_clears_state);
     RUN_TEST(test_pid_setpoint_clamped);
-    RUN_TEST(test_pid_sample_time_respected);
+    RUN_TEST(test_pid_late_tick_not_skipped);
     RUN_TEST(test_pid_enable_disable_bumpless);
+    RUN_TEST(test_fixed_arithmetic);
+    RUN_TEST(test_pid_fixed_tracks_float);
+    RUN_TEST(test_pid_fixed_bit_exact);
+    RUN_TEST(test_pid_fixed_integer_inputs);
+    RUN_TEST(test_pid_bank_matches_controller);
 
     return UNITY_END();
 }
@@ -0,0 +1,324 @@
+// ============================================================
+// Unit Tests: Time-series codec, recorder and history queries
+// Run with: pio test -e test
+// ============================================================
+
+#ifdef UNIT_TEST
+
+#include <unity.h>
+
+// The recorder runs against the in-memory LittleFS shim
+// (sim/hal/LittleFS.h), which can also fail opens and cut writes short.
+
+#include <stdio.h>
+#include <string>
+
+static uint32_t _millis_val = 0;
+uint32_t millis() { return _millis_val; }
+
+#include "../src/data/series_recorder.cpp"
+#include "../src/data/history_query.cpp"
+
+void setUp(void) { hostfs::reset(); _millis_val = 0; }
+void tearDown(void) {}
+
+// Feed one stored sample (SERIES_DECIMATION equal PID ticks)
+static void addStored(SeriesRecorder& r, uint8_t ch, float temp, float set, float out) {
+    for (uint8_t i = 0; i < SERIES_DECIMATION; i++) r.addSample(ch, temp, set, out);
+}
+
+static bool onlySession(SeriesRecorder& r, SeriesSession& s) {
+    return r.getSessions(&s, 1) == 1;
+}
+
+// --- Varint codec ---
+
+void test_varint_roundtrip_extremes() {
+    const int32_t values[] = { 0, 1, -1, 63, -64, 64, -65, 8191, -8192,
+                               1 << 19, -(1 << 19), INT32_MAX, INT32_MIN, INT32_MIN + 1 };
+    const uint8_t lens[] = { 1, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 5, 5, 5 };
+    const size_t n = sizeof(values) / sizeof(values[0]);
+
+    uint8_t buf[n * VARINT_MAX_BYTES];
+    uint16_t len = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t w = putVarint(buf + len, values[i]);
+        TEST_ASSERT_EQUAL_INT32(lens[i], w);
+        len += w;
+    }
+
+    uint16_t pos = 0;
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = 0;
+        TEST_ASSERT_TRUE(getVarint(buf, len, pos, v));
+        TEST_ASSERT_EQUAL_INT32(values[i], v);
+    }
+    TEST_ASSERT_EQUAL_UINT32(len, pos);
+}
+
+void test_varint_rejects_truncated() {
+    uint8_t buf[VARINT_MAX_BYTES];
+    uint8_t len = putVarint(buf, INT32_MIN);
+    for (uint8_t cut = 0; cut < len; cut++) {
+        uint16_t pos = 0;
+        int32_t v = 0;
+        TEST_ASSERT_FALSE(getVarint(buf, cut, pos, v));
+    }
+
+    // More than VARINT_MAX_BYTES continuation bytes is corrupt
+    uint8_t junk[VARINT_MAX_BYTES + 1];
+    memset(junk, 0x80, sizeof(junk));
+    uint16_t pos = 0;
+    int32_t v = 0;
+    TEST_ASSERT_FALSE(getVarint(junk, sizeof(junk), pos, v));
+}
+
+// --- Recorder ---
+
+// Every block restarts the delta chain, so the first varints after each
+// header are the absolute quantised values of that sample.
+void test_series_blocks_restart_deltas() {
+    SeriesRecorder rec;
+    rec.begin();
+    rec.startSession(0);
+
+    const uint32_t N = 400;
+    for (uint32_t i = 0; i < N; i++) {
+        addStored(rec, 0, 400.0f + (i % 50), 710.0f, (float)(i % 100));
+        if (i % 20 == 19) rec.update();
+    }
+    rec.endSession(0);
+    rec.update();
+    TEST_ASSERT_EQUAL_UINT32(0, rec.getDroppedSamples());
+
+    SeriesSession s;
+    TEST_ASSERT_TRUE(onlySession(rec, s));
+    TEST_ASSERT_EQUAL_UINT32(N, s.samples);
+
+    uint32_t blocks = 0, expectFirst = 0;
+    for (uint16_t seg = 0; seg < s.segments; seg++) {
+        char path[32];
+        SeriesRecorder::segmentPath(path, sizeof(path), s.id, seg);
+        const std::vector<uint8_t>& data = hostfs::state().files[path];
+        size_t off = 0;
+        while (off + sizeof(BlockHeader) <= data.size()) {
+            BlockHeader h;
+            memcpy(&h, &data[off], sizeof(h));
+            TEST_ASSERT_EQUAL_UINT32(expectFirst, h.firstSample);
+
+            const uint8_t* body = &data[off + sizeof(h)];
+            uint16_t pos = 0;
+            int32_t v[3];
+            for (uint8_t k = 0; k < 3; k++) TEST_ASSERT_TRUE(getVarint(body, h.bytes, pos, v[k]));
+            uint32_t i = h.firstSample;
+            TEST_ASSERT_EQUAL_INT32((int32_t)(4000 + (i % 50) * 10), v[0]);
+            TEST_ASSERT_EQUAL_INT32(7100, v[1]);
+            TEST_ASSERT_EQUAL_INT32((int32_t)((i % 100) * 10), v[2]);
+
+            expectFirst += h.samples;
+            off += sizeof(h) + h.bytes;
+            blocks++;
+        }
+    }
+    TEST_ASSERT_TRUE(blocks >= 3);
+    TEST_ASSERT_EQUAL_UINT32(N, expectFirst);
+
+    // Decoding through the reader gives every sample back
+    SeriesReader rd;
+    TEST_ASSERT_TRUE(rd.open(rec, s.id));
+    SeriesSample smp;
+    uint32_t got = 0;
+    while (rd.next(smp)) {
+        TEST_ASSERT_EQUAL_UINT32(got, smp.index);
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, 400.0f + (got % 50), smp.tempF);
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, (float)(got % 100), smp.output);
+        got++;
+    }
+    rd.close();
+    TEST_ASSERT_EQUAL_UINT32(N, got);
+}
+
+// A block that can't be written is counted as dropped and never as a
+// segment, so the index doesn't point at missing or torn data.
+void test_series_write_failure_not_counted() {
+    SeriesRecorder rec;
+    rec.begin();
+    rec.startSession(0);
+
+    addStored(rec, 0, 500.0f, 600.0f, 10.0f);
+    rec.endSession(0);
+    hostfs::state().failOpens = 1;
+    rec.update();
+
+    SeriesSession s;
+    TEST_ASSERT_TRUE(onlySession(rec, s));
+    TEST_ASSERT_EQUAL_UINT32(0, s.segments);
+    TEST_ASSERT_EQUAL_UINT32(0, s.bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, rec.getDroppedSamples());
+}
+
+// A block torn part-way into an existing segment closes that segment:
+// the samples already on flash stay readable, the rest go to a new one.
+void test_series_torn_write_closes_segment() {
+    SeriesRecorder rec;
+    rec.begin();
+    rec.startSession(0);
+
+    uint32_t i = 0;
+    SeriesSession s;
+    while (!(onlySession(rec, s) && s.segments == 1 && s.samples > 0)) {
+        addStored(rec, 0, 500.0f + (i % 50), 600.0f, 10.0f);
+        rec.update();
+        i++;
+    }
+    const uint32_t written = s.samples;
+    const uint32_t bytes = s.bytes;
+
+    addStored(rec, 0, 700.0f, 600.0f, 10.0f);
+    rec.endSession(0);
+    hostfs::state().writeLimit = 3;             // Header cut short
+    rec.update();
+    hostfs::state().writeLimit = (size_t)-1;
+
+    TEST_ASSERT_TRUE(onlySession(rec, s));
+    TEST_ASSERT_EQUAL_UINT32(1, s.segments);
+    TEST_ASSERT_EQUAL_UINT32(SERIES_SEGMENT_BYTES, s.segBytes);
+    TEST_ASSERT_EQUAL_UINT32(bytes + 3, s.bytes);
+    TEST_ASSERT_EQUAL_UINT32(i + 1 - written, rec.getDroppedSamples());
+
+    SeriesReader rd;
+    TEST_ASSERT_TRUE(rd.open(rec, s.id));
+    SeriesSample smp;
+    uint32_t got = 0;
+    while (rd.next(smp)) got++;
+    rd.close();
+    TEST_ASSERT_EQUAL_UINT32(written, got);
+}
+
+static std::string drain(ChunkedJson<96>& q) {
+    std::string json;
+    uint8_t buf[64];
+    size_t n;
+    while ((n = q.read(buf, sizeof(buf))) > 0) json.append((const char*)buf, n);
+    return json;
+}
+
+// Sessions of earlier boots survive a reboot: out of the current boot's
+// time ranges, but listed and queryable by id
+void test_series_keeps_other_boots() {
+    {
+        SeriesRecorder rec;
+        rec.begin();
+        _millis_val = 5000;
+        rec.startSession(0);
+        for (uint8_t i = 0; i < 10; i++) addStored(rec, 0, 500.0f + i, 600.0f, 10.0f);
+        rec.endSession(0);
+        rec.update();
+    }
+    SeriesRecorder rec;
+    rec.begin();
+    SeriesSession s;
+    TEST_ASSERT_TRUE(onlySession(rec, s));
+    TEST_ASSERT_TRUE(s.boot != rec.currentBoot());
+    char path[32];
+    SeriesRecorder::segmentPath(path, sizeof(path), s.id, 0);
+    TEST_ASSERT_TRUE(LittleFS.exists(path));
+
+    uint32_t ids[4];
+    TEST_ASSERT_EQUAL_UINT32(0, rec.findSessions(0, 0, 100000, ids, 4));
+
+    HistoryQuery q(rec, s.id, 100);
+    TEST_ASSERT_TRUE(q.begin());
+    while (!q.step()) {}
+    std::string json = drain(q);
+    TEST_ASSERT_TRUE(json.find("\"total\":10") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("[5.00,500.0,600.0,10.0]") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("[14.00,509.0,600.0,10.0]]}") != std::string::npos);
+
+    HistorySessions list(rec);
+    TEST_ASSERT_TRUE(list.ok());
+    std::string out;
+    uint8_t buf[16];
+    size_t n;
+    while ((n = list.read(buf, sizeof(buf))) > 0) out.append((const char*)buf, n);
+    char expect[96];
+    snprintf(expect, sizeof(expect), "{\"boot\":%u,\"sessions\":[{\"id\":%lu,\"ch\":0,\"boot\":%u,",
+             rec.currentBoot(), (unsigned long)s.id, s.boot);
+    TEST_ASSERT_TRUE(out.find(expect) == 0);
+    TEST_ASSERT_TRUE(out.find("\"samples\":10,\"periodMs\":1000}]}") != std::string::npos);
+}
+
+// --- History (LTTB) ---
+
+// Flat trace with one spike per bucket, alternately up and down: LTTB
+// must pick every spike, keep the first and last samples, and return
+// exactly `points` points.
+static float spikeTemp(uint16_t b) {
+    return (b & 1) ? 400.0f - b : 600.0f + b;
+}
+
+void test_history_lttb_picks_bucket_peaks() {
+    SeriesRecorder rec;
+    rec.begin();
+    rec.startSession(0);
+
+    const uint32_t N = 1000;
+    const uint16_t P = 12;
+    const uint16_t buckets = P - 2;
+    bool spike[N] = {};
+    for (uint16_t b = 0; b < buckets; b++) {
+        uint32_t lo = 1 + (uint32_t)b * (N - 2) / buckets;
+        uint32_t hi = 1 + (uint32_t)(b + 1) * (N - 2) / buckets;
+        spike[(lo + hi) / 2] = true;
+    }
+    uint16_t nextSpike = 0;
+    for (uint32_t i = 0; i < N; i++) {
+        float t = spike[i] ? spikeTemp(nextSpike++) : 500.0f;
+        if (i == N - 1) t = 505.0f;
+        addStored(rec, 0, t, 600.0f, 10.0f);
+        if (i % 20 == 19) rec.update();
+    }
+    rec.endSession(0);
+    rec.update();
+    TEST_ASSERT_EQUAL_UINT32(0, rec.getDroppedSamples());
+
+    _millis_val = N * 1000 + 5000;
+    HistoryQuery q(rec, 0, 0, N + 10, P);
+    TEST_ASSERT_TRUE(q.begin());
+    uint32_t slices = 1;
+    while (!q.step()) slices++;
+    TEST_ASSERT_TRUE(slices > 1);                   // Selection is sliced
+
+    std::string json = drain(q);
+
+    uint32_t count = 0;
+    for (size_t i = json.find("\"points\":[") + 10; i < json.size(); i++) {
+        if (json[i] == '[') count++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(P, count);
+    TEST_ASSERT_TRUE(json.find("\"total\":1000") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("[0.00,500.0,") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find(",505.0,600.0,10.0]]}") != std::string::npos);
+    for (uint16_t b = 0; b < buckets; b++) {
+        char v[16];
+        snprintf(v, sizeof(v), ",%.1f,", spikeTemp(b));
+        TEST_ASSERT_TRUE(json.find(v) != std::string::npos);
+    }
+}
+
+// --- Runner ---
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_varint_roundtrip_extremes);
+    RUN_TEST(test_varint_rejects_truncated);
+    RUN_TEST(test_series_blocks_restart_deltas);
+    RUN_TEST(test_series_write_failure_not_counted);
+    RUN_TEST(test_series_torn_write_closes_segment);
+    RUN_TEST(test_series_keeps_other_boots);
+    RUN_TEST(test_history_lttb_picks_bucket_peaks);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TEST
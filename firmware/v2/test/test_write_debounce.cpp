@@ -0,0 +1,88 @@
+// ============================================================
+// Unit Tests: Settings write debounce
+// Run with: pio test -e test
+// ============================================================
+
+#ifdef UNIT_TEST
+
+#include <unity.h>
+
+#include "../src/data/write_debounce.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_debounce_idle_never_due() {
+    WriteDebounce d;
+    TEST_ASSERT_FALSE(d.pending());
+    TEST_ASSERT_FALSE(d.due(0));
+    TEST_ASSERT_FALSE(d.due(SETTINGS_MAX_DEFER_MS * 2));
+}
+
+void test_debounce_due_after_quiet_period() {
+    WriteDebounce d;
+    d.touch(1000);
+    TEST_ASSERT_TRUE(d.pending());
+    TEST_ASSERT_FALSE(d.due(1000 + SETTINGS_DEBOUNCE_MS - 1));
+    TEST_ASSERT_TRUE(d.due(1000 + SETTINGS_DEBOUNCE_MS));
+}
+
+void test_debounce_burst_restarts_quiet_period() {
+    WriteDebounce d;
+    d.touch(1000);
+    d.touch(1500);
+    d.touch(2500);
+    TEST_ASSERT_FALSE(d.due(2500 + SETTINGS_DEBOUNCE_MS - 1));
+    TEST_ASSERT_TRUE(d.due(2500 + SETTINGS_DEBOUNCE_MS));
+}
+
+void test_debounce_max_defer_under_continuous_changes() {
+    WriteDebounce d;
+    const uint32_t t0 = 5000;
+    uint32_t now = t0;
+    d.touch(now);
+    while (now - t0 < SETTINGS_MAX_DEFER_MS - 500) {
+        now += 500;
+        d.touch(now);
+        TEST_ASSERT_FALSE(d.due(now));
+    }
+    now += 500;
+    d.touch(now);
+    TEST_ASSERT_TRUE(d.due(now));
+}
+
+void test_debounce_clear_restarts_window() {
+    WriteDebounce d;
+    d.touch(0);
+    d.clear();
+    TEST_ASSERT_FALSE(d.pending());
+    TEST_ASSERT_FALSE(d.due(SETTINGS_MAX_DEFER_MS));
+
+    // The next change opens a new window rather than inheriting the old one
+    d.touch(SETTINGS_MAX_DEFER_MS);
+    TEST_ASSERT_FALSE(d.due(SETTINGS_MAX_DEFER_MS + SETTINGS_DEBOUNCE_MS - 1));
+    TEST_ASSERT_TRUE(d.due(SETTINGS_MAX_DEFER_MS + SETTINGS_DEBOUNCE_MS));
+}
+
+void test_debounce_wraps_millis() {
+    WriteDebounce d;
+    d.touch(0xFFFFFF00u);
+    TEST_ASSERT_FALSE(d.due(0xFFFFFF00u + 100));
+    TEST_ASSERT_TRUE(d.due(0xFFFFFF00u + SETTINGS_DEBOUNCE_MS));
+}
+
+// --- Runner ---
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_debounce_idle_never_due);
+    RUN_TEST(test_debounce_due_after_quiet_period);
+    RUN_TEST(test_debounce_burst_restarts_quiet_period);
+    RUN_TEST(test_debounce_max_defer_under_continuous_changes);
+    RUN_TEST(test_debounce_clear_restarts_window);
+    RUN_TEST(test_debounce_wraps_millis);
+
+    return UNITY_END();
+}
+
+#endif // UNIT_TEST